@@ -15,7 +15,7 @@ let package = Package(
     targets: [
         .target(
             name: "DataLiteC",
-            sources: ["libtomcrypt", "sqlcipher"],
+            sources: ["libtomcrypt", "sqlcipher", "stmtcache", "vfs"],
             publicHeadersPath: "sqlcipher",
             cSettings: [
                 .headerSearchPath("libtomcrypt/headers"),
@@ -24,7 +24,7 @@ let package = Package(
                 .define("SQLCIPHER_CRYPTO_LIBTOMCRYPT"),
                 .define("SQLITE_HOMEGROWN_RECURSIVE_MUTEX"),
                 .define("SQLITE_HAS_CODEC"),
-                .define("SQLITE_EXTRA_INIT", to: "sqlcipher_extra_init"),
+                .define("SQLITE_EXTRA_INIT", to: "datalitec_extra_init"),
                 .define("SQLITE_EXTRA_SHUTDOWN", to: "sqlcipher_extra_shutdown"),
                 .define("SQLITE_THREADSAFE", to: "1"),
                 .define("SQLITE_TEMP_STORE", to: "2"),
@@ -41,13 +41,38 @@ let package = Package(
                 .define("SQLITE_USE_URI"),
                 .define("HAVE_GETHOSTUUID", to: "0"),
                 .define("HAVE_STDINT_H"),
+                .define("LTC_AES_ONLY"),
                 .define("LTC_NO_TEST"),
-                .define("LTC_NO_FILE")
+                .define("LTC_NO_FILE"),
+                .define("LTC_PTHREAD"),
+                .define("LTC_PKCS_5_CACHE"),
+                .define("LTC_PKCS_5_CACHE_INITIAL_ENTRIES", to: "0"),
+                .define("LTC_SECMEM"),
+                .define("LTC_SECMEM_INITIAL_ENABLED", to: "0"),
+                .define("LTC_STATS", .when(configuration: .debug))
             ],
             linkerSettings: [
                 .linkedLibrary("log", .when(platforms: [.android]))
             ]
         ),
+        .executableTarget(
+            name: "CryptoBenchmark",
+            dependencies: ["DataLiteC"],
+            cSettings: [
+                .headerSearchPath("../DataLiteC/libtomcrypt/headers"),
+                .define("LTC_AES_ONLY"),
+                .define("LTC_NO_TEST"),
+                .define("LTC_NO_FILE"),
+                .define("LTC_PTHREAD")
+            ]
+        ),
+        .executableTarget(
+            name: "SQLiteBenchmark",
+            dependencies: ["DataLiteC"],
+            cSettings: [
+                .define("SQLITE_HAS_CODEC")
+            ]
+        ),
         .testTarget(
             name: "DataLiteCTests",
             dependencies: ["DataLiteC"],
@@ -0,0 +1,666 @@
+/*
+ * Throughput benchmark for the bundled LibTomCrypt.
+ *
+ * Measures every registered cipher and hash descriptor, the block cipher
+ * modes, MACs, AEADs, stream ciphers, PBKDF2 and the public key operations
+ * that are usable in this build, over a range of message sizes, single- and
+ * multi-threaded. Results are written to stdout as one JSON document so two
+ * builds can be diffed.
+ *
+ * usage: CryptoBenchmark [--filter STR] [--threads N[,N...]]
+ *                        [--sizes N[,N...]] [--min-time SECONDS]
+ */
+
+#include <tomcrypt.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC
+#endif
+
+#define BENCH_MAX_SIZE     (1024UL * 1024UL)
+#define BENCH_MAX_LIST     16
+#define BENCH_KDF_ITER     1000
+
+typedef struct bench_ctx {
+   unsigned char *in, *out;
+   unsigned long  len;
+   int            idx;
+   unsigned char  key[MAXBLOCKSIZE], iv[MAXBLOCKSIZE], tag[MAXBLOCKSIZE];
+   symmetric_key  skey;
+   union {
+      symmetric_ECB ecb;
+      symmetric_CBC cbc;
+      symmetric_CTR ctr;
+      symmetric_CFB cfb;
+      symmetric_OFB ofb;
+      symmetric_xts xts;
+   } mode;
+   prng_state     prng;
+   curve25519_key priv, pub;
+   unsigned char  sig[64];
+} bench_ctx;
+
+typedef struct bench {
+   const char *category;
+   char        name[64];
+   int         idx;                         /* cipher or hash index */
+   int         sized;                       /* throughput over message sizes or fixed-size op */
+   int       (*setup)(bench_ctx *ctx);      /* optional, once per thread */
+   int       (*run)(bench_ctx *ctx);
+} bench;
+
+typedef struct bench_job {
+   const bench     *b;
+   bench_ctx        ctx;
+   unsigned long    iterations;
+   int              err;
+   pthread_t        thread;
+} bench_job;
+
+static struct {
+   const char      *filter;
+   unsigned long    sizes[BENCH_MAX_LIST];
+   int              nsizes;
+   long             threads[BENCH_MAX_LIST];
+   int              nthreads;
+   double           min_time;
+   int              first;
+   pthread_mutex_t  lock;
+   pthread_cond_t   cond;
+   int              go;
+} opts;
+
+/* ---- helpers ---- */
+
+static double s_now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static ulong64 s_cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+   return (ulong64)__rdtsc();
+#else
+   return 0;
+#endif
+}
+
+static void s_fill(unsigned char *p, unsigned long n)
+{
+   unsigned long x;
+   for (x = 0; x < n; x++) {
+      p[x] = (unsigned char)(x * 131u + 7u);
+   }
+}
+
+static int s_parse_list(const char *s, long *out, int max)
+{
+   int n = 0;
+   char *end;
+   while (*s != '\0' && n < max) {
+      out[n++] = strtol(s, &end, 10);
+      if (end == s) return -1;
+      s = (*end == ',') ? end + 1 : end;
+   }
+   return n;
+}
+
+/* ---- block ciphers ---- */
+
+static int s_cipher_setup(bench_ctx *ctx)
+{
+   int keylen = cipher_descriptor[ctx->idx].max_key_length;
+   int err;
+   if ((err = cipher_descriptor[ctx->idx].keysize(&keylen)) != CRYPT_OK) return err;
+   return cipher_descriptor[ctx->idx].setup(ctx->key, keylen, 0, &ctx->skey);
+}
+
+static int s_cipher_ecb(bench_ctx *ctx)
+{
+   const struct ltc_cipher_descriptor *desc = &cipher_descriptor[ctx->idx];
+   unsigned long blocks = ctx->len / (unsigned long)desc->block_length, x;
+   int err;
+   if (desc->accel_ecb_encrypt != NULL) {
+      return desc->accel_ecb_encrypt(ctx->in, ctx->out, blocks, &ctx->skey);
+   }
+   for (x = 0; x < blocks; x++) {
+      if ((err = desc->ecb_encrypt(ctx->in + x * (unsigned long)desc->block_length,
+                                   ctx->out + x * (unsigned long)desc->block_length,
+                                   &ctx->skey)) != CRYPT_OK) {
+         return err;
+      }
+   }
+   return CRYPT_OK;
+}
+
+static int s_cipher_keysetup(bench_ctx *ctx)
+{
+   int err;
+   if ((err = s_cipher_setup(ctx)) != CRYPT_OK) return err;
+   cipher_descriptor[ctx->idx].done(&ctx->skey);
+   return CRYPT_OK;
+}
+
+/* ---- modes, always on AES-256 ---- */
+
+static int s_ecb_setup(bench_ctx *ctx) { return ecb_start(ctx->idx, ctx->key, 32, 0, &ctx->mode.ecb); }
+static int s_ecb_enc(bench_ctx *ctx)   { return ecb_encrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.ecb); }
+static int s_ecb_dec(bench_ctx *ctx)   { return ecb_decrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.ecb); }
+static int s_cbc_setup(bench_ctx *ctx) { return cbc_start(ctx->idx, ctx->iv, ctx->key, 32, 0, &ctx->mode.cbc); }
+static int s_cbc_enc(bench_ctx *ctx)   { return cbc_encrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.cbc); }
+static int s_cbc_dec(bench_ctx *ctx)   { return cbc_decrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.cbc); }
+static int s_ctr_setup(bench_ctx *ctx) { return ctr_start(ctx->idx, ctx->iv, ctx->key, 32, 0, CTR_COUNTER_BIG_ENDIAN, &ctx->mode.ctr); }
+static int s_ctr_enc(bench_ctx *ctx)   { return ctr_encrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.ctr); }
+static int s_cfb_setup(bench_ctx *ctx) { return cfb_start(ctx->idx, ctx->iv, ctx->key, 32, 0, &ctx->mode.cfb); }
+static int s_cfb_enc(bench_ctx *ctx)   { return cfb_encrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.cfb); }
+static int s_ofb_setup(bench_ctx *ctx) { return ofb_start(ctx->idx, ctx->iv, ctx->key, 32, 0, &ctx->mode.ofb); }
+static int s_ofb_enc(bench_ctx *ctx)   { return ofb_encrypt(ctx->in, ctx->out, ctx->len, &ctx->mode.ofb); }
+static int s_xts_setup(bench_ctx *ctx) { return xts_start(ctx->idx, ctx->key, ctx->key + 32, 32, 0, &ctx->mode.xts); }
+static int s_xts_enc(bench_ctx *ctx)   { return xts_encrypt(ctx->in, ctx->len, ctx->out, ctx->iv, &ctx->mode.xts); }
+static int s_xts_dec(bench_ctx *ctx)   { return xts_decrypt(ctx->in, ctx->len, ctx->out, ctx->iv, &ctx->mode.xts); }
+
+/* ---- hashes ---- */
+
+static int s_hash(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return hash_memory(ctx->idx, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+/* ---- MACs ---- */
+
+static int s_hmac(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return hmac_memory(ctx->idx, ctx->key, 32, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_omac(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return omac_memory(ctx->idx, ctx->key, 16, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_pmac(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return pmac_memory(ctx->idx, ctx->key, 16, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_xcbc(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return xcbc_memory(ctx->idx, ctx->key, 16, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_f9(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return f9_memory(ctx->idx, ctx->key, 16, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_pelican(bench_ctx *ctx)
+{
+   return pelican_memory(ctx->key, 16, ctx->in, ctx->len, ctx->tag);
+}
+
+static int s_poly1305(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return poly1305_memory(ctx->key, 32, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_blake2smac(bench_ctx *ctx)
+{
+   unsigned long outlen = 32;
+   return blake2smac_memory(ctx->key, 32, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+static int s_blake2bmac(bench_ctx *ctx)
+{
+   unsigned long outlen = 64;
+   return blake2bmac_memory(ctx->key, 64, ctx->in, ctx->len, ctx->tag, &outlen);
+}
+
+/* ---- AEADs ---- */
+
+static int s_gcm(bench_ctx *ctx)
+{
+   unsigned long taglen = 16;
+   return gcm_memory(ctx->idx, ctx->key, 32, ctx->iv, 12, NULL, 0,
+                     ctx->in, ctx->len, ctx->out, ctx->tag, &taglen, GCM_ENCRYPT);
+}
+
+static int s_ccm(bench_ctx *ctx)
+{
+   unsigned long taglen = 16;
+   return ccm_memory(ctx->idx, ctx->key, 32, NULL, ctx->iv, 12, NULL, 0,
+                     ctx->in, ctx->len, ctx->out, ctx->tag, &taglen, CCM_ENCRYPT);
+}
+
+static int s_eax(bench_ctx *ctx)
+{
+   unsigned long taglen = 16;
+   return eax_encrypt_authenticate_memory(ctx->idx, ctx->key, 32, ctx->iv, 16, NULL, 0,
+                                          ctx->in, ctx->len, ctx->out, ctx->tag, &taglen);
+}
+
+static int s_ocb3(bench_ctx *ctx)
+{
+   unsigned long taglen = 16;
+   return ocb3_encrypt_authenticate_memory(ctx->idx, ctx->key, 32, ctx->iv, 12, NULL, 0,
+                                           ctx->in, ctx->len, ctx->out, ctx->tag, &taglen);
+}
+
+static int s_chacha20poly1305(bench_ctx *ctx)
+{
+   unsigned long taglen = 16;
+   return chacha20poly1305_memory(ctx->key, 32, ctx->iv, 12, NULL, 0,
+                                  ctx->in, ctx->len, ctx->out, ctx->tag, &taglen,
+                                  CHACHA20POLY1305_ENCRYPT);
+}
+
+/* ---- stream ciphers ---- */
+
+static int s_chacha(bench_ctx *ctx)
+{
+   return chacha_memory(ctx->key, 32, 20, ctx->iv, 12, 0, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_salsa20(bench_ctx *ctx)
+{
+   return salsa20_memory(ctx->key, 32, 20, ctx->iv, 8, 0, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_xsalsa20(bench_ctx *ctx)
+{
+   return xsalsa20_memory(ctx->key, 32, 20, ctx->iv, 24, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_sosemanuk(bench_ctx *ctx)
+{
+   return sosemanuk_memory(ctx->key, 32, ctx->iv, 16, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_rabbit(bench_ctx *ctx)
+{
+   return rabbit_memory(ctx->key, 16, ctx->iv, 8, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_rc4(bench_ctx *ctx)
+{
+   return rc4_stream_memory(ctx->key, 16, ctx->in, ctx->len, ctx->out);
+}
+
+static int s_sober128(bench_ctx *ctx)
+{
+   return sober128_stream_memory(ctx->key, 16, ctx->iv, 16, ctx->in, ctx->len, ctx->out);
+}
+
+/* ---- key derivation ---- */
+
+static int s_pbkdf2(bench_ctx *ctx)
+{
+   unsigned long outlen = 32;
+   return pkcs_5_alg2(ctx->key, 16, ctx->iv, 16, BENCH_KDF_ITER, ctx->idx, ctx->tag, &outlen);
+}
+
+/* ---- public key, only curve25519 works without a math provider ---- */
+
+static int s_pk_setup(bench_ctx *ctx)
+{
+   int err;
+   if ((err = chacha20_prng_start(&ctx->prng)) != CRYPT_OK) return err;
+   if ((err = chacha20_prng_add_entropy(ctx->key, 32, &ctx->prng)) != CRYPT_OK) return err;
+   return chacha20_prng_ready(&ctx->prng);
+}
+
+static int s_ed25519_setup(bench_ctx *ctx)
+{
+   unsigned long siglen = sizeof(ctx->sig);
+   int err;
+   if ((err = s_pk_setup(ctx)) != CRYPT_OK) return err;
+   if ((err = ed25519_make_key(&ctx->prng, find_prng("chacha20"), &ctx->priv)) != CRYPT_OK) return err;
+   return ed25519_sign(ctx->in, 64, ctx->sig, &siglen, &ctx->priv);
+}
+
+static int s_ed25519_keygen(bench_ctx *ctx)
+{
+   return ed25519_make_key(&ctx->prng, find_prng("chacha20"), &ctx->pub);
+}
+
+static int s_ed25519_sign(bench_ctx *ctx)
+{
+   unsigned long siglen = sizeof(ctx->sig);
+   return ed25519_sign(ctx->in, 64, ctx->sig, &siglen, &ctx->priv);
+}
+
+static int s_ed25519_verify(bench_ctx *ctx)
+{
+   int stat = 0, err;
+   if ((err = ed25519_verify(ctx->in, 64, ctx->sig, 64, &stat, &ctx->priv)) != CRYPT_OK) return err;
+   return stat == 1 ? CRYPT_OK : CRYPT_ERROR;
+}
+
+static int s_x25519_setup(bench_ctx *ctx)
+{
+   int err;
+   if ((err = s_pk_setup(ctx)) != CRYPT_OK) return err;
+   if ((err = x25519_make_key(&ctx->prng, find_prng("chacha20"), &ctx->priv)) != CRYPT_OK) return err;
+   return x25519_make_key(&ctx->prng, find_prng("chacha20"), &ctx->pub);
+}
+
+static int s_x25519_keygen(bench_ctx *ctx)
+{
+   curve25519_key key;
+   return x25519_make_key(&ctx->prng, find_prng("chacha20"), &key);
+}
+
+static int s_x25519_shared(bench_ctx *ctx)
+{
+   unsigned long outlen = sizeof(ctx->tag);
+   return x25519_shared_secret(&ctx->priv, &ctx->pub, ctx->tag, &outlen);
+}
+
+/* ---- driver ---- */
+
+static bench benches[TAB_SIZE * 3 + 64];
+static int nbenches;
+
+static void s_add(const char *category, const char *name, int idx, int sized,
+                  int (*setup)(bench_ctx *), int (*run)(bench_ctx *))
+{
+   bench *b = &benches[nbenches++];
+   b->category = category;
+   snprintf(b->name, sizeof(b->name), "%s", name);
+   b->idx   = idx;
+   b->sized = sized;
+   b->setup = setup;
+   b->run   = run;
+}
+
+static void s_build_list(void)
+{
+   char name[64];
+   int x, aes = find_cipher("aes");
+
+   for (x = 0; x < TAB_SIZE; x++) {
+      if (cipher_descriptor[x].name == NULL) continue;
+      s_add("cipher", cipher_descriptor[x].name, x, 1, s_cipher_setup, s_cipher_ecb);
+      snprintf(name, sizeof(name), "%s-keysetup", cipher_descriptor[x].name);
+      s_add("cipher", name, x, 0, NULL, s_cipher_keysetup);
+   }
+
+   s_add("mode", "aes-ecb-encrypt", aes, 1, s_ecb_setup, s_ecb_enc);
+   s_add("mode", "aes-ecb-decrypt", aes, 1, s_ecb_setup, s_ecb_dec);
+   s_add("mode", "aes-cbc-encrypt", aes, 1, s_cbc_setup, s_cbc_enc);
+   s_add("mode", "aes-cbc-decrypt", aes, 1, s_cbc_setup, s_cbc_dec);
+   s_add("mode", "aes-ctr", aes, 1, s_ctr_setup, s_ctr_enc);
+   s_add("mode", "aes-cfb", aes, 1, s_cfb_setup, s_cfb_enc);
+   s_add("mode", "aes-ofb", aes, 1, s_ofb_setup, s_ofb_enc);
+   s_add("mode", "aes-xts-encrypt", aes, 1, s_xts_setup, s_xts_enc);
+   s_add("mode", "aes-xts-decrypt", aes, 1, s_xts_setup, s_xts_dec);
+
+   for (x = 0; x < TAB_SIZE; x++) {
+      if (hash_descriptor[x].name == NULL) continue;
+      s_add("hash", hash_descriptor[x].name, x, 1, NULL, s_hash);
+   }
+
+   s_add("mac", "hmac-sha1", find_hash("sha1"), 1, NULL, s_hmac);
+   s_add("mac", "hmac-sha256", find_hash("sha256"), 1, NULL, s_hmac);
+   s_add("mac", "hmac-sha512", find_hash("sha512"), 1, NULL, s_hmac);
+   s_add("mac", "omac-aes", aes, 1, NULL, s_omac);
+   s_add("mac", "pmac-aes", aes, 1, NULL, s_pmac);
+   s_add("mac", "xcbc-aes", aes, 1, NULL, s_xcbc);
+   s_add("mac", "f9-aes", aes, 1, NULL, s_f9);
+   s_add("mac", "pelican", aes, 1, NULL, s_pelican);
+   s_add("mac", "poly1305", -1, 1, NULL, s_poly1305);
+   s_add("mac", "blake2smac", -1, 1, NULL, s_blake2smac);
+   s_add("mac", "blake2bmac", -1, 1, NULL, s_blake2bmac);
+
+   s_add("aead", "aes-gcm", aes, 1, NULL, s_gcm);
+   s_add("aead", "aes-ccm", aes, 1, NULL, s_ccm);
+   s_add("aead", "aes-eax", aes, 1, NULL, s_eax);
+   s_add("aead", "aes-ocb3", aes, 1, NULL, s_ocb3);
+   s_add("aead", "chacha20poly1305", -1, 1, NULL, s_chacha20poly1305);
+
+   s_add("stream", "chacha20", -1, 1, NULL, s_chacha);
+   s_add("stream", "salsa20", -1, 1, NULL, s_salsa20);
+   s_add("stream", "xsalsa20", -1, 1, NULL, s_xsalsa20);
+   s_add("stream", "sosemanuk", -1, 1, NULL, s_sosemanuk);
+   s_add("stream", "rabbit", -1, 1, NULL, s_rabbit);
+   s_add("stream", "rc4", -1, 1, NULL, s_rc4);
+   s_add("stream", "sober128", -1, 1, NULL, s_sober128);
+
+   snprintf(name, sizeof(name), "pbkdf2-sha1-%d", BENCH_KDF_ITER);
+   s_add("kdf", name, find_hash("sha1"), 0, NULL, s_pbkdf2);
+   snprintf(name, sizeof(name), "pbkdf2-sha256-%d", BENCH_KDF_ITER);
+   s_add("kdf", name, find_hash("sha256"), 0, NULL, s_pbkdf2);
+   snprintf(name, sizeof(name), "pbkdf2-sha512-%d", BENCH_KDF_ITER);
+   s_add("kdf", name, find_hash("sha512"), 0, NULL, s_pbkdf2);
+
+   s_add("pk", "ed25519-keygen", -1, 0, s_pk_setup, s_ed25519_keygen);
+   s_add("pk", "ed25519-sign", -1, 0, s_ed25519_setup, s_ed25519_sign);
+   s_add("pk", "ed25519-verify", -1, 0, s_ed25519_setup, s_ed25519_verify);
+   s_add("pk", "x25519-keygen", -1, 0, s_pk_setup, s_x25519_keygen);
+   s_add("pk", "x25519-shared-secret", -1, 0, s_x25519_setup, s_x25519_shared);
+}
+
+static int s_job_init(bench_job *job, const bench *b, unsigned long len)
+{
+   XMEMSET(job, 0, sizeof(*job));
+   job->b       = b;
+   job->ctx.idx = b->idx;
+   job->ctx.len = len;
+   job->ctx.in  = XMALLOC(BENCH_MAX_SIZE);
+   job->ctx.out = XMALLOC(BENCH_MAX_SIZE);
+   if (job->ctx.in == NULL || job->ctx.out == NULL) {
+      return CRYPT_MEM;
+   }
+   s_fill(job->ctx.in, BENCH_MAX_SIZE);
+   s_fill(job->ctx.key, sizeof(job->ctx.key));
+   s_fill(job->ctx.iv, sizeof(job->ctx.iv));
+   return b->setup != NULL ? b->setup(&job->ctx) : CRYPT_OK;
+}
+
+static void s_job_done(bench_job *job)
+{
+   XFREE(job->ctx.in);
+   XFREE(job->ctx.out);
+}
+
+static void *s_job_thread(void *arg)
+{
+   bench_job *job = arg;
+   unsigned long x;
+
+   pthread_mutex_lock(&opts.lock);
+   while (!opts.go) {
+      pthread_cond_wait(&opts.cond, &opts.lock);
+   }
+   pthread_mutex_unlock(&opts.lock);
+
+   for (x = 0; x < job->iterations && job->err == CRYPT_OK; x++) {
+      job->err = job->b->run(&job->ctx);
+   }
+   return NULL;
+}
+
+static void s_emit(const bench *b, unsigned long len, long threads, unsigned long ops,
+                   double secs, double cycles, const char *error)
+{
+   printf("%s\n    {\"category\": \"%s\", \"name\": \"%s\", \"size\": %lu, \"threads\": %ld",
+          opts.first ? "" : ",", b->category, b->name, b->sized ? len : 0UL, threads);
+   opts.first = 0;
+   if (error != NULL) {
+      printf(", \"error\": \"%s\"}", error);
+      return;
+   }
+   printf(", \"ops\": %lu, \"seconds\": %.6f, \"ops_per_sec\": %.2f", ops, secs, (double)ops / secs);
+   if (b->sized) {
+      printf(", \"mb_per_sec\": %.2f", (double)ops * (double)len / secs / 1e6);
+   }
+   if (cycles > 0) {
+      if (b->sized) {
+         printf(", \"cycles_per_byte\": %.3f", cycles / ((double)ops * (double)len));
+      } else {
+         printf(", \"cycles_per_op\": %.0f", cycles / (double)ops);
+      }
+   }
+   printf("}");
+}
+
+static void s_measure(const bench *b, unsigned long len)
+{
+   bench_job jobs[64];
+   unsigned long n, x;
+   double t, op_time, cycles;
+   ulong64 c;
+   int err, i, t_idx;
+
+   if (b->sized && XSTRCMP(b->category, "cipher") == 0) {
+      /* ECB over raw blocks, round down to whole blocks */
+      unsigned long bl = (unsigned long)cipher_descriptor[b->idx].block_length;
+      if (len < bl) return;
+      len -= len % bl;
+   }
+
+   /* single-threaded: calibrate until a run takes at least min_time */
+   if ((err = s_job_init(&jobs[0], b, len)) != CRYPT_OK || (err = b->run(&jobs[0].ctx)) != CRYPT_OK) {
+      s_emit(b, len, 1, 0, 0, 0, error_to_string(err));
+      s_job_done(&jobs[0]);
+      return;
+   }
+   for (n = 1;; n *= 2) {
+      c = s_cycles();
+      t = s_now();
+      for (x = 0; x < n; x++) {
+         if ((err = b->run(&jobs[0].ctx)) != CRYPT_OK) break;
+      }
+      t = s_now() - t;
+      c = s_cycles() - c;
+      if (err != CRYPT_OK || t >= opts.min_time) break;
+   }
+   s_job_done(&jobs[0]);
+   op_time = t / (double)n;
+   cycles  = (double)c;
+
+   for (t_idx = 0; t_idx < opts.nthreads; t_idx++) {
+      long threads = opts.threads[t_idx];
+      if (threads == 1) {
+         s_emit(b, len, 1, n, t, cycles, err == CRYPT_OK ? NULL : error_to_string(err));
+         continue;
+      }
+      if (err != CRYPT_OK) continue;
+
+      opts.go = 0;
+      for (i = 0; i < threads; i++) {
+         if ((err = s_job_init(&jobs[i], b, len)) == CRYPT_OK) {
+            jobs[i].iterations = (unsigned long)(opts.min_time / op_time) + 1;
+            if (pthread_create(&jobs[i].thread, NULL, s_job_thread, &jobs[i]) != 0) {
+               err = CRYPT_ERROR;
+            }
+         }
+         if (err != CRYPT_OK) {
+            s_job_done(&jobs[i]);
+            break;
+         }
+      }
+      /* only the jobs whose thread started are joined and freed below */
+      threads = i;
+      pthread_mutex_lock(&opts.lock);
+      opts.go = 1;
+      t = s_now();
+      pthread_cond_broadcast(&opts.cond);
+      pthread_mutex_unlock(&opts.lock);
+      for (i = 0, n = 0; i < threads; i++) {
+         pthread_join(jobs[i].thread, NULL);
+         if (jobs[i].err != CRYPT_OK) err = jobs[i].err;
+         n += jobs[i].iterations;
+      }
+      t = s_now() - t;
+      for (i = 0; i < threads; i++) {
+         s_job_done(&jobs[i]);
+      }
+      s_emit(b, len, threads, n, t, 0, err == CRYPT_OK ? NULL : error_to_string(err));
+   }
+}
+
+int main(int argc, char **argv)
+{
+   static const unsigned long default_sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536, BENCH_MAX_SIZE };
+   long list[BENCH_MAX_LIST];
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   int x, y;
+
+   opts.min_time = 0.1;
+   opts.nsizes = (int)(sizeof(default_sizes) / sizeof(default_sizes[0]));
+   for (x = 0; x < opts.nsizes; x++) {
+      opts.sizes[x] = default_sizes[x];
+   }
+   opts.threads[opts.nthreads++] = 1;
+   if (cpus > 1) {
+      opts.threads[opts.nthreads++] = cpus > 64 ? 64 : cpus;
+   }
+
+   for (x = 1; x < argc; x++) {
+      if (strcmp(argv[x], "--filter") == 0 && x + 1 < argc) {
+         opts.filter = argv[++x];
+      } else if (strcmp(argv[x], "--min-time") == 0 && x + 1 < argc) {
+         opts.min_time = strtod(argv[++x], NULL);
+      } else if (strcmp(argv[x], "--threads") == 0 && x + 1 < argc) {
+         opts.nthreads = s_parse_list(argv[++x], opts.threads, BENCH_MAX_LIST);
+      } else if (strcmp(argv[x], "--sizes") == 0 && x + 1 < argc) {
+         opts.nsizes = s_parse_list(argv[++x], list, BENCH_MAX_LIST);
+         for (y = 0; y < opts.nsizes; y++) {
+            opts.sizes[y] = (unsigned long)list[y];
+         }
+      } else {
+         fprintf(stderr, "usage: %s [--filter STR] [--threads N[,N...]] [--sizes N[,N...]] [--min-time SECONDS]\n", argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   for (x = 0; x < opts.nthreads; x++) {
+      if (opts.threads[x] < 1 || opts.threads[x] > 64) opts.nthreads = -1;
+   }
+   for (x = 0; x < opts.nsizes; x++) {
+      if (opts.sizes[x] == 0 || opts.sizes[x] > BENCH_MAX_SIZE) opts.nsizes = -1;
+   }
+   if (opts.nthreads <= 0 || opts.nsizes <= 0 || opts.min_time <= 0) {
+      fprintf(stderr, "invalid arguments, threads must be 1..64 and sizes 1..%lu\n", BENCH_MAX_SIZE);
+      return EXIT_FAILURE;
+   }
+
+   register_all_ciphers();
+   register_all_hashes();
+   register_all_prngs();
+   pthread_mutex_init(&opts.lock, NULL);
+   pthread_cond_init(&opts.cond, NULL);
+   s_build_list();
+
+   printf("{\n  \"library\": \"LibTomCrypt %s\",\n  \"min_time\": %.3f,\n", SCRYPT, opts.min_time);
+   printf("  \"math\": \"%s\",\n  \"results\": [", ltc_mp.name != NULL ? ltc_mp.name : "none");
+   opts.first = 1;
+   for (x = 0; x < nbenches; x++) {
+      if (opts.filter != NULL && strstr(benches[x].name, opts.filter) == NULL &&
+          strstr(benches[x].category, opts.filter) == NULL) {
+         continue;
+      }
+      if (!benches[x].sized) {
+         s_measure(&benches[x], 0);
+         continue;
+      }
+      for (y = 0; y < opts.nsizes; y++) {
+         s_measure(&benches[x], opts.sizes[y]);
+      }
+      fflush(stdout);
+   }
+   printf("\n  ]\n}\n");
+   return EXIT_SUCCESS;
+}
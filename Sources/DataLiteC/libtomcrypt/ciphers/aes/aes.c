@@ -35,6 +35,8 @@
 #define ECB_TEST rijndael_test
 #define ECB_KS   rijndael_keysize
 
+/* with AES-NI rijndael_desc is defined next to aes_desc and dispatches the same way */
+#ifndef LTC_AES_NI
 const struct ltc_cipher_descriptor rijndael_desc =
 {
     "rijndael",
@@ -43,6 +45,7 @@ const struct ltc_cipher_descriptor rijndael_desc =
     SETUP, ECB_ENC, ECB_DEC, ECB_TEST, ECB_DONE, ECB_KS,
     NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
+#endif
 
 #else
 
@@ -20,15 +20,63 @@
 #define AES_TEST  aes_test
 #define AES_KS    aes_keysize
 
+#if defined(LTC_AES_NI)
+static int s_aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+#define AES_CBC_DEC s_aes_cbc_decrypt
+#else
+#define AES_CBC_DEC NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_CCM_MODE)
+static int s_aes_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                            symmetric_key       *uskey,
+                            const unsigned char *nonce,  unsigned long noncelen,
+                            const unsigned char *header, unsigned long headerlen,
+                                  unsigned char *pt,     unsigned long ptlen,
+                                  unsigned char *ct,
+                                  unsigned char *tag,    unsigned long *taglen,
+                                            int  direction);
+#define AES_CCM s_aes_ccm_memory
+#else
+#define AES_CCM NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_XTS_MODE)
+static int s_aes_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                             const symmetric_key *skey1, const symmetric_key *skey2);
+static int s_aes_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                             const symmetric_key *skey1, const symmetric_key *skey2);
+#define AES_XTS_ENC s_aes_xts_encrypt
+#define AES_XTS_DEC s_aes_xts_decrypt
+#else
+#define AES_XTS_ENC NULL
+#define AES_XTS_DEC NULL
+#endif
+
 const struct ltc_cipher_descriptor aes_desc =
 {
     "aes",
     6,
     16, 32, 16, 10,
     AES_SETUP, AES_ENC, AES_DEC, AES_TEST, AES_DONE, AES_KS,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    NULL, NULL, NULL, AES_CBC_DEC, NULL, NULL, NULL, AES_CCM, NULL, NULL, NULL, NULL, AES_XTS_ENC, AES_XTS_DEC
 };
 
+#if defined(LTC_AES_NI)
+/* Same as aes_desc under the old name. Code that registers "rijndael", like
+ * SQLCipher's LibTomCrypt provider, gets AES-NI and the accelerators too. The
+ * key schedule comes from aes_setup(), so it must not be mixed with direct
+ * calls to the rijndael_*() functions. */
+const struct ltc_cipher_descriptor rijndael_desc =
+{
+    "rijndael",
+    6,
+    16, 32, 16, 10,
+    AES_SETUP, AES_ENC, AES_DEC, AES_TEST, AES_DONE, AES_KS,
+    NULL, NULL, NULL, AES_CBC_DEC, NULL, NULL, NULL, AES_CCM, NULL, NULL, NULL, NULL, AES_XTS_ENC, AES_XTS_DEC
+};
+#endif
+
 #else
 
 #define AES_SETUP aes_enc_setup
@@ -48,31 +96,11 @@ const struct ltc_cipher_descriptor aes_enc_desc =
 
 #endif
 
-/* Code partially borrowed from https://software.intel.com/content/www/us/en/develop/articles/intel-sha-extensions.html */
 #if defined(LTC_AES_NI)
 static LTC_INLINE int s_aesni_is_supported(void)
 {
-   static int initialized = 0, is_supported = 0;
-
-   if (initialized == 0) {
-      int a, b, c, d;
-
-      /* Look for CPUID.1.0.ECX[19] (SSE4.1) and CPUID.1.0.ECX[25] (AES-NI)
-       * EAX = 1, ECX = 0
-       */
-      a = 1;
-      c = 0;
-
-      __asm__ volatile ("cpuid"
-           :"=a"(a), "=b"(b), "=c"(c), "=d"(d)
-           :"a"(a), "c"(c)
-          );
-
-      is_supported = ((c >> 19) & 1) && ((c >> 25) & 1);
-      initialized = 1;
-   }
-
-   return is_supported;
+   const unsigned int f = LTC_CPU_SSE41 | LTC_CPU_AESNI;
+   return (ltc_cpu_features() & f) == f;
 }
 
 #ifndef ENCRYPT_ONLY
@@ -137,6 +165,105 @@ int AES_DEC(const unsigned char *ct, unsigned char *pt, const symmetric_key *ske
 #endif
    return rijndael_ecb_decrypt(ct, pt, skey);
 }
+
+#ifdef LTC_AES_NI
+/**
+  CBC decrypt multiple blocks with AES
+  @param ct     The input ciphertext
+  @param pt     [out] The output plaintext
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   unsigned char tmp[16], prev[16];
+   int err, x;
+
+   if (s_aesni_is_supported()) {
+      return aesni_cbc_decrypt(ct, pt, blocks, IV, skey);
+   }
+
+   for (; blocks > 0; blocks--) {
+      XMEMCPY(prev, ct, 16);
+      if ((err = rijndael_ecb_decrypt(ct, tmp, skey)) != CRYPT_OK) {
+         return err;
+      }
+      for (x = 0; x < 16; x++) {
+         pt[x] = tmp[x] ^ IV[x];
+      }
+      XMEMCPY(IV, prev, 16);
+      ct += 16;
+      pt += 16;
+   }
+   return CRYPT_OK;
+}
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_CCM_MODE)
+/**
+  CCM encrypt/decrypt with AES-NI, see ccm_memory() for the parameters
+  @return CRYPT_OK if successful, CRYPT_NOP if the CPU lacks AES-NI and ccm_memory() has to do it
+*/
+static int s_aes_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                            symmetric_key       *uskey,
+                            const unsigned char *nonce,  unsigned long noncelen,
+                            const unsigned char *header, unsigned long headerlen,
+                                  unsigned char *pt,     unsigned long ptlen,
+                                  unsigned char *ct,
+                                  unsigned char *tag,    unsigned long *taglen,
+                                            int  direction)
+{
+   if (s_aesni_is_supported()) {
+      return aesni_ccm_memory(key, keylen, uskey, nonce, noncelen, header, headerlen,
+                              pt, ptlen, ct, tag, taglen, direction);
+   }
+   return CRYPT_NOP;
+}
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_XTS_MODE)
+/**
+  XTS encrypt multiple blocks with AES
+  @param pt     The input plaintext
+  @param ct     [out] The output ciphertext
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, plain on input, the encrypted tweak of the next block on output
+  @param skey1  The key the data is encrypted with
+  @param skey2  The key the tweak is encrypted with
+  @return CRYPT_OK if successful, CRYPT_NOP if the CPU lacks AES-NI
+*/
+static int s_aes_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                             const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   if (s_aesni_is_supported()) {
+      return aesni_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2);
+   }
+   /* let xts_encrypt() do it with the portable code */
+   return CRYPT_NOP;
+}
+
+/**
+  XTS decrypt multiple blocks with AES
+  @param ct     The input ciphertext
+  @param pt     [out] The output plaintext
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, plain on input, the encrypted tweak of the next block on output
+  @param skey1  The key the data is encrypted with
+  @param skey2  The key the tweak is encrypted with
+  @return CRYPT_OK if successful, CRYPT_NOP if the CPU lacks AES-NI
+*/
+static int s_aes_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                             const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   if (s_aesni_is_supported()) {
+      return aesni_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2);
+   }
+   /* let xts_decrypt() do it with the portable code */
+   return CRYPT_NOP;
+}
+#endif
 #endif /* ENCRYPT_ONLY */
 
 /**
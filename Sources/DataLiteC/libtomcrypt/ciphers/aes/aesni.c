@@ -9,15 +9,33 @@
 
 #include "tomcrypt_private.h"
 
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wconversion"
+#pragma clang diagnostic ignored "-Wshorten-64-to-32"
+
 #if defined(LTC_AES_NI)
 
+#if defined(LTC_CCM_MODE)
+#define AESNI_CCM aesni_ccm_memory
+#else
+#define AESNI_CCM NULL
+#endif
+
+#if defined(LTC_XTS_MODE)
+#define AESNI_XTS_ENC aesni_xts_encrypt
+#define AESNI_XTS_DEC aesni_xts_decrypt
+#else
+#define AESNI_XTS_ENC NULL
+#define AESNI_XTS_DEC NULL
+#endif
+
 const struct ltc_cipher_descriptor aesni_desc =
 {
     "aes",
     6,
     16, 32, 16, 10,
     aesni_setup, aesni_ecb_encrypt, aesni_ecb_decrypt, aesni_test, aesni_done, aesni_keysize,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    NULL, NULL, NULL, aesni_cbc_decrypt, NULL, NULL, NULL, AESNI_CCM, NULL, NULL, NULL, NULL, AESNI_XTS_ENC, AESNI_XTS_DEC
 };
 
 #include <emmintrin.h>
@@ -266,6 +284,551 @@ int aesni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetri
 }
 #endif
 
+/**
+  CBC decrypt multiple blocks with AES
+  The blocks are independent when decrypting, so eight of them are kept
+  in flight to hide the latency of the AESDEC instruction.
+  @param ct     The input ciphertext
+  @param pt     [out] The output plaintext
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int Nr, r;
+   const __m128i *skeys;
+   __m128i iv, k, c0, c1, c2, c3, c4, c5, c6, c7, b0, b1, b2, b3, b4, b5, b6, b7;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (__m128i*) skey->rijndael.dK;
+   iv = _mm_loadu_si128((const __m128i*) IV);
+
+   for (; blocks >= 8; blocks -= 8) {
+      k  = skeys[0];
+      c0 = _mm_loadu_si128((const __m128i*) (ct +   0)); b0 = _mm_xor_si128(c0, k);
+      c1 = _mm_loadu_si128((const __m128i*) (ct +  16)); b1 = _mm_xor_si128(c1, k);
+      c2 = _mm_loadu_si128((const __m128i*) (ct +  32)); b2 = _mm_xor_si128(c2, k);
+      c3 = _mm_loadu_si128((const __m128i*) (ct +  48)); b3 = _mm_xor_si128(c3, k);
+      c4 = _mm_loadu_si128((const __m128i*) (ct +  64)); b4 = _mm_xor_si128(c4, k);
+      c5 = _mm_loadu_si128((const __m128i*) (ct +  80)); b5 = _mm_xor_si128(c5, k);
+      c6 = _mm_loadu_si128((const __m128i*) (ct +  96)); b6 = _mm_xor_si128(c6, k);
+      c7 = _mm_loadu_si128((const __m128i*) (ct + 112)); b7 = _mm_xor_si128(c7, k);
+      for (r = 1; r < Nr; r++) {
+         k  = skeys[r];
+         b0 = _mm_aesdec_si128(b0, k);
+         b1 = _mm_aesdec_si128(b1, k);
+         b2 = _mm_aesdec_si128(b2, k);
+         b3 = _mm_aesdec_si128(b3, k);
+         b4 = _mm_aesdec_si128(b4, k);
+         b5 = _mm_aesdec_si128(b5, k);
+         b6 = _mm_aesdec_si128(b6, k);
+         b7 = _mm_aesdec_si128(b7, k);
+      }
+      k  = skeys[Nr];
+      b0 = _mm_aesdeclast_si128(b0, k);
+      b1 = _mm_aesdeclast_si128(b1, k);
+      b2 = _mm_aesdeclast_si128(b2, k);
+      b3 = _mm_aesdeclast_si128(b3, k);
+      b4 = _mm_aesdeclast_si128(b4, k);
+      b5 = _mm_aesdeclast_si128(b5, k);
+      b6 = _mm_aesdeclast_si128(b6, k);
+      b7 = _mm_aesdeclast_si128(b7, k);
+      _mm_storeu_si128((__m128i*) (pt +   0), _mm_xor_si128(b0, iv));
+      _mm_storeu_si128((__m128i*) (pt +  16), _mm_xor_si128(b1, c0));
+      _mm_storeu_si128((__m128i*) (pt +  32), _mm_xor_si128(b2, c1));
+      _mm_storeu_si128((__m128i*) (pt +  48), _mm_xor_si128(b3, c2));
+      _mm_storeu_si128((__m128i*) (pt +  64), _mm_xor_si128(b4, c3));
+      _mm_storeu_si128((__m128i*) (pt +  80), _mm_xor_si128(b5, c4));
+      _mm_storeu_si128((__m128i*) (pt +  96), _mm_xor_si128(b6, c5));
+      _mm_storeu_si128((__m128i*) (pt + 112), _mm_xor_si128(b7, c6));
+      iv = c7;
+      ct += 128;
+      pt += 128;
+   }
+
+   for (; blocks > 0; blocks--) {
+      c0 = _mm_loadu_si128((const __m128i*) ct);
+      b0 = _mm_xor_si128(c0, skeys[0]);
+      for (r = 1; r < Nr; r++) {
+         b0 = _mm_aesdec_si128(b0, skeys[r]);
+      }
+      b0 = _mm_aesdeclast_si128(b0, skeys[Nr]);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(b0, iv));
+      iv = c0;
+      ct += 16;
+      pt += 16;
+   }
+
+   _mm_storeu_si128((__m128i*) IV, iv);
+
+   return CRYPT_OK;
+}
+
+#if defined(LTC_XTS_MODE)
+/* T * x^k in GF(2^128) for 1 <= k <= 8, with shifts only so that the eight tweaks
+ * of a batch are computed from the same value instead of one after the other */
+#define XTS_MUL_XK(t, k, r) do {                                              \
+   __m128i hi_  = _mm_srli_epi64(t, 64 - (k));                                \
+   __m128i top_ = _mm_srli_si128(hi_, 8);                                     \
+   r = _mm_xor_si128(_mm_slli_epi64(t, k), _mm_slli_si128(hi_, 8));           \
+   r = _mm_xor_si128(r, _mm_xor_si128(top_, _mm_slli_epi64(top_, 1)));        \
+   r = _mm_xor_si128(r, _mm_xor_si128(_mm_slli_epi64(top_, 2), _mm_slli_epi64(top_, 7))); \
+} while (0)
+
+#define XTS_TWEAKS8(t)                                                        \
+   XTS_MUL_XK(t, 1, t1); XTS_MUL_XK(t, 2, t2); XTS_MUL_XK(t, 3, t3);         \
+   XTS_MUL_XK(t, 4, t4); XTS_MUL_XK(t, 5, t5); XTS_MUL_XK(t, 6, t6);         \
+   XTS_MUL_XK(t, 7, t7)
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_aesni_xts_tweak(const unsigned char *tweak, const symmetric_key *skey2)
+{
+   const __m128i *skeys = (const __m128i*) skey2->rijndael.eK;
+   __m128i t;
+   int r, Nr = skey2->rijndael.Nr;
+
+   t = _mm_xor_si128(_mm_loadu_si128((const __m128i*) tweak), skeys[0]);
+   for (r = 1; r < Nr; r++) {
+      t = _mm_aesenc_si128(t, skeys[r]);
+   }
+   return _mm_aesenclast_si128(t, skeys[Nr]);
+}
+
+/**
+  XTS encrypt multiple blocks with AES
+  Eight blocks are kept in flight, their tweaks are derived from the tweak
+  of the first block of the batch by shifting.
+  @param pt     The input plaintext
+  @param ct     [out] The output ciphertext
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, plain on input, the encrypted tweak of the next block on output
+  @param skey1  The key the data is encrypted with
+  @param skey2  The key the tweak is encrypted with
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                      const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int Nr, r;
+   const __m128i *skeys;
+   __m128i k, t, t1, t2, t3, t4, t5, t6, t7, b0, b1, b2, b3, b4, b5, b6, b7;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+   if (skey2->rijndael.Nr < 2 || skey2->rijndael.Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (const __m128i*) skey1->rijndael.eK;
+   t = s_aesni_xts_tweak(tweak, skey2);
+
+   for (; blocks >= 8; blocks -= 8) {
+      XTS_TWEAKS8(t);
+      k  = skeys[0];
+      b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +   0)), _mm_xor_si128(t,  k));
+      b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  16)), _mm_xor_si128(t1, k));
+      b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  32)), _mm_xor_si128(t2, k));
+      b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  48)), _mm_xor_si128(t3, k));
+      b4 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  64)), _mm_xor_si128(t4, k));
+      b5 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  80)), _mm_xor_si128(t5, k));
+      b6 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt +  96)), _mm_xor_si128(t6, k));
+      b7 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt + 112)), _mm_xor_si128(t7, k));
+      for (r = 1; r < Nr; r++) {
+         k  = skeys[r];
+         b0 = _mm_aesenc_si128(b0, k);
+         b1 = _mm_aesenc_si128(b1, k);
+         b2 = _mm_aesenc_si128(b2, k);
+         b3 = _mm_aesenc_si128(b3, k);
+         b4 = _mm_aesenc_si128(b4, k);
+         b5 = _mm_aesenc_si128(b5, k);
+         b6 = _mm_aesenc_si128(b6, k);
+         b7 = _mm_aesenc_si128(b7, k);
+      }
+      k  = skeys[Nr];
+      b0 = _mm_aesenclast_si128(b0, k);
+      b1 = _mm_aesenclast_si128(b1, k);
+      b2 = _mm_aesenclast_si128(b2, k);
+      b3 = _mm_aesenclast_si128(b3, k);
+      b4 = _mm_aesenclast_si128(b4, k);
+      b5 = _mm_aesenclast_si128(b5, k);
+      b6 = _mm_aesenclast_si128(b6, k);
+      b7 = _mm_aesenclast_si128(b7, k);
+      _mm_storeu_si128((__m128i*) (ct +   0), _mm_xor_si128(b0, t));
+      _mm_storeu_si128((__m128i*) (ct +  16), _mm_xor_si128(b1, t1));
+      _mm_storeu_si128((__m128i*) (ct +  32), _mm_xor_si128(b2, t2));
+      _mm_storeu_si128((__m128i*) (ct +  48), _mm_xor_si128(b3, t3));
+      _mm_storeu_si128((__m128i*) (ct +  64), _mm_xor_si128(b4, t4));
+      _mm_storeu_si128((__m128i*) (ct +  80), _mm_xor_si128(b5, t5));
+      _mm_storeu_si128((__m128i*) (ct +  96), _mm_xor_si128(b6, t6));
+      _mm_storeu_si128((__m128i*) (ct + 112), _mm_xor_si128(b7, t7));
+      XTS_MUL_XK(t, 8, t);
+      pt += 128;
+      ct += 128;
+   }
+
+   for (; blocks > 0; blocks--) {
+      b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pt), _mm_xor_si128(t, skeys[0]));
+      for (r = 1; r < Nr; r++) {
+         b0 = _mm_aesenc_si128(b0, skeys[r]);
+      }
+      b0 = _mm_aesenclast_si128(b0, skeys[Nr]);
+      _mm_storeu_si128((__m128i*) ct, _mm_xor_si128(b0, t));
+      XTS_MUL_XK(t, 1, t);
+      pt += 16;
+      ct += 16;
+   }
+
+   _mm_storeu_si128((__m128i*) tweak, t);
+
+   return CRYPT_OK;
+}
+
+/**
+  XTS decrypt multiple blocks with AES
+  @param ct     The input ciphertext
+  @param pt     [out] The output plaintext
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, plain on input, the encrypted tweak of the next block on output
+  @param skey1  The key the data is encrypted with
+  @param skey2  The key the tweak is encrypted with
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                      const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int Nr, r;
+   const __m128i *skeys;
+   __m128i k, t, t1, t2, t3, t4, t5, t6, t7, b0, b1, b2, b3, b4, b5, b6, b7;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+   if (skey2->rijndael.Nr < 2 || skey2->rijndael.Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (const __m128i*) skey1->rijndael.dK;
+   t = s_aesni_xts_tweak(tweak, skey2);
+
+   for (; blocks >= 8; blocks -= 8) {
+      XTS_TWEAKS8(t);
+      k  = skeys[0];
+      b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +   0)), _mm_xor_si128(t,  k));
+      b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  16)), _mm_xor_si128(t1, k));
+      b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  32)), _mm_xor_si128(t2, k));
+      b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  48)), _mm_xor_si128(t3, k));
+      b4 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  64)), _mm_xor_si128(t4, k));
+      b5 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  80)), _mm_xor_si128(t5, k));
+      b6 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct +  96)), _mm_xor_si128(t6, k));
+      b7 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct + 112)), _mm_xor_si128(t7, k));
+      for (r = 1; r < Nr; r++) {
+         k  = skeys[r];
+         b0 = _mm_aesdec_si128(b0, k);
+         b1 = _mm_aesdec_si128(b1, k);
+         b2 = _mm_aesdec_si128(b2, k);
+         b3 = _mm_aesdec_si128(b3, k);
+         b4 = _mm_aesdec_si128(b4, k);
+         b5 = _mm_aesdec_si128(b5, k);
+         b6 = _mm_aesdec_si128(b6, k);
+         b7 = _mm_aesdec_si128(b7, k);
+      }
+      k  = skeys[Nr];
+      b0 = _mm_aesdeclast_si128(b0, k);
+      b1 = _mm_aesdeclast_si128(b1, k);
+      b2 = _mm_aesdeclast_si128(b2, k);
+      b3 = _mm_aesdeclast_si128(b3, k);
+      b4 = _mm_aesdeclast_si128(b4, k);
+      b5 = _mm_aesdeclast_si128(b5, k);
+      b6 = _mm_aesdeclast_si128(b6, k);
+      b7 = _mm_aesdeclast_si128(b7, k);
+      _mm_storeu_si128((__m128i*) (pt +   0), _mm_xor_si128(b0, t));
+      _mm_storeu_si128((__m128i*) (pt +  16), _mm_xor_si128(b1, t1));
+      _mm_storeu_si128((__m128i*) (pt +  32), _mm_xor_si128(b2, t2));
+      _mm_storeu_si128((__m128i*) (pt +  48), _mm_xor_si128(b3, t3));
+      _mm_storeu_si128((__m128i*) (pt +  64), _mm_xor_si128(b4, t4));
+      _mm_storeu_si128((__m128i*) (pt +  80), _mm_xor_si128(b5, t5));
+      _mm_storeu_si128((__m128i*) (pt +  96), _mm_xor_si128(b6, t6));
+      _mm_storeu_si128((__m128i*) (pt + 112), _mm_xor_si128(b7, t7));
+      XTS_MUL_XK(t, 8, t);
+      ct += 128;
+      pt += 128;
+   }
+
+   for (; blocks > 0; blocks--) {
+      b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) ct), _mm_xor_si128(t, skeys[0]));
+      for (r = 1; r < Nr; r++) {
+         b0 = _mm_aesdec_si128(b0, skeys[r]);
+      }
+      b0 = _mm_aesdeclast_si128(b0, skeys[Nr]);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(b0, t));
+      XTS_MUL_XK(t, 1, t);
+      ct += 16;
+      pt += 16;
+   }
+
+   _mm_storeu_si128((__m128i*) tweak, t);
+
+   return CRYPT_OK;
+}
+#endif /* LTC_XTS_MODE */
+
+#if defined(LTC_CCM_MODE)
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_aesni_ccm_mac(__m128i mac, __m128i block, const __m128i *skeys, int Nr)
+{
+   int r;
+
+   mac = _mm_xor_si128(mac, _mm_xor_si128(block, skeys[0]));
+   for (r = 1; r < Nr; r++) {
+      mac = _mm_aesenc_si128(mac, skeys[r]);
+   }
+   return _mm_aesenclast_si128(mac, skeys[Nr]);
+}
+
+/**
+  CCM encrypt/decrypt and produce an authentication tag with AES
+  The CBC-MAC is a chain of dependent blocks, so the CTR keystream of the
+  next block is computed in the same rounds to use the slots the chain
+  leaves free.
+  @param key        The secret key to use
+  @param keylen     The length of the secret key (octets)
+  @param uskey      A previously scheduled key [optional can be NULL]
+  @param nonce      The session nonce [use once]
+  @param noncelen   The length of the nonce
+  @param header     The header for the session
+  @param headerlen  The length of the header (octets)
+  @param pt         [in/out] The plaintext
+  @param ptlen      The length of the plaintext (octets)
+  @param ct         [in/out] The ciphertext
+  @param tag        [in/out] The authentication tag
+  @param taglen     [in/out] The max size and resulting size of the authentication tag
+  @param direction  Encrypt or Decrypt direction (CCM_ENCRYPT or CCM_DECRYPT)
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes,sse4.1")))
+int aesni_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                     symmetric_key       *uskey,
+                     const unsigned char *nonce,  unsigned long noncelen,
+                     const unsigned char *header, unsigned long headerlen,
+                           unsigned char *pt,     unsigned long ptlen,
+                           unsigned char *ct,
+                           unsigned char *tag,    unsigned long *taglen,
+                                     int  direction)
+{
+   unsigned char  buf[16], mac[16];
+   const unsigned char *in;
+   unsigned char *out;
+   const __m128i *skeys;
+   const __m128i  bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+   const __m128i  one   = _mm_set_epi32(0, 0, 0, 1);
+   __m128i        M, S0, ks, c, ctr, d, k;
+   symmetric_key *skey;
+   unsigned long  L, len, x, y;
+   int            Nr, r, err;
+
+   if (uskey == NULL) {
+      LTC_ARGCHK(key    != NULL);
+   }
+   LTC_ARGCHK(nonce  != NULL);
+   if (headerlen > 0) {
+      LTC_ARGCHK(header != NULL);
+   }
+   LTC_ARGCHK(pt     != NULL);
+   LTC_ARGCHK(ct     != NULL);
+   LTC_ARGCHK(tag    != NULL);
+   LTC_ARGCHK(taglen != NULL);
+
+   if (*taglen < 4 || *taglen > 16 || (*taglen % 2) == 1 || headerlen > 0x7fffffffu) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the L value, as in ccm_memory() */
+   for (len = ptlen, L = 0; len; len >>= 8) {
+      ++L;
+   }
+   if (L <= 1) {
+      L = 2;
+   }
+   noncelen = (noncelen > 13) ? 13 : noncelen;
+   if ((15 - noncelen) > L) {
+      L = 15 - noncelen;
+   }
+   if (L > 8) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   if (uskey == NULL) {
+      skey = XMALLOC(sizeof(*skey));
+      if (skey == NULL) {
+         return CRYPT_MEM;
+      }
+      if ((err = aesni_setup(key, (int)keylen, 0, skey)) != CRYPT_OK) {
+         XFREE(skey);
+         return err;
+      }
+   } else {
+      skey = uskey;
+   }
+
+   Nr = skey->rijndael.Nr;
+   if (Nr < 2 || Nr > 16) {
+      err = CRYPT_INVALID_ROUNDS;
+      goto LBL_ERR;
+   }
+   skeys = (const __m128i*) skey->rijndael.eK;
+
+   /* B_0 == flags | Nonce N | l(m) */
+   buf[0] = (unsigned char)(((headerlen > 0) ? (1<<6) : 0) | (((*taglen - 2)>>1)<<3) | (L-1));
+   XMEMCPY(buf + 1, nonce, 15 - L);
+   for (x = 15, len = ptlen; x > 15 - L; x--, len >>= 8) {
+      buf[x] = (unsigned char)(len & 255);
+   }
+   M = s_aesni_ccm_mac(_mm_setzero_si128(), _mm_loadu_si128((const __m128i*) buf), skeys, Nr);
+
+   /* the header, prefixed with its length and padded with zeros */
+   if (headerlen > 0) {
+      XMEMSET(buf, 0, sizeof(buf));
+      x = 0;
+      if (headerlen < ((1UL<<16) - (1UL<<8))) {
+         buf[x++] = (headerlen>>8) & 255;
+         buf[x++] = headerlen & 255;
+      } else {
+         buf[x++] = 0xFF;
+         buf[x++] = 0xFE;
+         buf[x++] = (headerlen>>24) & 255;
+         buf[x++] = (headerlen>>16) & 255;
+         buf[x++] = (headerlen>>8) & 255;
+         buf[x++] = headerlen & 255;
+      }
+      y = MIN(headerlen, 16 - x);
+      XMEMCPY(buf + x, header, y);
+      M = s_aesni_ccm_mac(M, _mm_loadu_si128((const __m128i*) buf), skeys, Nr);
+      for (; y + 16 <= headerlen; y += 16) {
+         M = s_aesni_ccm_mac(M, _mm_loadu_si128((const __m128i*) (header + y)), skeys, Nr);
+      }
+      if (y < headerlen) {
+         XMEMSET(buf, 0, sizeof(buf));
+         XMEMCPY(buf, header + y, headerlen - y);
+         M = s_aesni_ccm_mac(M, _mm_loadu_si128((const __m128i*) buf), skeys, Nr);
+      }
+   }
+
+   /* A_0 == flags | Nonce N | 0, the counter is kept as a little endian number, it can't carry
+    * into the nonce as l(m) fits into L octets */
+   XMEMSET(buf, 0, sizeof(buf));
+   buf[0] = (unsigned char)(L-1);
+   XMEMCPY(buf + 1, nonce, 15 - L);
+   ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), bswap);
+
+   /* S_0 for the tag and the keystream of the first block */
+   k   = skeys[0];
+   S0  = _mm_xor_si128(_mm_shuffle_epi8(ctr, bswap), k);
+   ctr = _mm_add_epi64(ctr, one);
+   ks  = _mm_xor_si128(_mm_shuffle_epi8(ctr, bswap), k);
+   for (r = 1; r < Nr; r++) {
+      k  = skeys[r];
+      S0 = _mm_aesenc_si128(S0, k);
+      ks = _mm_aesenc_si128(ks, k);
+   }
+   S0 = _mm_aesenclast_si128(S0, skeys[Nr]);
+   ks = _mm_aesenclast_si128(ks, skeys[Nr]);
+
+   if (direction == CCM_ENCRYPT) {
+      in  = pt;
+      out = ct;
+   } else {
+      in  = ct;
+      out = pt;
+   }
+
+   for (y = 0; y + 16 <= ptlen; y += 16) {
+      d = _mm_loadu_si128((const __m128i*) (in + y));
+      c = _mm_xor_si128(d, ks);
+      _mm_storeu_si128((__m128i*) (out + y), c);
+      if (direction != CCM_ENCRYPT) {
+         d = c;
+      }
+      /* the MAC of this block and the keystream of the next one */
+      k   = skeys[0];
+      M   = _mm_xor_si128(M, _mm_xor_si128(d, k));
+      ctr = _mm_add_epi64(ctr, one);
+      ks  = _mm_xor_si128(_mm_shuffle_epi8(ctr, bswap), k);
+      for (r = 1; r < Nr; r++) {
+         k  = skeys[r];
+         M  = _mm_aesenc_si128(M, k);
+         ks = _mm_aesenc_si128(ks, k);
+      }
+      M  = _mm_aesenclast_si128(M, skeys[Nr]);
+      ks = _mm_aesenclast_si128(ks, skeys[Nr]);
+   }
+
+   if (y < ptlen) {
+      x = ptlen - y;
+      XMEMSET(buf, 0, sizeof(buf));
+      XMEMCPY(buf, in + y, x);
+      d = _mm_loadu_si128((const __m128i*) buf);
+      _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(d, ks));
+      XMEMCPY(out + y, buf, x);
+      if (direction != CCM_ENCRYPT) {
+         XMEMSET(buf + x, 0, 16 - x);
+         d = _mm_loadu_si128((const __m128i*) buf);
+      }
+      M = s_aesni_ccm_mac(M, d, skeys, Nr);
+   }
+
+   _mm_storeu_si128((__m128i*) mac, M);
+   _mm_storeu_si128((__m128i*) buf, S0);
+   if (direction == CCM_ENCRYPT) {
+      for (x = 0; x < *taglen; x++) {
+         tag[x] = mac[x] ^ buf[x];
+      }
+      err = CRYPT_OK;
+   } else {
+      for (x = 0; x < *taglen; x++) {
+         buf[x] ^= tag[x];
+      }
+      /* see ccm_memory() on the error code, the plaintext is zeroed if the tag is invalid */
+      err = XMEM_NEQ(buf, mac, *taglen);
+      if (ptlen > 0) {
+         copy_or_zeromem(pt, pt, ptlen, err);
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(buf, sizeof(buf));
+   zeromem(mac, sizeof(mac));
+#endif
+LBL_ERR:
+   if (skey != uskey) {
+      zeromem(skey, sizeof(*skey));
+      XFREE(skey);
+   }
+   return err;
+}
+#endif /* LTC_CCM_MODE */
+
 /**
   Performs a self-test of the AES block cipher
   @return CRYPT_OK if functional, CRYPT_NOP if self-test has been disabled
@@ -372,3 +935,4 @@ int aesni_keysize(int *keysize)
 
 #endif
 
+#pragma clang diagnostic pop
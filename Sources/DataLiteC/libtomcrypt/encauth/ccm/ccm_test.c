@@ -267,6 +267,53 @@ int ccm_test(void)
       }
    }
 
+   /* ccm_memory() (which may use an accelerator) against the incremental API on several
+    * blocks of header and payload with a partial block at the end */
+   {
+      unsigned char key[16], nonce[13], hdr[40], pt[100], ct[100], ct2[100];
+
+      for (x = 0; x < sizeof(pt); x++) {
+         pt[x] = (unsigned char)x;
+         if (x < sizeof(hdr)) hdr[x] = (unsigned char)(x * 3);
+         if (x < sizeof(key)) key[x] = (unsigned char)(x * 5);
+         if (x < sizeof(nonce)) nonce[x] = (unsigned char)(x * 7);
+      }
+      taglen = 16;
+      if ((err = ccm_memory(idx, key, sizeof(key), NULL, nonce, sizeof(nonce), hdr, sizeof(hdr),
+                            pt, sizeof(pt), ct, tag, &taglen, CCM_ENCRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if ((err = ccm_init(&ccm, idx, key, sizeof(key), sizeof(pt), 16, sizeof(hdr))) != CRYPT_OK) {
+         return err;
+      }
+      if ((err = ccm_add_nonce(&ccm, nonce, sizeof(nonce))) != CRYPT_OK) {
+         return err;
+      }
+      if ((err = ccm_add_aad(&ccm, hdr, sizeof(hdr))) != CRYPT_OK) {
+         return err;
+      }
+      if ((err = ccm_process(&ccm, pt, sizeof(pt), ct2, CCM_ENCRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      taglen = 16;
+      if ((err = ccm_done(&ccm, tag2, &taglen)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(ct, sizeof(ct), ct2, sizeof(ct2), "CCM memory vs. process data", 0) ||
+          compare_testvector(tag, 16, tag2, 16, "CCM memory vs. process tag", 0)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+
+      taglen = 16;
+      if ((err = ccm_memory(idx, key, sizeof(key), NULL, nonce, sizeof(nonce), hdr, sizeof(hdr),
+                            ct2, sizeof(ct), ct, tag, &taglen, CCM_DECRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(ct2, sizeof(ct2), pt, sizeof(pt), "CCM memory decrypt", 0)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
    return CRYPT_OK;
 #endif
 }
@@ -0,0 +1,403 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file blake2_simd.c
+  AVX2 and SSSE3 BLAKE2 kernels for x86_64, selected at run-time.
+
+  The single stream kernels keep the four rows of the working state in one
+  register each and rotate the rows between the column and the diagonal step,
+  the leaf kernels of BLAKE2bp and BLAKE2sp run one leaf per lane of a register.
+*/
+
+#if defined(LTC_BLAKE2_SIMD)
+
+#include <immintrin.h>
+
+static const ulong64 blake2b_IV[8] =
+{
+  CONST64(0x6a09e667f3bcc908), CONST64(0xbb67ae8584caa73b),
+  CONST64(0x3c6ef372fe94f82b), CONST64(0xa54ff53a5f1d36f1),
+  CONST64(0x510e527fade682d1), CONST64(0x9b05688c2b3e6c1f),
+  CONST64(0x1f83d9abfb41bd6b), CONST64(0x5be0cd19137e2179)
+};
+
+static const ulong32 blake2s_IV[8] =
+{
+   0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+   0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+/* the first ten rows are BLAKE2s, BLAKE2b repeats the first two */
+static const unsigned char blake2_sigma[12][16] =
+{
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 } ,
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 } ,
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 } ,
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 } ,
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 } ,
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 } ,
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 } ,
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 } ,
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 } ,
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+/* 0 = none, 1 = SSSE3, 2 = AVX2 */
+static int s_blake2_simd_level(void)
+{
+   unsigned int f = ltc_cpu_features();
+
+   if ((f & LTC_CPU_SSSE3) == 0) {
+      return 0;
+   }
+   return (f & LTC_CPU_AVX2) ? 2 : 1;
+}
+
+/* rotations of the 64 bit lanes by 32, 24, 16 and 63 bits */
+#define ROR64_32(x)  _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define ROR64_24(x)  _mm256_shuffle_epi8((x), r24)
+#define ROR64_16(x)  _mm256_shuffle_epi8((x), r16)
+#define ROR64_63(x)  _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define G64(a, b, c, d, m0, m1)                                                                                        \
+   do {                                                                                                                \
+      a = _mm256_add_epi64(_mm256_add_epi64(a, b), m0);                                                                \
+      d = ROR64_32(_mm256_xor_si256(d, a));                                                                            \
+      c = _mm256_add_epi64(c, d);                                                                                      \
+      b = ROR64_24(_mm256_xor_si256(b, c));                                                                            \
+      a = _mm256_add_epi64(_mm256_add_epi64(a, b), m1);                                                                \
+      d = ROR64_16(_mm256_xor_si256(d, a));                                                                            \
+      c = _mm256_add_epi64(c, d);                                                                                      \
+      b = ROR64_63(_mm256_xor_si256(b, c));                                                                            \
+   } while (0)
+
+/**
+   BLAKE2b compression of one block, the rows of the state in one ymm register each
+   @param h     The chaining value, ulong64[8]
+   @param buf   The block of 128 octets
+   @param t     The counter, ulong64[2]
+   @param f     The finalization flags, ulong64[2]
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_blake2b_compress_avx2(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
+{
+   const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+   __m256i a, b, c, d, h0, h1, m0, m1;
+   ulong64 m[16];
+   const unsigned char *s;
+   int r, i;
+
+   for (i = 0; i < 16; ++i) {
+      LOAD64L(m[i], buf + i * 8);
+   }
+
+   a = h0 = _mm256_loadu_si256((const __m256i *)(h + 0));
+   b = h1 = _mm256_loadu_si256((const __m256i *)(h + 4));
+   c = _mm256_loadu_si256((const __m256i *)(blake2b_IV + 0));
+   d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(blake2b_IV + 4)),
+                        _mm256_set_epi64x((long long)f[1], (long long)f[0], (long long)t[1], (long long)t[0]));
+
+   for (r = 0; r < 12; ++r) {
+      s = blake2_sigma[r];
+      /* columns */
+      m0 = _mm256_set_epi64x((long long)m[s[6]], (long long)m[s[4]], (long long)m[s[2]], (long long)m[s[0]]);
+      m1 = _mm256_set_epi64x((long long)m[s[7]], (long long)m[s[5]], (long long)m[s[3]], (long long)m[s[1]]);
+      G64(a, b, c, d, m0, m1);
+      /* diagonals, rotate rows 1, 2 and 3 by one, two and three lanes */
+      b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+      c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+      m0 = _mm256_set_epi64x((long long)m[s[14]], (long long)m[s[12]], (long long)m[s[10]], (long long)m[s[8]]);
+      m1 = _mm256_set_epi64x((long long)m[s[15]], (long long)m[s[13]], (long long)m[s[11]], (long long)m[s[9]]);
+      G64(a, b, c, d, m0, m1);
+      b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+      c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+   }
+
+   _mm256_storeu_si256((__m256i *)(h + 0), _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+   _mm256_storeu_si256((__m256i *)(h + 4), _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+#ifdef LTC_CLEAN_STACK
+   zeromem(m, sizeof(m));
+#endif
+}
+
+/**
+   Four BLAKE2bp leaves compress one block each, leaf j in lane j of the registers
+   @param h     The chaining values, word i of leaf j is h[i][j]
+   @param in    The four blocks, one after the other
+   @param t     The counters of the leaves
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_blake2bp_compress4_avx2(ulong64 h[8][4], const unsigned char *in, const ulong64 *t)
+{
+   const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+   __m256i v[16], m[16], x0, x1, x2, x3, y0, y1, y2, y3;
+   const unsigned char *s;
+   int r, i;
+
+   /* transpose words i..i+3 of the four blocks */
+   for (i = 0; i < 16; i += 4) {
+      x0 = _mm256_loadu_si256((const __m256i *)(in + 0 * 128 + i * 8));
+      x1 = _mm256_loadu_si256((const __m256i *)(in + 1 * 128 + i * 8));
+      x2 = _mm256_loadu_si256((const __m256i *)(in + 2 * 128 + i * 8));
+      x3 = _mm256_loadu_si256((const __m256i *)(in + 3 * 128 + i * 8));
+      y0 = _mm256_unpacklo_epi64(x0, x1);
+      y1 = _mm256_unpackhi_epi64(x0, x1);
+      y2 = _mm256_unpacklo_epi64(x2, x3);
+      y3 = _mm256_unpackhi_epi64(x2, x3);
+      m[i + 0] = _mm256_permute2x128_si256(y0, y2, 0x20);
+      m[i + 1] = _mm256_permute2x128_si256(y1, y3, 0x20);
+      m[i + 2] = _mm256_permute2x128_si256(y0, y2, 0x31);
+      m[i + 3] = _mm256_permute2x128_si256(y1, y3, 0x31);
+   }
+
+   for (i = 0; i < 8; ++i) {
+      v[i] = _mm256_loadu_si256((const __m256i *)h[i]);
+      v[i + 8] = _mm256_set1_epi64x((long long)blake2b_IV[i]);
+   }
+   v[12] = _mm256_xor_si256(v[12], _mm256_loadu_si256((const __m256i *)t));
+
+   for (r = 0; r < 12; ++r) {
+      s = blake2_sigma[r];
+      G64(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+      G64(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+      G64(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+      G64(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+      G64(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+      G64(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      G64(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+      G64(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+   }
+
+   for (i = 0; i < 8; ++i) {
+      x0 = _mm256_loadu_si256((const __m256i *)h[i]);
+      _mm256_storeu_si256((__m256i *)h[i], _mm256_xor_si256(x0, _mm256_xor_si256(v[i], v[i + 8])));
+   }
+}
+
+#undef G64
+
+/* rotations of the 32 bit lanes by 16, 12, 8 and 7 bits */
+#define ROR32_16(x)  _mm_shuffle_epi8((x), r16)
+#define ROR32_12(x)  _mm_xor_si128(_mm_srli_epi32((x), 12), _mm_slli_epi32((x), 20))
+#define ROR32_8(x)   _mm_shuffle_epi8((x), r8)
+#define ROR32_7(x)   _mm_xor_si128(_mm_srli_epi32((x), 7), _mm_slli_epi32((x), 25))
+
+#define G32(a, b, c, d, m0, m1)                                                                                        \
+   do {                                                                                                                \
+      a = _mm_add_epi32(_mm_add_epi32(a, b), m0);                                                                      \
+      d = ROR32_16(_mm_xor_si128(d, a));                                                                               \
+      c = _mm_add_epi32(c, d);                                                                                         \
+      b = ROR32_12(_mm_xor_si128(b, c));                                                                               \
+      a = _mm_add_epi32(_mm_add_epi32(a, b), m1);                                                                      \
+      d = ROR32_8(_mm_xor_si128(d, a));                                                                                \
+      c = _mm_add_epi32(c, d);                                                                                         \
+      b = ROR32_7(_mm_xor_si128(b, c));                                                                                \
+   } while (0)
+
+/**
+   BLAKE2s compression of one block, the rows of the state in one xmm register each
+   @param h     The chaining value, ulong32[8]
+   @param buf   The block of 64 octets
+   @param t     The counter, ulong32[2]
+   @param f     The finalization flags, ulong32[2]
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_blake2s_compress_ssse3(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
+{
+   const __m128i r16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+   const __m128i r8  = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+   __m128i a, b, c, d, h0, h1, m0, m1;
+   ulong32 m[16];
+   const unsigned char *s;
+   int r, i;
+
+   for (i = 0; i < 16; ++i) {
+      LOAD32L(m[i], buf + i * 4);
+   }
+
+   a = h0 = _mm_loadu_si128((const __m128i *)(h + 0));
+   b = h1 = _mm_loadu_si128((const __m128i *)(h + 4));
+   c = _mm_loadu_si128((const __m128i *)(blake2s_IV + 0));
+   d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(blake2s_IV + 4)),
+                     _mm_set_epi32((int)f[1], (int)f[0], (int)t[1], (int)t[0]));
+
+   for (r = 0; r < 10; ++r) {
+      s = blake2_sigma[r];
+      /* columns */
+      m0 = _mm_set_epi32((int)m[s[6]], (int)m[s[4]], (int)m[s[2]], (int)m[s[0]]);
+      m1 = _mm_set_epi32((int)m[s[7]], (int)m[s[5]], (int)m[s[3]], (int)m[s[1]]);
+      G32(a, b, c, d, m0, m1);
+      /* diagonals, rotate rows 1, 2 and 3 by one, two and three lanes */
+      b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+      c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+      m0 = _mm_set_epi32((int)m[s[14]], (int)m[s[12]], (int)m[s[10]], (int)m[s[8]]);
+      m1 = _mm_set_epi32((int)m[s[15]], (int)m[s[13]], (int)m[s[11]], (int)m[s[9]]);
+      G32(a, b, c, d, m0, m1);
+      b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+      c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+   }
+
+   _mm_storeu_si128((__m128i *)(h + 0), _mm_xor_si128(h0, _mm_xor_si128(a, c)));
+   _mm_storeu_si128((__m128i *)(h + 4), _mm_xor_si128(h1, _mm_xor_si128(b, d)));
+#ifdef LTC_CLEAN_STACK
+   zeromem(m, sizeof(m));
+#endif
+}
+
+#undef G32
+
+/* the same rotations on ymm registers */
+#define ROR32X8_16(x)  _mm256_shuffle_epi8((x), r16)
+#define ROR32X8_12(x)  _mm256_xor_si256(_mm256_srli_epi32((x), 12), _mm256_slli_epi32((x), 20))
+#define ROR32X8_8(x)   _mm256_shuffle_epi8((x), r8)
+#define ROR32X8_7(x)   _mm256_xor_si256(_mm256_srli_epi32((x), 7), _mm256_slli_epi32((x), 25))
+
+#define G32X8(a, b, c, d, m0, m1)                                                                                      \
+   do {                                                                                                                \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), m0);                                                                \
+      d = ROR32X8_16(_mm256_xor_si256(d, a));                                                                          \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = ROR32X8_12(_mm256_xor_si256(b, c));                                                                          \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), m1);                                                                \
+      d = ROR32X8_8(_mm256_xor_si256(d, a));                                                                           \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = ROR32X8_7(_mm256_xor_si256(b, c));                                                                           \
+   } while (0)
+
+/**
+   Eight BLAKE2sp leaves compress one block each, leaf j in lane j of the registers
+   @param h     The chaining values, word i of leaf j is h[i][j]
+   @param in    The eight blocks, one after the other
+   @param t     The counters of the leaves
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_blake2sp_compress8_avx2(ulong32 h[8][8], const unsigned char *in, const ulong64 *t)
+{
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+   const __m256i r8  = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                        1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+   __m256i v[16], m[16], x[8], y[8], z[8], t0, t1;
+   const unsigned char *s;
+   int r, i, j;
+
+   /* transpose words i..i+7 of the eight blocks */
+   for (i = 0; i < 16; i += 8) {
+      for (j = 0; j < 8; ++j) {
+         x[j] = _mm256_loadu_si256((const __m256i *)(in + j * 64 + i * 4));
+      }
+      for (j = 0; j < 8; j += 2) {
+         y[j + 0] = _mm256_unpacklo_epi32(x[j], x[j + 1]);
+         y[j + 1] = _mm256_unpackhi_epi32(x[j], x[j + 1]);
+      }
+      for (j = 0; j < 8; j += 4) {
+         z[j + 0] = _mm256_unpacklo_epi64(y[j + 0], y[j + 2]);
+         z[j + 1] = _mm256_unpackhi_epi64(y[j + 0], y[j + 2]);
+         z[j + 2] = _mm256_unpacklo_epi64(y[j + 1], y[j + 3]);
+         z[j + 3] = _mm256_unpackhi_epi64(y[j + 1], y[j + 3]);
+      }
+      for (j = 0; j < 4; ++j) {
+         m[i + j + 0] = _mm256_permute2x128_si256(z[j], z[j + 4], 0x20);
+         m[i + j + 4] = _mm256_permute2x128_si256(z[j], z[j + 4], 0x31);
+      }
+   }
+
+   for (i = 0; i < 8; ++i) {
+      v[i] = _mm256_loadu_si256((const __m256i *)h[i]);
+      v[i + 8] = _mm256_set1_epi32((int)blake2s_IV[i]);
+   }
+   /* split the 64 bit counters into their low and high words, t0 = lo[0..3] hi[0..3] and t1 = lo[4..7] hi[4..7] */
+   t0 = _mm256_shuffle_epi32(_mm256_loadu_si256((const __m256i *)(t + 0)), _MM_SHUFFLE(3, 1, 2, 0));
+   t1 = _mm256_shuffle_epi32(_mm256_loadu_si256((const __m256i *)(t + 4)), _MM_SHUFFLE(3, 1, 2, 0));
+   t0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(3, 1, 2, 0));
+   t1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(3, 1, 2, 0));
+   v[12] = _mm256_xor_si256(v[12], _mm256_permute2x128_si256(t0, t1, 0x20));
+   v[13] = _mm256_xor_si256(v[13], _mm256_permute2x128_si256(t0, t1, 0x31));
+
+   for (r = 0; r < 10; ++r) {
+      s = blake2_sigma[r];
+      G32X8(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+      G32X8(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+      G32X8(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+      G32X8(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+      G32X8(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+      G32X8(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      G32X8(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+      G32X8(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+   }
+
+   for (i = 0; i < 8; ++i) {
+      x[0] = _mm256_loadu_si256((const __m256i *)h[i]);
+      _mm256_storeu_si256((__m256i *)h[i], _mm256_xor_si256(x[0], _mm256_xor_si256(v[i], v[i + 8])));
+   }
+}
+
+#undef G32X8
+
+/**
+   BLAKE2b compression of one block
+   @return CRYPT_OK if it has been done, CRYPT_NOP if the CPU lacks AVX2
+*/
+int blake2b_simd_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
+{
+   if (s_blake2_simd_level() < 2) {
+      return CRYPT_NOP;
+   }
+   s_blake2b_compress_avx2(h, buf, t, f);
+   return CRYPT_OK;
+}
+
+/**
+   BLAKE2s compression of one block
+   @return CRYPT_OK if it has been done, CRYPT_NOP if the CPU lacks SSSE3
+*/
+int blake2s_simd_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
+{
+   if (s_blake2_simd_level() < 1) {
+      return CRYPT_NOP;
+   }
+   s_blake2s_compress_ssse3(h, buf, t, f);
+   return CRYPT_OK;
+}
+
+/**
+   Compress one block of each of the four BLAKE2bp leaves, none of them the last one
+   @return CRYPT_OK if it has been done, CRYPT_NOP if the CPU lacks AVX2
+*/
+int blake2bp_simd_compress4(ulong64 h[8][4], const unsigned char *in, const ulong64 *t)
+{
+   if (s_blake2_simd_level() < 2) {
+      return CRYPT_NOP;
+   }
+   s_blake2bp_compress4_avx2(h, in, t);
+   return CRYPT_OK;
+}
+
+/**
+   Compress one block of each of the eight BLAKE2sp leaves, none of them the last one
+   @return CRYPT_OK if it has been done, CRYPT_NOP if the CPU lacks AVX2
+*/
+int blake2sp_simd_compress8(ulong32 h[8][8], const unsigned char *in, const ulong64 *t)
+{
+   if (s_blake2_simd_level() < 2) {
+      return CRYPT_NOP;
+   }
+   s_blake2sp_compress8_avx2(h, in, t);
+   return CRYPT_OK;
+}
+
+#endif /* LTC_BLAKE2_SIMD */
@@ -75,6 +75,7 @@ const struct ltc_hash_descriptor blake2b_160_desc =
     &blake2b_process,
     &blake2b_done,
     &blake2b_160_test,
+    NULL,
     NULL
 };
 
@@ -90,6 +91,7 @@ const struct ltc_hash_descriptor blake2b_256_desc =
     &blake2b_process,
     &blake2b_done,
     &blake2b_256_test,
+    NULL,
     NULL
 };
 
@@ -105,6 +107,7 @@ const struct ltc_hash_descriptor blake2b_384_desc =
     &blake2b_process,
     &blake2b_done,
     &blake2b_384_test,
+    NULL,
     NULL
 };
 
@@ -120,6 +123,7 @@ const struct ltc_hash_descriptor blake2b_512_desc =
     &blake2b_process,
     &blake2b_done,
     &blake2b_512_test,
+    NULL,
     NULL
 };
 
@@ -177,7 +181,7 @@ static void s_blake2b_init0(hash_state *md)
 }
 
 /* init xors IV with input parameter block */
-static int s_blake2b_init_param(hash_state *md, const unsigned char *P)
+int blake2b_init_param(hash_state *md, const unsigned char *P)
 {
    unsigned long i;
 
@@ -228,7 +232,7 @@ int blake2b_init(hash_state *md, unsigned long outlen, const unsigned char *key,
    P[BLAKE2B_O_FANOUT] = 1;
    P[BLAKE2B_O_DEPTH] = 1;
 
-   err = s_blake2b_init_param(md, P);
+   err = blake2b_init_param(md, P);
    if (err != CRYPT_OK) return err;
 
    if (key) {
@@ -299,9 +303,9 @@ int blake2b_512_init(hash_state *md) { return blake2b_init(md, 64, NULL, 0); }
    } while (0)
 
 #ifdef LTC_CLEAN_STACK
-static int ss_blake2b_compress(hash_state *md, const unsigned char *buf)
+static int ss_blake2b_compress_block(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 #else
-static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
+static int s_blake2b_compress_block(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 #endif
 {
    ulong64 m[16];
@@ -313,17 +317,17 @@ static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
    }
 
    for (i = 0; i < 8; ++i) {
-      v[i] = md->blake2b.h[i];
+      v[i] = h[i];
    }
 
    v[8] = blake2b_IV[0];
    v[9] = blake2b_IV[1];
    v[10] = blake2b_IV[2];
    v[11] = blake2b_IV[3];
-   v[12] = blake2b_IV[4] ^ md->blake2b.t[0];
-   v[13] = blake2b_IV[5] ^ md->blake2b.t[1];
-   v[14] = blake2b_IV[6] ^ md->blake2b.f[0];
-   v[15] = blake2b_IV[7] ^ md->blake2b.f[1];
+   v[12] = blake2b_IV[4] ^ t[0];
+   v[13] = blake2b_IV[5] ^ t[1];
+   v[14] = blake2b_IV[6] ^ f[0];
+   v[15] = blake2b_IV[7] ^ f[1];
 
    ROUND(0);
    ROUND(1);
@@ -339,7 +343,7 @@ static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
    ROUND(11);
 
    for (i = 0; i < 8; ++i) {
-      md->blake2b.h[i] = md->blake2b.h[i] ^ v[i] ^ v[i + 8];
+      h[i] = h[i] ^ v[i] ^ v[i + 8];
    }
    return CRYPT_OK;
 }
@@ -348,15 +352,38 @@ static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
 #undef ROUND
 
 #ifdef LTC_CLEAN_STACK
-static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
+static int s_blake2b_compress_block(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 {
    int err;
-   err = ss_blake2b_compress(md, buf);
+   err = ss_blake2b_compress_block(h, buf, t, f);
    burn_stack(sizeof(ulong64) * 32 + sizeof(unsigned long));
    return err;
 }
 #endif
 
+/**
+   Run the compression function on one block
+   @param h     The chaining value, ulong64[8]
+   @param buf   The block of 128 octets
+   @param t     The counter, ulong64[2]
+   @param f     The finalization flags, ulong64[2]
+   @return CRYPT_OK if successful
+*/
+int blake2b_compress_block(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
+{
+#if defined(LTC_BLAKE2_SIMD)
+   if (blake2b_simd_compress(h, buf, t, f) == CRYPT_OK) {
+      return CRYPT_OK;
+   }
+#endif
+   return s_blake2b_compress_block(h, buf, t, f);
+}
+
+static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
+{
+   return blake2b_compress_block(md->blake2b.h, buf, md->blake2b.t, md->blake2b.f);
+}
+
 /**
    Process a block of memory through the hash
    @param md     The hash state
@@ -0,0 +1,301 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file blake2bp.c
+   BLAKE2bp, four BLAKE2b leaves and a root as specified in section 2.10 of
+   https://blake2.net/blake2.pdf
+
+   Block i of the message goes to leaf i % 4. The leaves advance in lock-step
+   over stripes of four blocks, which lets the AVX2 kernel hash one leaf per
+   lane of its registers. A leaf may only compress a block when it is known
+   that more data for this leaf follows, so the last stripe stays in the
+   buffer until the next one starts to arrive.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2BP
+
+#define BLAKE2BP_LEAVES   4
+#define BLAKE2BP_BLOCK    128
+#define BLAKE2BP_STRIPE   (BLAKE2BP_LEAVES * BLAKE2BP_BLOCK)
+#define BLAKE2BP_OUTBYTES 64
+
+const struct ltc_hash_descriptor blake2bp_512_desc =
+{
+    "blake2bp-512",
+    35,
+    64,
+    128,
+    { 0 },
+    0,
+    &blake2bp_512_init,
+    &blake2bp_process,
+    &blake2bp_done,
+    &blake2bp_512_test,
+    NULL,
+    NULL
+};
+
+/* the parameter block of a leaf or of the root */
+static void s_blake2bp_param(unsigned char *P, unsigned long node_offset, unsigned char node_depth)
+{
+   XMEMSET(P, 0, 64);
+   P[0] = BLAKE2BP_OUTBYTES;       /* digest length */
+   P[2] = BLAKE2BP_LEAVES;         /* fanout */
+   P[3] = 2;                       /* depth */
+   STORE32L(node_offset, P + 8);
+   P[16] = node_depth;
+   P[17] = BLAKE2BP_OUTBYTES;      /* inner length */
+}
+
+/* compress one block of a single leaf */
+static void s_blake2bp_compress_leaf(struct blake2bp_state *S, int leaf, const unsigned char *block,
+                                     unsigned long len, int last)
+{
+   ulong64 h[8], t[2], f[2];
+   int i;
+
+   for (i = 0; i < 8; ++i) {
+      h[i] = S->h[i][leaf];
+   }
+   S->t[leaf] += len;
+   t[0] = S->t[leaf];
+   t[1] = 0;
+   f[0] = last ? CONST64(0xffffffffffffffff) : 0;
+   f[1] = (last && leaf == BLAKE2BP_LEAVES - 1) ? CONST64(0xffffffffffffffff) : 0;
+   blake2b_compress_block(h, block, t, f);
+   for (i = 0; i < 8; ++i) {
+      S->h[i][leaf] = h[i];
+   }
+}
+
+/* compress a stripe, none of its blocks is the last one of its leaf */
+static void s_blake2bp_compress_stripe(struct blake2bp_state *S, const unsigned char *in)
+{
+   int leaf;
+
+#if defined(LTC_BLAKE2_SIMD)
+   ulong64 t[BLAKE2BP_LEAVES];
+
+   for (leaf = 0; leaf < BLAKE2BP_LEAVES; ++leaf) {
+      t[leaf] = S->t[leaf] + BLAKE2BP_BLOCK;
+   }
+   if (blake2bp_simd_compress4(S->h, in, t) == CRYPT_OK) {
+      XMEMCPY(S->t, t, sizeof(t));
+      return;
+   }
+#endif
+   for (leaf = 0; leaf < BLAKE2BP_LEAVES; ++leaf) {
+      s_blake2bp_compress_leaf(S, leaf, in + leaf * BLAKE2BP_BLOCK, BLAKE2BP_BLOCK, 0);
+   }
+}
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return CRYPT_OK if successful
+*/
+int blake2bp_512_init(hash_state *md)
+{
+   unsigned char P[64];
+   hash_state leaf;
+   int i, j, err;
+
+   LTC_ARGCHK(md != NULL);
+
+   XMEMSET(&md->blake2bp, 0, sizeof(md->blake2bp));
+   for (j = 0; j < BLAKE2BP_LEAVES; ++j) {
+      s_blake2bp_param(P, (unsigned long)j, 0);
+      if ((err = blake2b_init_param(&leaf, P)) != CRYPT_OK) {
+         return err;
+      }
+      for (i = 0; i < 8; ++i) {
+         md->blake2bp.h[i][j] = leaf.blake2b.h[i];
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Process a block of memory through the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int blake2bp_process(hash_state *md, const unsigned char *in, unsigned long inlen)
+{
+   struct blake2bp_state *S;
+   unsigned long n;
+   int leaf;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(in != NULL);
+
+   S = &md->blake2bp;
+   if (S->curlen >= sizeof(S->buf)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   while (inlen > 0) {
+      if (S->curlen == 0) {
+         if (S->pending && inlen > BLAKE2BP_STRIPE - BLAKE2BP_BLOCK) {
+            /* every leaf gets more data, so none of the buffered blocks is a last one */
+            s_blake2bp_compress_stripe(S, S->buf);
+            S->pending = 0;
+         }
+         if (!S->pending) {
+            while (inlen > 2 * BLAKE2BP_STRIPE - BLAKE2BP_BLOCK) {
+               s_blake2bp_compress_stripe(S, in);
+               in    += BLAKE2BP_STRIPE;
+               inlen -= BLAKE2BP_STRIPE;
+            }
+         }
+      }
+      leaf = (int)(S->curlen / BLAKE2BP_BLOCK);
+      if (S->pending && S->curlen % BLAKE2BP_BLOCK == 0) {
+         /* the leaf gets more data, so its buffered block isn't the last one */
+         s_blake2bp_compress_leaf(S, leaf, S->buf + S->curlen, BLAKE2BP_BLOCK, 0);
+      }
+      n = MIN(inlen, BLAKE2BP_BLOCK - S->curlen % BLAKE2BP_BLOCK);
+      XMEMCPY(S->buf + S->curlen, in, n);
+      S->curlen += n;
+      in        += n;
+      inlen     -= n;
+      if (S->curlen == BLAKE2BP_STRIPE) {
+         S->curlen  = 0;
+         S->pending = 1;
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (64 bytes)
+   @return CRYPT_OK if successful
+*/
+int blake2bp_done(hash_state *md, unsigned char *out)
+{
+   unsigned char P[64], hash[BLAKE2BP_LEAVES * BLAKE2BP_OUTBYTES], *block;
+   struct blake2bp_state *S;
+   unsigned long len;
+   hash_state root;
+   int i, leaf, err;
+
+   LTC_ARGCHK(md  != NULL);
+   LTC_ARGCHK(out != NULL);
+
+   S = &md->blake2bp;
+   if (S->curlen >= sizeof(S->buf)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the last block of each leaf is either in the current stripe, the previous one or empty */
+   for (leaf = 0; leaf < BLAKE2BP_LEAVES; ++leaf) {
+      block = S->buf + leaf * BLAKE2BP_BLOCK;
+      if (S->curlen > (unsigned long)leaf * BLAKE2BP_BLOCK) {
+         len = MIN(S->curlen - leaf * BLAKE2BP_BLOCK, BLAKE2BP_BLOCK);
+      } else {
+         len = S->pending ? BLAKE2BP_BLOCK : 0;
+      }
+      XMEMSET(block + len, 0, BLAKE2BP_BLOCK - len);
+      s_blake2bp_compress_leaf(S, leaf, block, len, 1);
+      for (i = 0; i < 8; ++i) {
+         STORE64L(S->h[i][leaf], hash + leaf * BLAKE2BP_OUTBYTES + i * 8);
+      }
+   }
+
+   s_blake2bp_param(P, 0, 1);
+   if ((err = blake2b_init_param(&root, P)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   root.blake2b.last_node = 1;
+   if ((err = blake2b_process(&root, hash, sizeof(hash))) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   err = blake2b_done(&root, out);
+
+LBL_ERR:
+   zeromem(md, sizeof(hash_state));
+#ifdef LTC_CLEAN_STACK
+   zeromem(hash, sizeof(hash));
+   zeromem(&root, sizeof(root));
+#endif
+   return err;
+}
+
+/**
+  Self-test the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if self-tests have been disabled
+*/
+int blake2bp_512_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      const char *msg;
+      unsigned long len;
+      unsigned char hash[64];
+   } tests[] = {
+      { "", 0,
+        { 0xb5, 0xef, 0x81, 0x1a, 0x80, 0x38, 0xf7, 0x0b,
+          0x62, 0x8f, 0xa8, 0xb2, 0x94, 0xda, 0xae, 0x74,
+          0x92, 0xb1, 0xeb, 0xe3, 0x43, 0xa8, 0x0e, 0xaa,
+          0xbb, 0xf1, 0xf6, 0xae, 0x66, 0x4d, 0xd6, 0x7b,
+          0x9d, 0x90, 0xb0, 0x12, 0x07, 0x91, 0xea, 0xb8,
+          0x1d, 0xc9, 0x69, 0x85, 0xf2, 0x88, 0x49, 0xf6,
+          0xa3, 0x05, 0x18, 0x6a, 0x85, 0x50, 0x1b, 0x40,
+          0x51, 0x14, 0xbf, 0xa6, 0x78, 0xdf, 0x93, 0x80 } },
+      { "abc", 3,
+        { 0xb9, 0x1a, 0x6b, 0x66, 0xae, 0x87, 0x52, 0x6c,
+          0x40, 0x0b, 0x0a, 0x8b, 0x53, 0x77, 0x4d, 0xc6,
+          0x52, 0x84, 0xad, 0x8f, 0x65, 0x75, 0xf8, 0x14,
+          0x8f, 0xf9, 0x3d, 0xff, 0x94, 0x3a, 0x6e, 0xcd,
+          0x83, 0x62, 0x13, 0x0f, 0x22, 0xd6, 0xda, 0xe6,
+          0x33, 0xaa, 0x0f, 0x91, 0xdf, 0x4a, 0xc8, 0x9a,
+          0xaf, 0xf3, 0x1d, 0x0f, 0x1b, 0x92, 0x3c, 0x89,
+          0x8e, 0x82, 0x02, 0x5d, 0xed, 0xbd, 0xad, 0x6e } },
+      /* 0, 1, 2, ... 255, 0, 1, ... */
+      { NULL, 2000,
+        { 0x00, 0xf7, 0x22, 0x5f, 0xfd, 0x39, 0x73, 0x8b,
+          0x39, 0xc6, 0x4b, 0x1f, 0x9b, 0xc4, 0xea, 0x3a,
+          0x8b, 0x68, 0xd3, 0x49, 0x87, 0x02, 0x63, 0x64,
+          0x53, 0x2d, 0xae, 0x32, 0xea, 0x07, 0x42, 0x1e,
+          0x03, 0x56, 0x6e, 0xb9, 0x36, 0xff, 0x4f, 0x7e,
+          0x63, 0xb7, 0xc7, 0x83, 0xc2, 0x0e, 0xdb, 0x64,
+          0x2c, 0x82, 0xa8, 0xa3, 0x55, 0x49, 0x89, 0xdd,
+          0x63, 0x57, 0x25, 0x6e, 0x61, 0xa0, 0xb1, 0x93 } },
+   };
+
+   unsigned char buf[2000], tmp[64];
+   const unsigned char *in;
+   unsigned long i, n, chunk;
+   hash_state md;
+
+   for (i = 0; i < sizeof(buf); i++) {
+      buf[i] = (unsigned char)i;
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      in = tests[i].msg != NULL ? (const unsigned char *)tests[i].msg : buf;
+      /* in pieces of varying length, so that every path through the buffer is taken */
+      for (chunk = 1; chunk <= 1031; chunk += 205) {
+         blake2bp_512_init(&md);
+         for (n = 0; n < tests[i].len; n += MIN(chunk, tests[i].len - n)) {
+            blake2bp_process(&md, in + n, MIN(chunk, tests[i].len - n));
+         }
+         blake2bp_done(&md, tmp);
+         if (compare_testvector(tmp, sizeof(tmp), tests[i].hash, sizeof(tests[i].hash), "BLAKE2BP_512", (int)i)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif /* LTC_BLAKE2BP */
@@ -77,6 +77,7 @@ const struct ltc_hash_descriptor blake2s_128_desc =
     &blake2s_process,
     &blake2s_done,
     &blake2s_128_test,
+    NULL,
     NULL
 };
 
@@ -92,6 +93,7 @@ const struct ltc_hash_descriptor blake2s_160_desc =
     &blake2s_process,
     &blake2s_done,
     &blake2s_160_test,
+    NULL,
     NULL
 };
 
@@ -107,6 +109,7 @@ const struct ltc_hash_descriptor blake2s_224_desc =
     &blake2s_process,
     &blake2s_done,
     &blake2s_224_test,
+    NULL,
     NULL
 };
 
@@ -122,6 +125,7 @@ const struct ltc_hash_descriptor blake2s_256_desc =
     &blake2s_process,
     &blake2s_done,
     &blake2s_256_test,
+    NULL,
     NULL
 };
 
@@ -175,7 +179,7 @@ static int s_blake2s_init0(hash_state *md)
 }
 
 /* init2 xors IV with input parameter block */
-static int s_blake2s_init_param(hash_state *md, const unsigned char *P)
+int blake2s_init_param(hash_state *md, const unsigned char *P)
 {
    unsigned long i;
 
@@ -226,7 +230,7 @@ int blake2s_init(hash_state *md, unsigned long outlen, const unsigned char *key,
    P[BLAKE2S_O_FANOUT] = 1;
    P[BLAKE2S_O_DEPTH] = 1;
 
-   err = s_blake2s_init_param(md, P);
+   err = blake2s_init_param(md, P);
    if (err != CRYPT_OK) return err;
 
    if (key) {
@@ -295,9 +299,9 @@ int blake2s_256_init(hash_state *md) { return blake2s_init(md, 32, NULL, 0); }
    } while (0)
 
 #ifdef LTC_CLEAN_STACK
-static int ss_blake2s_compress(hash_state *md, const unsigned char *buf)
+static int ss_blake2s_compress_block(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 #else
-static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
+static int s_blake2s_compress_block(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 #endif
 {
    unsigned long i;
@@ -309,17 +313,17 @@ static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
    }
 
    for (i = 0; i < 8; ++i) {
-      v[i] = md->blake2s.h[i];
+      v[i] = h[i];
    }
 
    v[8] = blake2s_IV[0];
    v[9] = blake2s_IV[1];
    v[10] = blake2s_IV[2];
    v[11] = blake2s_IV[3];
-   v[12] = md->blake2s.t[0] ^ blake2s_IV[4];
-   v[13] = md->blake2s.t[1] ^ blake2s_IV[5];
-   v[14] = md->blake2s.f[0] ^ blake2s_IV[6];
-   v[15] = md->blake2s.f[1] ^ blake2s_IV[7];
+   v[12] = t[0] ^ blake2s_IV[4];
+   v[13] = t[1] ^ blake2s_IV[5];
+   v[14] = f[0] ^ blake2s_IV[6];
+   v[15] = f[1] ^ blake2s_IV[7];
 
    ROUND(0);
    ROUND(1);
@@ -333,7 +337,7 @@ static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
    ROUND(9);
 
    for (i = 0; i < 8; ++i) {
-      md->blake2s.h[i] = md->blake2s.h[i] ^ v[i] ^ v[i + 8];
+      h[i] = h[i] ^ v[i] ^ v[i + 8];
    }
    return CRYPT_OK;
 }
@@ -341,15 +345,38 @@ static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
 #undef ROUND
 
 #ifdef LTC_CLEAN_STACK
-static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
+static int s_blake2s_compress_block(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 {
    int err;
-   err = ss_blake2s_compress(md, buf);
+   err = ss_blake2s_compress_block(h, buf, t, f);
    burn_stack(sizeof(ulong32) * (32) + sizeof(unsigned long));
    return err;
 }
 #endif
 
+/**
+   Run the compression function on one block
+   @param h     The chaining value, ulong32[8]
+   @param buf   The block of 64 octets
+   @param t     The counter, ulong32[2]
+   @param f     The finalization flags, ulong32[2]
+   @return CRYPT_OK if successful
+*/
+int blake2s_compress_block(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
+{
+#if defined(LTC_BLAKE2_SIMD)
+   if (blake2s_simd_compress(h, buf, t, f) == CRYPT_OK) {
+      return CRYPT_OK;
+   }
+#endif
+   return s_blake2s_compress_block(h, buf, t, f);
+}
+
+static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
+{
+   return blake2s_compress_block(md->blake2s.h, buf, md->blake2s.t, md->blake2s.f);
+}
+
 /**
    Process a block of memory through the hash
    @param md     The hash state
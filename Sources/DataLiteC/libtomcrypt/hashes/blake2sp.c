@@ -0,0 +1,289 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file blake2sp.c
+   BLAKE2sp, eight BLAKE2s leaves and a root as specified in section 2.10 of
+   https://blake2.net/blake2.pdf
+
+   Block i of the message goes to leaf i % 8. The leaves advance in lock-step
+   over stripes of eight blocks, which lets the AVX2 kernel hash one leaf per
+   lane of its registers. A leaf may only compress a block when it is known
+   that more data for this leaf follows, so the last stripe stays in the
+   buffer until the next one starts to arrive.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2SP
+
+#define BLAKE2SP_LEAVES   8
+#define BLAKE2SP_BLOCK    64
+#define BLAKE2SP_STRIPE   (BLAKE2SP_LEAVES * BLAKE2SP_BLOCK)
+#define BLAKE2SP_OUTBYTES 32
+
+const struct ltc_hash_descriptor blake2sp_256_desc =
+{
+    "blake2sp-256",
+    34,
+    32,
+    64,
+    { 0 },
+    0,
+    &blake2sp_256_init,
+    &blake2sp_process,
+    &blake2sp_done,
+    &blake2sp_256_test,
+    NULL,
+    NULL
+};
+
+/* the parameter block of a leaf or of the root */
+static void s_blake2sp_param(unsigned char *P, unsigned long node_offset, unsigned char node_depth)
+{
+   XMEMSET(P, 0, 32);
+   P[0] = BLAKE2SP_OUTBYTES;       /* digest length */
+   P[2] = BLAKE2SP_LEAVES;         /* fanout */
+   P[3] = 2;                       /* depth */
+   STORE32L(node_offset, P + 8);
+   P[14] = node_depth;
+   P[15] = BLAKE2SP_OUTBYTES;      /* inner length */
+}
+
+/* compress one block of a single leaf */
+static void s_blake2sp_compress_leaf(struct blake2sp_state *S, int leaf, const unsigned char *block,
+                                     unsigned long len, int last)
+{
+   ulong32 h[8], t[2], f[2];
+   int i;
+
+   for (i = 0; i < 8; ++i) {
+      h[i] = S->h[i][leaf];
+   }
+   S->t[leaf] += len;
+   t[0] = (ulong32)S->t[leaf];
+   t[1] = (ulong32)(S->t[leaf] >> 32);
+   f[0] = last ? 0xffffffffUL : 0;
+   f[1] = (last && leaf == BLAKE2SP_LEAVES - 1) ? 0xffffffffUL : 0;
+   blake2s_compress_block(h, block, t, f);
+   for (i = 0; i < 8; ++i) {
+      S->h[i][leaf] = h[i];
+   }
+}
+
+/* compress a stripe, none of its blocks is the last one of its leaf */
+static void s_blake2sp_compress_stripe(struct blake2sp_state *S, const unsigned char *in)
+{
+   int leaf;
+
+#if defined(LTC_BLAKE2_SIMD)
+   ulong64 t[BLAKE2SP_LEAVES];
+
+   for (leaf = 0; leaf < BLAKE2SP_LEAVES; ++leaf) {
+      t[leaf] = S->t[leaf] + BLAKE2SP_BLOCK;
+   }
+   if (blake2sp_simd_compress8(S->h, in, t) == CRYPT_OK) {
+      XMEMCPY(S->t, t, sizeof(t));
+      return;
+   }
+#endif
+   for (leaf = 0; leaf < BLAKE2SP_LEAVES; ++leaf) {
+      s_blake2sp_compress_leaf(S, leaf, in + leaf * BLAKE2SP_BLOCK, BLAKE2SP_BLOCK, 0);
+   }
+}
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return CRYPT_OK if successful
+*/
+int blake2sp_256_init(hash_state *md)
+{
+   unsigned char P[32];
+   hash_state leaf;
+   int i, j, err;
+
+   LTC_ARGCHK(md != NULL);
+
+   XMEMSET(&md->blake2sp, 0, sizeof(md->blake2sp));
+   for (j = 0; j < BLAKE2SP_LEAVES; ++j) {
+      s_blake2sp_param(P, (unsigned long)j, 0);
+      if ((err = blake2s_init_param(&leaf, P)) != CRYPT_OK) {
+         return err;
+      }
+      for (i = 0; i < 8; ++i) {
+         md->blake2sp.h[i][j] = leaf.blake2s.h[i];
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Process a block of memory through the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int blake2sp_process(hash_state *md, const unsigned char *in, unsigned long inlen)
+{
+   struct blake2sp_state *S;
+   unsigned long n;
+   int leaf;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(in != NULL);
+
+   S = &md->blake2sp;
+   if (S->curlen >= sizeof(S->buf)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   while (inlen > 0) {
+      if (S->curlen == 0) {
+         if (S->pending && inlen > BLAKE2SP_STRIPE - BLAKE2SP_BLOCK) {
+            /* every leaf gets more data, so none of the buffered blocks is a last one */
+            s_blake2sp_compress_stripe(S, S->buf);
+            S->pending = 0;
+         }
+         if (!S->pending) {
+            while (inlen > 2 * BLAKE2SP_STRIPE - BLAKE2SP_BLOCK) {
+               s_blake2sp_compress_stripe(S, in);
+               in    += BLAKE2SP_STRIPE;
+               inlen -= BLAKE2SP_STRIPE;
+            }
+         }
+      }
+      leaf = (int)(S->curlen / BLAKE2SP_BLOCK);
+      if (S->pending && S->curlen % BLAKE2SP_BLOCK == 0) {
+         /* the leaf gets more data, so its buffered block isn't the last one */
+         s_blake2sp_compress_leaf(S, leaf, S->buf + S->curlen, BLAKE2SP_BLOCK, 0);
+      }
+      n = MIN(inlen, BLAKE2SP_BLOCK - S->curlen % BLAKE2SP_BLOCK);
+      XMEMCPY(S->buf + S->curlen, in, n);
+      S->curlen += n;
+      in        += n;
+      inlen     -= n;
+      if (S->curlen == BLAKE2SP_STRIPE) {
+         S->curlen  = 0;
+         S->pending = 1;
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (32 bytes)
+   @return CRYPT_OK if successful
+*/
+int blake2sp_done(hash_state *md, unsigned char *out)
+{
+   unsigned char P[32], hash[BLAKE2SP_LEAVES * BLAKE2SP_OUTBYTES], *block;
+   struct blake2sp_state *S;
+   unsigned long len;
+   hash_state root;
+   int i, leaf, err;
+
+   LTC_ARGCHK(md  != NULL);
+   LTC_ARGCHK(out != NULL);
+
+   S = &md->blake2sp;
+   if (S->curlen >= sizeof(S->buf)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the last block of each leaf is either in the current stripe, the previous one or empty */
+   for (leaf = 0; leaf < BLAKE2SP_LEAVES; ++leaf) {
+      block = S->buf + leaf * BLAKE2SP_BLOCK;
+      if (S->curlen > (unsigned long)leaf * BLAKE2SP_BLOCK) {
+         len = MIN(S->curlen - leaf * BLAKE2SP_BLOCK, BLAKE2SP_BLOCK);
+      } else {
+         len = S->pending ? BLAKE2SP_BLOCK : 0;
+      }
+      XMEMSET(block + len, 0, BLAKE2SP_BLOCK - len);
+      s_blake2sp_compress_leaf(S, leaf, block, len, 1);
+      for (i = 0; i < 8; ++i) {
+         STORE32L(S->h[i][leaf], hash + leaf * BLAKE2SP_OUTBYTES + i * 4);
+      }
+   }
+
+   s_blake2sp_param(P, 0, 1);
+   if ((err = blake2s_init_param(&root, P)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   root.blake2s.last_node = 1;
+   if ((err = blake2s_process(&root, hash, sizeof(hash))) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   err = blake2s_done(&root, out);
+
+LBL_ERR:
+   zeromem(md, sizeof(hash_state));
+#ifdef LTC_CLEAN_STACK
+   zeromem(hash, sizeof(hash));
+   zeromem(&root, sizeof(root));
+#endif
+   return err;
+}
+
+/**
+  Self-test the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if self-tests have been disabled
+*/
+int blake2sp_256_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      const char *msg;
+      unsigned long len;
+      unsigned char hash[32];
+   } tests[] = {
+      { "", 0,
+        { 0xdd, 0x0e, 0x89, 0x17, 0x76, 0x93, 0x3f, 0x43,
+          0xc7, 0xd0, 0x32, 0xb0, 0x8a, 0x91, 0x7e, 0x25,
+          0x74, 0x1f, 0x8a, 0xa9, 0xa1, 0x2c, 0x12, 0xe1,
+          0xca, 0xc8, 0x80, 0x15, 0x00, 0xf2, 0xca, 0x4f } },
+      { "abc", 3,
+        { 0x70, 0xf7, 0x5b, 0x58, 0xf1, 0xfe, 0xca, 0xb8,
+          0x21, 0xdb, 0x43, 0xc8, 0x8a, 0xd8, 0x4e, 0xdd,
+          0xe5, 0xa5, 0x26, 0x00, 0x61, 0x6c, 0xd2, 0x25,
+          0x17, 0xb7, 0xbb, 0x14, 0xd4, 0x40, 0xa7, 0xd5 } },
+      /* 0, 1, 2, ... 255, 0, 1, ... */
+      { NULL, 2000,
+        { 0x10, 0x00, 0xa2, 0xf4, 0xa8, 0xc3, 0x04, 0xef,
+          0x08, 0x0f, 0xdb, 0x87, 0x70, 0xf9, 0xd6, 0xbb,
+          0xe2, 0xdd, 0x05, 0x87, 0xa1, 0x12, 0x4c, 0x39,
+          0x19, 0xaf, 0xd8, 0x5e, 0x2b, 0xf3, 0x12, 0x41 } },
+   };
+
+   unsigned char buf[2000], tmp[32];
+   const unsigned char *in;
+   unsigned long i, n, chunk;
+   hash_state md;
+
+   for (i = 0; i < sizeof(buf); i++) {
+      buf[i] = (unsigned char)i;
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      in = tests[i].msg != NULL ? (const unsigned char *)tests[i].msg : buf;
+      /* in pieces of varying length, so that every path through the buffer is taken */
+      for (chunk = 1; chunk <= 1031; chunk += 205) {
+         blake2sp_256_init(&md);
+         for (n = 0; n < tests[i].len; n += MIN(chunk, tests[i].len - n)) {
+            blake2sp_process(&md, in + n, MIN(chunk, tests[i].len - n));
+         }
+         blake2sp_done(&md, tmp);
+         if (compare_testvector(tmp, sizeof(tmp), tests[i].hash, sizeof(tests[i].hash), "BLAKE2SP_256", (int)i)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif /* LTC_BLAKE2SP */
@@ -23,6 +23,7 @@ const struct ltc_hash_descriptor chc_desc = {
    &chc_process,
    &chc_done,
    &chc_test,
+   NULL,
    NULL
 };
 
@@ -0,0 +1,121 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file hash_iov_test.c
+  Self-test of the process_iov functions against process, shared by the hashes' *_test()
+*/
+
+#ifdef LTC_TEST
+
+#define HASH_IOV_TEST_SEGMENTS 32
+
+/* split msg into segments: a fixed list first, then pseudo-random ones, every fourth of them empty */
+static unsigned long s_hash_iov_split(ltc_iovec *iov, const unsigned char *msg, unsigned long msglen,
+                                      unsigned long blocksize, int round, ulong32 *seed)
+{
+    const unsigned long fixed[] = { 0, 1, 0, blocksize - 1, blocksize, 0, blocksize + 1, 2 * blocksize, 3, 0 };
+    unsigned long n, off, len;
+
+    for (n = 0, off = 0; n < HASH_IOV_TEST_SEGMENTS - 1; n++) {
+        if (round == 0) {
+            if (n == sizeof(fixed) / sizeof(fixed[0])) {
+                break;
+            }
+            len = fixed[n];
+        } else if (n % 4 == 3) {
+            len = 0;
+        } else {
+            *seed = *seed * 1103515245uL + 12345uL;
+            len = (unsigned long)((*seed >> 16) % (2 * blocksize + 2));
+        }
+        len = MIN(len, msglen - off);
+        iov[n].in    = msg + off;
+        iov[n].inlen = len;
+        off += len;
+    }
+    /* the rest, possibly empty */
+    iov[n].in    = msg + off;
+    iov[n].inlen = msglen - off;
+    return n + 1;
+}
+
+/**
+  Check that feeding a message through process_iov in segments, some of them empty or
+  straddling block boundaries, gives the same digest as one process call
+  @param desc   The descriptor of the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if the hash has no process_iov
+*/
+int hash_iov_test(const struct ltc_hash_descriptor *desc)
+{
+    unsigned char msg[700], ref[MAXBLOCKSIZE], out[MAXBLOCKSIZE];
+    ltc_iovec iov[HASH_IOV_TEST_SEGMENTS];
+    unsigned long x, n, half;
+    hash_state md;
+    ulong32 seed = 1;
+    int round, err;
+#ifdef LTC_HASH_HELPERS
+    int hash;
+#endif
+
+    LTC_ARGCHK(desc != NULL);
+
+    if (desc->process_iov == NULL) {
+        return CRYPT_NOP;
+    }
+
+    for (x = 0; x < sizeof(msg); x++) {
+        msg[x] = (unsigned char)(x * 31 + 7);
+    }
+    if ((err = desc->init(&md)) != CRYPT_OK ||
+        (err = desc->process(&md, msg, sizeof(msg))) != CRYPT_OK ||
+        (err = desc->done(&md, ref)) != CRYPT_OK) {
+        return err;
+    }
+
+    for (round = 0; round < 16; round++) {
+        n = s_hash_iov_split(iov, msg, sizeof(msg), desc->blocksize, round, &seed);
+        if ((err = desc->init(&md)) != CRYPT_OK) {
+            return err;
+        }
+        if (round % 2 == 0) {
+            if ((err = desc->process_iov(&md, NULL, 0)) != CRYPT_OK ||
+                (err = desc->process_iov(&md, iov, n)) != CRYPT_OK) {
+                return err;
+            }
+        } else {
+            /* start with a partly filled buffer and carry it across two calls */
+            half = n / 2;
+            if ((err = desc->process(&md, iov[0].in, iov[0].inlen)) != CRYPT_OK ||
+                (err = desc->process_iov(&md, iov + 1, half)) != CRYPT_OK ||
+                (err = desc->process_iov(&md, iov + 1 + half, n - 1 - half)) != CRYPT_OK) {
+                return err;
+            }
+        }
+        if ((err = desc->done(&md, out)) != CRYPT_OK) {
+            return err;
+        }
+        if (compare_testvector(out, desc->hashsize, ref, desc->hashsize, desc->name, round)) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+    }
+
+#ifdef LTC_HASH_HELPERS
+    /* and through the helper, if the hash is registered */
+    if ((hash = find_hash(desc->name)) != -1) {
+        n = s_hash_iov_split(iov, msg, sizeof(msg), desc->blocksize, 1, &seed);
+        x = sizeof(out);
+        if ((err = hash_memory_iov(hash, iov, n, out, &x)) != CRYPT_OK) {
+            return err;
+        }
+        if (compare_testvector(out, x, ref, desc->hashsize, desc->name, 16)) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+    }
+#endif
+
+    return CRYPT_OK;
+}
+
+#endif /* LTC_TEST */
@@ -35,7 +35,9 @@ int hash_memory(int hash, const unsigned char *in, unsigned long inlen, unsigned
        return CRYPT_BUFFER_OVERFLOW;
     }
 
+    LTC_STATS_ENTER(hash, hash);
     md = XMALLOC(sizeof(hash_state));
+    LTC_STATS_LEAVE();
     if (md == NULL) {
        return CRYPT_MEM;
     }
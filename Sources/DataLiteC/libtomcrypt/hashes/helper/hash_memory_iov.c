@@ -0,0 +1,73 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+#ifdef LTC_HASH_HELPERS
+/**
+  @file hash_memory_iov.c
+  Hash (scatter-gather) memory helper
+*/
+
+/**
+  Hash several (non-adjacent) segments of memory at once, like hash_memory_multi()
+  but with a list of segments that can be built at run-time.
+  @param hash   The index of the hash you wish to use
+  @param iov    The segments to hash
+  @param iovcnt The number of segments
+  @param out    [out] Where to store the digest
+  @param outlen [in/out] Max size and resulting size of the digest
+  @return CRYPT_OK if successful
+*/
+int hash_memory_iov(int hash,
+                    const ltc_iovec *iov, unsigned long iovcnt,
+                          unsigned char *out, unsigned long *outlen)
+{
+    hash_state    *md;
+    unsigned long  x;
+    int            err;
+
+    LTC_ARGCHK(iov    != NULL || iovcnt == 0);
+    LTC_ARGCHK(out    != NULL);
+    LTC_ARGCHK(outlen != NULL);
+
+    if ((err = hash_is_valid(hash)) != CRYPT_OK) {
+        return err;
+    }
+
+    if (*outlen < hash_descriptor[hash].hashsize) {
+       *outlen = hash_descriptor[hash].hashsize;
+       return CRYPT_BUFFER_OVERFLOW;
+    }
+
+    LTC_STATS_ENTER(hash, hash);
+    md = XMALLOC(sizeof(hash_state));
+    LTC_STATS_LEAVE();
+    if (md == NULL) {
+       return CRYPT_MEM;
+    }
+
+    if ((err = hash_descriptor[hash].init(md)) != CRYPT_OK) {
+       goto LBL_ERR;
+    }
+
+    if (hash_descriptor[hash].process_iov != NULL) {
+       if ((err = hash_descriptor[hash].process_iov(md, iov, iovcnt)) != CRYPT_OK) {
+          goto LBL_ERR;
+       }
+    } else {
+       for (x = 0; x < iovcnt; x++) {
+          if ((err = hash_descriptor[hash].process(md, iov[x].in, iov[x].inlen)) != CRYPT_OK) {
+             goto LBL_ERR;
+          }
+       }
+    }
+    err = hash_descriptor[hash].done(md, out);
+    *outlen = hash_descriptor[hash].hashsize;
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+    zeromem(md, sizeof(hash_state));
+#endif
+    XFREE(md);
+    return err;
+}
+#endif /* #ifdef LTC_HASH_HELPERS */
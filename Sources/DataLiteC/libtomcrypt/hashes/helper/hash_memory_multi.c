@@ -40,7 +40,9 @@ int hash_memory_multi(int hash, unsigned char *out, unsigned long *outlen,
        return CRYPT_BUFFER_OVERFLOW;
     }
 
+    LTC_STATS_ENTER(hash, hash);
     md = XMALLOC(sizeof(hash_state));
+    LTC_STATS_LEAVE();
     if (md == NULL) {
        return CRYPT_MEM;
     }
@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor md4_desc =
     &md4_process,
     &md4_done,
     &md4_test,
-    NULL
+    NULL,
+    &md4_process_iov
 };
 
 #define S11 3
@@ -184,6 +185,15 @@ int md4_init(hash_state * md)
 */
 HASH_PROCESS(md4_process, s_md4_compress, md4, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(md4_process_iov, s_md4_compress, md4, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -287,7 +297,7 @@ int md4_test(void)
         }
 
     }
-    return CRYPT_OK;
+    return hash_iov_test(&md4_desc);
   #endif
 }
 
@@ -25,7 +25,8 @@ const struct ltc_hash_descriptor md5_desc =
     &md5_process,
     &md5_done,
     &md5_test,
-    NULL
+    NULL,
+    &md5_process_iov
 };
 
 #define F(x,y,z)  (z ^ (x & (y ^ z)))
@@ -243,6 +244,15 @@ int md5_init(hash_state * md)
 */
 HASH_PROCESS(md5_process, s_md5_compress, md5, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(md5_process_iov, s_md5_compress, md5, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -347,7 +357,7 @@ int  md5_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(&md5_desc);
  #endif
 }
 
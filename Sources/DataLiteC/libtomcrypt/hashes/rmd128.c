@@ -30,7 +30,8 @@ const struct ltc_hash_descriptor rmd128_desc =
     &rmd128_process,
     &rmd128_done,
     &rmd128_test,
-    NULL
+    NULL,
+    &rmd128_process_iov
 };
 
 /* the four basic functions F(), G() and H() */
@@ -282,6 +283,15 @@ int rmd128_init(hash_state * md)
 */
 HASH_PROCESS(rmd128_process, s_rmd128_compress, rmd128, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(rmd128_process_iov, s_rmd128_compress, rmd128, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -388,7 +398,7 @@ int rmd128_test(void)
           return CRYPT_FAIL_TESTVECTOR;
        }
    }
-   return CRYPT_OK;
+   return hash_iov_test(&rmd128_desc);
 #endif
 }
 
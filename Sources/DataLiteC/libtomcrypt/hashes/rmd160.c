@@ -30,7 +30,8 @@ const struct ltc_hash_descriptor rmd160_desc =
     &rmd160_process,
     &rmd160_done,
     &rmd160_test,
-    NULL
+    NULL,
+    &rmd160_process_iov
 };
 
 /* the five basic functions F(), G() and H() */
@@ -341,6 +342,15 @@ int rmd160_init(hash_state * md)
 */
 HASH_PROCESS(rmd160_process, s_rmd160_compress, rmd160, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(rmd160_process_iov, s_rmd160_compress, rmd160, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -447,7 +457,7 @@ int rmd160_test(void)
           return CRYPT_FAIL_TESTVECTOR;
        }
    }
-   return CRYPT_OK;
+   return hash_iov_test(&rmd160_desc);
 #endif
 }
 
@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor rmd256_desc =
     &rmd256_process,
     &rmd256_done,
     &rmd256_test,
-    NULL
+    NULL,
+    &rmd256_process_iov
 };
 
 /* the four basic functions F(), G() and H() */
@@ -295,6 +296,15 @@ int rmd256_init(hash_state * md)
 */
 HASH_PROCESS(rmd256_process, s_rmd256_compress, rmd256, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(rmd256_process_iov, s_rmd256_compress, rmd256, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -413,7 +423,7 @@ int rmd256_test(void)
           return CRYPT_FAIL_TESTVECTOR;
        }
    }
-   return CRYPT_OK;
+   return hash_iov_test(&rmd256_desc);
 #endif
 }
 
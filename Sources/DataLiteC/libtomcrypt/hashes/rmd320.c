@@ -25,7 +25,8 @@ const struct ltc_hash_descriptor rmd320_desc =
     &rmd320_process,
     &rmd320_done,
     &rmd320_test,
-    NULL
+    NULL,
+    &rmd320_process_iov
 };
 
 /* the five basic functions F(), G() and H() */
@@ -360,6 +361,15 @@ int rmd320_init(hash_state * md)
 */
 HASH_PROCESS(rmd320_process, s_rmd320_compress, rmd320, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(rmd320_process_iov, s_rmd320_compress, rmd320, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -478,7 +488,7 @@ int rmd320_test(void)
           return CRYPT_FAIL_TESTVECTOR;
        }
    }
-   return CRYPT_OK;
+   return hash_iov_test(&rmd320_desc);
 #endif
 }
 
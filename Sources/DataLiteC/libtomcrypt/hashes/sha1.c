@@ -25,7 +25,8 @@ const struct ltc_hash_descriptor sha1_desc =
     &sha1_process,
     &sha1_done,
     &sha1_test,
-    NULL
+    NULL,
+    &sha1_process_iov
 };
 
 #define F0(x,y,z)  (z ^ (x & (y ^ z)))
@@ -176,6 +177,15 @@ int sha1_init(hash_state * md)
 */
 HASH_PROCESS(sha1_process, s_sha1_compress, sha1, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(sha1_process_iov, s_sha1_compress, sha1, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -267,7 +277,7 @@ int  sha1_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(&sha1_desc);
   #endif
 }
 
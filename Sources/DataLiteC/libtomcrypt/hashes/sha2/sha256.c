@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor sha256_desc =
     &sha256_process,
     &sha256_done,
     &sha256_test,
-    NULL
+    NULL,
+    &sha256_process_iov
 };
 
 #ifdef LTC_SMALL_CODE
@@ -219,6 +220,15 @@ int sha256_init(hash_state * md)
 */
 HASH_PROCESS(sha256_process,s_sha256_compress, sha256, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(sha256_process_iov,s_sha256_compress, sha256, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -313,7 +323,7 @@ int  sha256_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(&sha256_desc);
  #endif
 }
 
@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor sha512_desc =
     &sha512_process,
     &sha512_done,
     &sha512_test,
-    NULL
+    NULL,
+    &sha512_process_iov
 };
 
 /* the K array */
@@ -189,6 +190,15 @@ int sha512_init(hash_state * md)
 */
 HASH_PROCESS(sha512_process, s_sha512_compress, sha512, 128)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(sha512_process_iov, s_sha512_compress, sha512, 128)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -293,7 +303,7 @@ int  sha512_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(&sha512_desc);
   #endif
 }
 
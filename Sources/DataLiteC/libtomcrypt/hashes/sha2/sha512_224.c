@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor sha512_224_desc =
     &sha512_process,
     &sha512_224_done,
     &sha512_224_test,
-    NULL
+    NULL,
+    &sha512_process_iov
 };
 
 /**
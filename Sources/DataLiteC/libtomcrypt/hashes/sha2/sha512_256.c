@@ -24,7 +24,8 @@ const struct ltc_hash_descriptor sha512_256_desc =
     &sha512_process,
     &sha512_256_done,
     &sha512_256_test,
-    NULL
+    NULL,
+    &sha512_process_iov
 };
 
 /**
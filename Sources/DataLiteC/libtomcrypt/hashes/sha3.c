@@ -23,6 +23,7 @@ const struct ltc_hash_descriptor sha3_224_desc =
    &sha3_process,
    &sha3_done,
    &sha3_224_test,
+   NULL,
    NULL
 };
 
@@ -38,6 +39,7 @@ const struct ltc_hash_descriptor sha3_256_desc =
    &sha3_process,
    &sha3_done,
    &sha3_256_test,
+   NULL,
    NULL
 };
 
@@ -53,6 +55,7 @@ const struct ltc_hash_descriptor sha3_384_desc =
    &sha3_process,
    &sha3_done,
    &sha3_384_test,
+   NULL,
    NULL
 };
 
@@ -68,6 +71,7 @@ const struct ltc_hash_descriptor sha3_512_desc =
    &sha3_process,
    &sha3_done,
    &sha3_512_test,
+   NULL,
    NULL
 };
 #endif
@@ -84,6 +88,7 @@ const struct ltc_hash_descriptor keccak_224_desc =
    &sha3_process,
    &keccak_done,
    &keccak_224_test,
+   NULL,
    NULL
 };
 
@@ -98,6 +103,7 @@ const struct ltc_hash_descriptor keccak_256_desc =
    &sha3_process,
    &keccak_done,
    &keccak_256_test,
+   NULL,
    NULL
 };
 
@@ -112,6 +118,7 @@ const struct ltc_hash_descriptor keccak_384_desc =
    &sha3_process,
    &keccak_done,
    &keccak_384_test,
+   NULL,
    NULL
 };
 
@@ -126,6 +133,7 @@ const struct ltc_hash_descriptor keccak_512_desc =
    &sha3_process,
    &keccak_done,
    &keccak_512_test,
+   NULL,
    NULL
 };
 #endif
@@ -150,49 +158,99 @@ static const ulong64 s_keccakf_rndc[24] = {
    CONST64(0x0000000080000001), CONST64(0x8000000080008008)
 };
 
-static const unsigned s_keccakf_rotc[24] = {
-   1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
-};
-
-static const unsigned s_keccakf_piln[24] = {
-   10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
-};
+/* lanes that are kept complemented during the rounds, see "Keccak implementation overview"
+ * section 2.2, with these chi gets by with one NOT per row */
+#define SHA3_COMPLEMENT_LANES(a)  \
+   do {                           \
+      a[1]  = ~a[1];              \
+      a[2]  = ~a[2];              \
+      a[8]  = ~a[8];              \
+      a[12] = ~a[12];             \
+      a[17] = ~a[17];             \
+      a[20] = ~a[20];             \
+   } while (0)
 
 static void s_keccakf(ulong64 s[25])
 {
-   int i, j, round;
-   ulong64 t, bc[5];
+   ulong64 a[25], b[25], c[5], d[5];
+   int i, round;
+
+   for(i = 0; i < 25; i++) {
+      a[i] = s[i];
+   }
+   SHA3_COMPLEMENT_LANES(a);
 
    for(round = 0; round < SHA3_KECCAK_ROUNDS; round++) {
       /* Theta */
-      for(i = 0; i < 5; i++) {
-         bc[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
-      }
-      for(i = 0; i < 5; i++) {
-         t = bc[(i + 4) % 5] ^ ROL64(bc[(i + 1) % 5], 1);
-         for(j = 0; j < 25; j += 5) {
-            s[j + i] ^= t;
-         }
-      }
+      c[0] = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+      c[1] = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+      c[2] = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+      c[3] = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+      c[4] = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+      d[0] = c[4] ^ ROL64c(c[1], 1);
+      d[1] = c[0] ^ ROL64c(c[2], 1);
+      d[2] = c[1] ^ ROL64c(c[3], 1);
+      d[3] = c[2] ^ ROL64c(c[4], 1);
+      d[4] = c[3] ^ ROL64c(c[0], 1);
       /* Rho Pi */
-      t = s[1];
-      for(i = 0; i < 24; i++) {
-         j = s_keccakf_piln[i];
-         bc[0] = s[j];
-         s[j] = ROL64(t, s_keccakf_rotc[i]);
-         t = bc[0];
-      }
+      b[0] = a[0] ^ d[0];
+      b[1] = ROL64c(a[6] ^ d[1], 44);
+      b[2] = ROL64c(a[12] ^ d[2], 43);
+      b[3] = ROL64c(a[18] ^ d[3], 21);
+      b[4] = ROL64c(a[24] ^ d[4], 14);
+      b[5] = ROL64c(a[3] ^ d[3], 28);
+      b[6] = ROL64c(a[9] ^ d[4], 20);
+      b[7] = ROL64c(a[10] ^ d[0], 3);
+      b[8] = ROL64c(a[16] ^ d[1], 45);
+      b[9] = ROL64c(a[22] ^ d[2], 61);
+      b[10] = ROL64c(a[1] ^ d[1], 1);
+      b[11] = ROL64c(a[7] ^ d[2], 6);
+      b[12] = ROL64c(a[13] ^ d[3], 25);
+      b[13] = ROL64c(a[19] ^ d[4], 8);
+      b[14] = ROL64c(a[20] ^ d[0], 18);
+      b[15] = ROL64c(a[4] ^ d[4], 27);
+      b[16] = ROL64c(a[5] ^ d[0], 36);
+      b[17] = ROL64c(a[11] ^ d[1], 10);
+      b[18] = ROL64c(a[17] ^ d[2], 15);
+      b[19] = ROL64c(a[23] ^ d[3], 56);
+      b[20] = ROL64c(a[2] ^ d[2], 62);
+      b[21] = ROL64c(a[8] ^ d[3], 55);
+      b[22] = ROL64c(a[14] ^ d[4], 39);
+      b[23] = ROL64c(a[15] ^ d[0], 41);
+      b[24] = ROL64c(a[21] ^ d[1], 2);
       /* Chi */
-      for(j = 0; j < 25; j += 5) {
-         for(i = 0; i < 5; i++) {
-            bc[i] = s[j + i];
-         }
-         for(i = 0; i < 5; i++) {
-            s[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
-         }
-      }
+      a[0] = b[0] ^ (b[1] | b[2]);
+      a[1] = b[1] ^ (~b[2] | b[3]);
+      a[2] = b[2] ^ (b[3] & b[4]);
+      a[3] = b[3] ^ (b[4] | b[0]);
+      a[4] = b[4] ^ (b[0] & b[1]);
+      a[5] = b[5] ^ (b[6] | b[7]);
+      a[6] = b[6] ^ (b[7] & b[8]);
+      a[7] = b[7] ^ (b[8] | ~b[9]);
+      a[8] = b[8] ^ (b[9] | b[5]);
+      a[9] = b[9] ^ (b[5] & b[6]);
+      a[10] = b[10] ^ (b[11] | b[12]);
+      a[11] = b[11] ^ (b[12] & b[13]);
+      a[12] = b[12] ^ (~b[13] & b[14]);
+      a[13] = ~b[13] ^ (b[14] | b[10]);
+      a[14] = b[14] ^ (b[10] & b[11]);
+      a[15] = b[15] ^ (b[16] & b[17]);
+      a[16] = b[16] ^ (b[17] | b[18]);
+      a[17] = b[17] ^ (~b[18] | b[19]);
+      a[18] = ~b[18] ^ (b[19] & b[15]);
+      a[19] = b[19] ^ (b[15] | b[16]);
+      a[20] = b[20] ^ (~b[21] & b[22]);
+      a[21] = ~b[21] ^ (b[22] | b[23]);
+      a[22] = b[22] ^ (b[23] & b[24]);
+      a[23] = b[23] ^ (b[24] | b[20]);
+      a[24] = b[24] ^ (b[20] & b[21]);
       /* Iota */
-      s[0] ^= s_keccakf_rndc[round];
+      a[0] ^= s_keccakf_rndc[round];
+   }
+
+   SHA3_COMPLEMENT_LANES(a);
+   for(i = 0; i < 25; i++) {
+      s[i] = a[i];
    }
 }
 
@@ -377,6 +435,159 @@ int sha3_shake_memory(int num, const unsigned char *in, unsigned long inlen, uns
    if ((err = sha3_shake_done(&md, out, *outlen)) != CRYPT_OK) return err;
    return CRYPT_OK;
 }
+
+/* Keccak-f on four states, lane i of state j is s[i][j] */
+static void s_keccakf_x4(ulong64 s[25][4])
+{
+   ulong64 t[25];
+   int i, j;
+
+#if defined(LTC_SHA3_SIMD)
+   if (sha3_simd_keccakf_x4(s) == CRYPT_OK) {
+      return;
+   }
+#endif
+   for (j = 0; j < 4; j++) {
+      for (i = 0; i < 25; i++) t[i] = s[i][j];
+      s_keccakf(t);
+      for (i = 0; i < 25; i++) s[i][j] = t[i];
+   }
+}
+
+/**
+   Hash four messages at once
+   The full blocks the messages have in common are absorbed four at a time. If all four
+   are of the same length the padding and the output are done four at a time as well,
+   otherwise the state of each message is finished on its own.
+   @param capacity_words  The capacity of the sponge in 64 bit words
+   @param xof             Non-zero for SHAKE, zero for SHA3
+   @param in              The four messages
+   @param inlen           Their lengths (octets)
+   @param out             [out] Where to store the four results
+   @param outlen          The length of each result (octets)
+   @return CRYPT_OK if successful
+*/
+static int s_sha3_x4(unsigned short capacity_words, int xof,
+                     const unsigned char *const in[4], const unsigned long inlen[4],
+                     unsigned char *const out[4], unsigned long outlen)
+{
+   ulong64 s[25][4], t;
+   unsigned char block[200];
+   unsigned long rate, blocks, off, n, i, j, k;
+   hash_state md;
+   int err = CRYPT_OK;
+
+   LTC_ARGCHK(in    != NULL);
+   LTC_ARGCHK(inlen != NULL);
+   LTC_ARGCHK(out   != NULL);
+   for (j = 0; j < 4; j++) {
+      LTC_ARGCHK(in[j]  != NULL || inlen[j] == 0);
+      LTC_ARGCHK(out[j] != NULL);
+   }
+
+   rate = (SHA3_KECCAK_SPONGE_WORDS - capacity_words) * 8;
+   blocks = inlen[0] / rate;
+   for (j = 1; j < 4; j++) {
+      blocks = MIN(blocks, inlen[j] / rate);
+   }
+
+   XMEMSET(s, 0, sizeof(s));
+   for (k = 0, off = 0; k < blocks; k++, off += rate) {
+      for (i = 0; i < rate / 8; i++) {
+         for (j = 0; j < 4; j++) {
+            LOAD64L(t, in[j] + off + i * 8);
+            s[i][j] ^= t;
+         }
+      }
+      s_keccakf_x4(s);
+   }
+
+   if (inlen[0] == inlen[1] && inlen[0] == inlen[2] && inlen[0] == inlen[3]) {
+      /* the same number of octets is left of each message, so pad all four and squeeze them together */
+      n = inlen[0] - off;
+      for (j = 0; j < 4; j++) {
+         XMEMSET(block, 0, rate);
+         if (n > 0) {
+            XMEMCPY(block, in[j] + off, n);
+         }
+         block[n] ^= xof ? 0x1F : 0x06;
+         block[rate - 1] ^= 0x80;
+         for (i = 0; i < rate / 8; i++) {
+            LOAD64L(t, block + i * 8);
+            s[i][j] ^= t;
+         }
+      }
+      s_keccakf_x4(s);
+      for (off = 0;;) {
+         n = MIN(outlen - off, rate);
+         for (j = 0; j < 4; j++) {
+            for (i = 0; i < (n + 7) / 8; i++) {
+               STORE64L(s[i][j], block + i * 8);
+            }
+            XMEMCPY(out[j] + off, block, n);
+         }
+         off += n;
+         if (off == outlen) {
+            break;
+         }
+         s_keccakf_x4(s);
+      }
+   } else {
+      for (j = 0; j < 4; j++) {
+         XMEMSET(&md.sha3, 0, sizeof(md.sha3));
+         md.sha3.capacity_words = capacity_words;
+         for (i = 0; i < SHA3_KECCAK_SPONGE_WORDS; i++) {
+            md.sha3.s[i] = s[i][j];
+         }
+         if ((err = sha3_process(&md, in[j] + off, inlen[j] - off)) != CRYPT_OK) {
+            break;
+         }
+         err = xof ? sha3_shake_done(&md, out[j], outlen) : ss_done(&md, out[j], CONST64(0x06));
+         if (err != CRYPT_OK) {
+            break;
+         }
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(s, sizeof(s));
+   zeromem(block, sizeof(block));
+   zeromem(&md, sizeof(md));
+#endif
+   return err;
+}
+
+/**
+   Hash four independent messages with SHA3, for instance the leaves of a Merkle tree
+   The work is shared as long as the messages are of the same length, so this is
+   fastest for messages of equal size.
+   @param num     The SHA3 variant, 224, 256, 384 or 512
+   @param in      The four messages
+   @param inlen   The length of each message (octets)
+   @param out     [out] Where to store the four digests (num / 8 octets each)
+   @return CRYPT_OK if successful
+*/
+int sha3_memory_x4(int num, const unsigned char *const in[4], const unsigned long inlen[4], unsigned char *const out[4])
+{
+   if (num != 224 && num != 256 && num != 384 && num != 512) return CRYPT_INVALID_ARG;
+   return s_sha3_x4((unsigned short)(2 * num / (8 * sizeof(ulong64))), 0, in, inlen, out, (unsigned long)num / 8);
+}
+
+/**
+   Feed four independent messages to SHAKE and read the same amount of output from each
+   @param num     The SHAKE variant, 128 or 256
+   @param in      The four messages
+   @param inlen   The length of each message (octets)
+   @param out     [out] Where to store the four outputs
+   @param outlen  The length of each output (octets)
+   @return CRYPT_OK if successful
+*/
+int sha3_shake_memory_x4(int num, const unsigned char *const in[4], const unsigned long inlen[4], unsigned char *const out[4], unsigned long outlen)
+{
+   if (num != 128 && num != 256) return CRYPT_INVALID_ARG;
+   if (outlen == 0) return CRYPT_OK; /* nothing to do */
+   return s_sha3_x4((unsigned short)(2 * num / (8 * sizeof(ulong64))), 1, in, inlen, out, outlen);
+}
 #endif
 
 #endif
@@ -0,0 +1,143 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file sha3_simd.c
+  AVX2 Keccak-f[1600] on four independent states for x86_64, selected at run-time.
+  Lane i of state j is in 64 bit element j of register i, so every step of the
+  permutation runs on the four states at once.
+*/
+
+#if defined(LTC_SHA3_SIMD)
+
+#include <immintrin.h>
+
+static const ulong64 s_keccakf_rndc[24] = {
+   CONST64(0x0000000000000001), CONST64(0x0000000000008082),
+   CONST64(0x800000000000808a), CONST64(0x8000000080008000),
+   CONST64(0x000000000000808b), CONST64(0x0000000080000001),
+   CONST64(0x8000000080008081), CONST64(0x8000000000008009),
+   CONST64(0x000000000000008a), CONST64(0x0000000000000088),
+   CONST64(0x0000000080008009), CONST64(0x000000008000000a),
+   CONST64(0x000000008000808b), CONST64(0x800000000000008b),
+   CONST64(0x8000000000008089), CONST64(0x8000000000008003),
+   CONST64(0x8000000000008002), CONST64(0x8000000000000080),
+   CONST64(0x000000000000800a), CONST64(0x800000008000000a),
+   CONST64(0x8000000080008081), CONST64(0x8000000000008080),
+   CONST64(0x0000000080000001), CONST64(0x8000000080008008)
+};
+
+/* 1 = AVX2 */
+static int s_sha3_simd_level(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) ? 1 : 0;
+}
+
+#define ROL(x, n)  _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+#define XOR5(a, b, c, d, e) \
+   _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(c, d)), e)
+#define CHI(a, b, c)  _mm256_xor_si256((a), _mm256_andnot_si256((b), (c)))
+
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_keccakf_x4_avx2(ulong64 s[25][4])
+{
+   __m256i a[25], b[25], c[5], d[5];
+   int i, round;
+
+   for (i = 0; i < 25; i++) {
+      a[i] = _mm256_loadu_si256((const __m256i *)s[i]);
+   }
+
+   for (round = 0; round < 24; round++) {
+      /* Theta */
+      c[0] = XOR5(a[0], a[5], a[10], a[15], a[20]);
+      c[1] = XOR5(a[1], a[6], a[11], a[16], a[21]);
+      c[2] = XOR5(a[2], a[7], a[12], a[17], a[22]);
+      c[3] = XOR5(a[3], a[8], a[13], a[18], a[23]);
+      c[4] = XOR5(a[4], a[9], a[14], a[19], a[24]);
+      d[0] = _mm256_xor_si256(c[4], ROL(c[1], 1));
+      d[1] = _mm256_xor_si256(c[0], ROL(c[2], 1));
+      d[2] = _mm256_xor_si256(c[1], ROL(c[3], 1));
+      d[3] = _mm256_xor_si256(c[2], ROL(c[4], 1));
+      d[4] = _mm256_xor_si256(c[3], ROL(c[0], 1));
+      /* Rho Pi */
+      b[0] = _mm256_xor_si256(a[0], d[0]);
+      b[1] = ROL(_mm256_xor_si256(a[6], d[1]), 44);
+      b[2] = ROL(_mm256_xor_si256(a[12], d[2]), 43);
+      b[3] = ROL(_mm256_xor_si256(a[18], d[3]), 21);
+      b[4] = ROL(_mm256_xor_si256(a[24], d[4]), 14);
+      b[5] = ROL(_mm256_xor_si256(a[3], d[3]), 28);
+      b[6] = ROL(_mm256_xor_si256(a[9], d[4]), 20);
+      b[7] = ROL(_mm256_xor_si256(a[10], d[0]), 3);
+      b[8] = ROL(_mm256_xor_si256(a[16], d[1]), 45);
+      b[9] = ROL(_mm256_xor_si256(a[22], d[2]), 61);
+      b[10] = ROL(_mm256_xor_si256(a[1], d[1]), 1);
+      b[11] = ROL(_mm256_xor_si256(a[7], d[2]), 6);
+      b[12] = ROL(_mm256_xor_si256(a[13], d[3]), 25);
+      b[13] = ROL(_mm256_xor_si256(a[19], d[4]), 8);
+      b[14] = ROL(_mm256_xor_si256(a[20], d[0]), 18);
+      b[15] = ROL(_mm256_xor_si256(a[4], d[4]), 27);
+      b[16] = ROL(_mm256_xor_si256(a[5], d[0]), 36);
+      b[17] = ROL(_mm256_xor_si256(a[11], d[1]), 10);
+      b[18] = ROL(_mm256_xor_si256(a[17], d[2]), 15);
+      b[19] = ROL(_mm256_xor_si256(a[23], d[3]), 56);
+      b[20] = ROL(_mm256_xor_si256(a[2], d[2]), 62);
+      b[21] = ROL(_mm256_xor_si256(a[8], d[3]), 55);
+      b[22] = ROL(_mm256_xor_si256(a[14], d[4]), 39);
+      b[23] = ROL(_mm256_xor_si256(a[15], d[0]), 41);
+      b[24] = ROL(_mm256_xor_si256(a[21], d[1]), 2);
+      /* Chi */
+      a[0] = CHI(b[0], b[1], b[2]);
+      a[1] = CHI(b[1], b[2], b[3]);
+      a[2] = CHI(b[2], b[3], b[4]);
+      a[3] = CHI(b[3], b[4], b[0]);
+      a[4] = CHI(b[4], b[0], b[1]);
+      a[5] = CHI(b[5], b[6], b[7]);
+      a[6] = CHI(b[6], b[7], b[8]);
+      a[7] = CHI(b[7], b[8], b[9]);
+      a[8] = CHI(b[8], b[9], b[5]);
+      a[9] = CHI(b[9], b[5], b[6]);
+      a[10] = CHI(b[10], b[11], b[12]);
+      a[11] = CHI(b[11], b[12], b[13]);
+      a[12] = CHI(b[12], b[13], b[14]);
+      a[13] = CHI(b[13], b[14], b[10]);
+      a[14] = CHI(b[14], b[10], b[11]);
+      a[15] = CHI(b[15], b[16], b[17]);
+      a[16] = CHI(b[16], b[17], b[18]);
+      a[17] = CHI(b[17], b[18], b[19]);
+      a[18] = CHI(b[18], b[19], b[15]);
+      a[19] = CHI(b[19], b[15], b[16]);
+      a[20] = CHI(b[20], b[21], b[22]);
+      a[21] = CHI(b[21], b[22], b[23]);
+      a[22] = CHI(b[22], b[23], b[24]);
+      a[23] = CHI(b[23], b[24], b[20]);
+      a[24] = CHI(b[24], b[20], b[21]);
+      /* Iota */
+      a[0] = _mm256_xor_si256(a[0], _mm256_set1_epi64x((long long)s_keccakf_rndc[round]));
+   }
+
+   for (i = 0; i < 25; i++) {
+      _mm256_storeu_si256((__m256i *)s[i], a[i]);
+   }
+}
+
+#undef ROL
+#undef XOR5
+#undef CHI
+
+/**
+   Keccak-f[1600] on four states
+   @param s   The states, lane i of state j is s[i][j]
+   @return CRYPT_OK if it has been done, CRYPT_NOP if the CPU lacks AVX2
+*/
+int sha3_simd_keccakf_x4(ulong64 s[25][4])
+{
+   if (s_sha3_simd_level() < 1) {
+      return CRYPT_NOP;
+   }
+   s_keccakf_x4_avx2(s);
+   return CRYPT_OK;
+}
+
+#endif /* LTC_SHA3_SIMD */
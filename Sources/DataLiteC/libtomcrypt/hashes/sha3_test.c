@@ -69,7 +69,10 @@ int sha3_256_test(void)
 #ifndef LTC_TEST
    return CRYPT_NOP;
 #else
-   unsigned char buf[200], hash[256 / 8];
+   unsigned char buf[200], hash[256 / 8], hash4[4][256 / 8];
+   const unsigned char *in4[4];
+   unsigned long inlen4[4];
+   unsigned char *out4[4];
    int i;
    hash_state c;
    const unsigned char c1 = 0xa3;
@@ -154,6 +157,26 @@ int sha3_256_test(void)
       return CRYPT_FAIL_TESTVECTOR;
    }
 
+   /* SHA3-256 of four messages at once, all of the same length and of different lengths */
+   for (i = 0; i < 4; i++) {
+      in4[i] = buf;
+      inlen4[i] = sizeof(buf);
+      out4[i] = hash4[i];
+   }
+   sha3_memory_x4(256, in4, inlen4, out4);
+   for (i = 0; i < 4; i++) {
+      if (compare_testvector(hash4[i], sizeof(hash4[i]), sha3_256_0xa3_200_times, sizeof(sha3_256_0xa3_200_times), "SHA3-256 x4", i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   inlen4[1] = inlen4[3] = 0;
+   sha3_memory_x4(256, in4, inlen4, out4);
+   for (i = 0; i < 4; i++) {
+      if (compare_testvector(hash4[i], sizeof(hash4[i]), (i & 1) ? sha3_256_empty : sha3_256_0xa3_200_times, 256 / 8, "SHA3-256 x4", 4 + i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
    return CRYPT_OK;
 #endif
 }
@@ -271,7 +294,10 @@ int sha3_shake_test(void)
 #ifndef LTC_TEST
    return CRYPT_NOP;
 #else
-   unsigned char buf[200], hash[512];
+   unsigned char buf[200], hash[512], hash4[4][512];
+   const unsigned char *in4[4];
+   unsigned long inlen4[4];
+   unsigned char *out4[4];
    int i;
    hash_state c;
    const unsigned char c1 = 0xa3;
@@ -384,6 +410,26 @@ int sha3_shake_test(void)
       return CRYPT_FAIL_TESTVECTOR;
    }
 
+   /* SHAKE128 and SHAKE256 of four messages at once, each squeezed to 512 bytes */
+   for (i = 0; i < 4; i++) {
+      in4[i] = buf;
+      inlen4[i] = sizeof(buf);
+      out4[i] = hash4[i];
+   }
+   sha3_shake_memory_x4(128, in4, inlen4, out4, sizeof(hash4[0]));
+   for (i = 0; i < 4; i++) {
+      if (compare_testvector(hash4[i] + 480, 32, shake128_0xa3_200_times, sizeof(shake128_0xa3_200_times), "SHAKE128 x4", i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   inlen4[0] = inlen4[2] = 0;
+   sha3_shake_memory_x4(256, in4, inlen4, out4, sizeof(hash4[0]));
+   for (i = 0; i < 4; i++) {
+      if (compare_testvector(hash4[i] + 480, 32, (i & 1) ? shake256_0xa3_200_times : shake256_empty, 32, "SHAKE256 x4", i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
    return CRYPT_OK;
 #endif
 }
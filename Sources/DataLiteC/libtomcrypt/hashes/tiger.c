@@ -25,7 +25,8 @@ const struct ltc_hash_descriptor tiger_desc =
     &tiger_process,
     &tiger_done,
     &tiger_test,
-    NULL
+    NULL,
+    &tiger_process_iov
 };
 
 const struct ltc_hash_descriptor tiger2_desc =
@@ -43,7 +44,8 @@ const struct ltc_hash_descriptor tiger2_desc =
     &tiger_process,
     &tiger_done,
     &tiger2_test,
-    NULL
+    NULL,
+    &tiger_process_iov
 };
 
 #define t1 (table)
@@ -735,6 +737,15 @@ int tiger2_init_ex(hash_state *md, unsigned long passes)
 */
 HASH_PROCESS(tiger_process, s_tiger_compress, tiger, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(tiger_process_iov, s_tiger_compress, tiger, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -866,7 +877,7 @@ static int s_tiger_test(unsigned int idx)
           return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(idx ? &tiger2_desc : &tiger_desc);
   #endif
 }
 
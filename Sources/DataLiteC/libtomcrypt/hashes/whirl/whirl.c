@@ -25,7 +25,8 @@ const struct ltc_hash_descriptor whirlpool_desc =
     &whirlpool_process,
     &whirlpool_done,
     &whirlpool_test,
-    NULL
+    NULL,
+    &whirlpool_process_iov
 };
 
 /* the sboxes */
@@ -136,6 +137,15 @@ int whirlpool_init(hash_state * md)
 */
 HASH_PROCESS(whirlpool_process, s_whirlpool_compress, whirlpool, 64)
 
+/**
+   Process several segments of data as if they were one contiguous buffer
+   @param md     The hash state
+   @param iov    The segments
+   @param iovcnt The number of segments
+   @return CRYPT_OK if successful
+*/
+HASH_PROCESS_IOV(whirlpool_process_iov, s_whirlpool_compress, whirlpool, 64)
+
 /**
    Terminate the hash to get the digest
    @param md  The hash state
@@ -289,7 +299,7 @@ int  whirlpool_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
-  return CRYPT_OK;
+  return hash_iov_test(&whirlpool_desc);
  #endif
 }
 
@@ -617,7 +617,7 @@ extern struct ltc_cipher_descriptor {
                       next tweak will be copied encrypted on output.
        @param skey1   The first scheduled key context
        @param skey2   The second scheduled key context
-       @return CRYPT_OK if successful
+       @return CRYPT_OK if successful, CRYPT_NOP to fall back to the generic code
     */
     int (*accel_xts_encrypt)(const unsigned char *pt, unsigned char *ct,
         unsigned long blocks, unsigned char *tweak,
@@ -632,7 +632,7 @@ extern struct ltc_cipher_descriptor {
                        next tweak will be copied encrypted on output.
         @param skey1   The first scheduled key context
         @param skey2   The second scheduled key context
-        @return CRYPT_OK if successful
+        @return CRYPT_OK if successful, CRYPT_NOP to fall back to the generic code
      */
      int (*accel_xts_decrypt)(const unsigned char *ct, unsigned char *pt,
          unsigned long blocks, unsigned char *tweak,
@@ -741,6 +741,23 @@ int aesni_is_supported(void);
 int aesni_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
 int aesni_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey);
 int aesni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey);
+int aesni_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+#if defined(LTC_CCM_MODE)
+int aesni_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                     symmetric_key       *uskey,
+                     const unsigned char *nonce,  unsigned long noncelen,
+                     const unsigned char *header, unsigned long headerlen,
+                           unsigned char *pt,     unsigned long ptlen,
+                           unsigned char *ct,
+                           unsigned char *tag,    unsigned long *taglen,
+                                     int  direction);
+#endif
+#if defined(LTC_XTS_MODE)
+int aesni_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                      const symmetric_key *skey1, const symmetric_key *skey2);
+int aesni_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                      const symmetric_key *skey1, const symmetric_key *skey2);
+#endif
 int aesni_test(void);
 void aesni_done(symmetric_key *skey);
 int aesni_keysize(int *keysize);
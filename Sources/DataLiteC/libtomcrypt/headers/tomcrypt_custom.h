@@ -176,6 +176,19 @@
 /* ---> Symmetric Block Ciphers <--- */
 #ifndef LTC_NO_CIPHERS
 
+/* Build AES as the only block cipher. symmetric_key is a union over the key
+ * schedules of all block ciphers, so this shrinks it from the ~4KB of the
+ * Twofish and Blowfish schedules to the ~0.5KB of the AES one, and with it
+ * every mode and MAC state that embeds it (symmetric_CBC, symmetric_CTR,
+ * gcm_state, omac_state, ...). The stream ciphers are not affected */
+/* #define LTC_AES_ONLY */
+
+#ifdef LTC_AES_ONLY
+
+#define LTC_RIJNDAEL
+
+#else
+
 #define LTC_BLOWFISH
 #define LTC_RC2
 #define LTC_RC5
@@ -211,6 +224,8 @@
 #define LTC_SERPENT
 #define LTC_TEA
 
+#endif /* LTC_AES_ONLY */
+
 /* stream ciphers */
 #define LTC_CHACHA
 #define LTC_SALSA20
@@ -222,6 +237,13 @@
 
 #endif /* LTC_NO_CIPHERS */
 
+/* AES-NI on x86_64, aes_desc and rijndael_desc fall back to the portable code
+ * at run-time if the CPU lacks it. Define LTC_NO_AES_NI to disable. */
+#if defined(LTC_RIJNDAEL) && !defined(LTC_AES_NI) && !defined(LTC_NO_AES_NI) && !defined(LTC_NO_ASM) && \
+    defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_AES_NI
+#endif
+
 
 /* ---> Block Cipher Modes of Operation <--- */
 #ifndef LTC_NO_MODES
@@ -273,6 +295,10 @@
 #define LTC_RIPEMD320
 #define LTC_BLAKE2S
 #define LTC_BLAKE2B
+/* The tree modes buffer a 512 byte stripe, which doubles the size of
+ * hash_state and with it that of every hmac_state, so they are opt-in */
+/* #define LTC_BLAKE2SP */
+/* #define LTC_BLAKE2BP */
 
 #define LTC_HASH_HELPERS
 
@@ -484,6 +510,12 @@
 #define LTC_PKCS_8
 #define LTC_PKCS_12
 
+/* Cache PBKDF2 results process-wide, keyed by H(salt || password), salt,
+ * hash and iteration count. Derived keys are kept in (best effort) mlock'ed
+ * memory and wiped on eviction, see pkcs_5_alg2_cache_config(). The package
+ * builds it in, disabled until configured (LTC_PKCS_5_CACHE_INITIAL_ENTRIES) */
+/* #define LTC_PKCS_5_CACHE */
+
 /* Include ASN.1 DER (required by DSA/RSA) */
 #define LTC_DER
 
@@ -501,7 +533,10 @@
 /* Base16/hex encoding/decoding */
 #define LTC_BASE16
 
+/* bcrypt is built on the Blowfish key schedule */
+#ifndef LTC_AES_ONLY
 #define LTC_BCRYPT
+#endif
 
 #ifndef LTC_BCRYPT_DEFAULT_ROUNDS
 #define LTC_BCRYPT_DEFAULT_ROUNDS 10
@@ -518,6 +553,8 @@
 
 #define LTC_CRC32
 
+#define LTC_CRC32C
+
 #define LTC_SSH
 
 #define LTC_PADDING
@@ -526,8 +563,60 @@
 
 #define LTC_PEM
 
+/* Per-descriptor call counts, octets processed, latency histograms and
+ * XMALLOC calls for the cipher, hash and PRNG tables, plus the library's
+ * XMALLOC calls in total, see crypt_stats_snapshot() and crypt_stats_value().
+ * Allocations are counted to the descriptor whose call made them, or to the
+ * hash that HMAC, PBKDF2 or HKDF made them for. Every instrumented call
+ * reads the monotonic clock, so this is meant for diagnostic builds, the
+ * package defines it for debug builds only */
+/* #define LTC_STATS */
+
+/* Serve the library's own allocations from a few (best effort) mlock'ed
+ * regions that are split into power-of-two size classes, and wipe every
+ * block when it is freed. The allocator is also exported as
+ * crypt_secmem_malloc() and friends for callers that keep key material.
+ * The package builds it in with the pool off until crypt_secmem_enable()
+ * (LTC_SECMEM_INITIAL_ENABLED), allocations are wiped on free either way */
+/* #define LTC_SECMEM */
+
 #endif /* LTC_NO_MISC */
 
+/* SSSE3/AVX2 base64 encoding and decoding on x86_64, the plain code is used
+ * at run-time if the CPU lacks SSSE3. Define LTC_NO_BASE64_SIMD to disable. */
+#if (defined(LTC_BASE64) || defined(LTC_BASE64_URL)) && !defined(LTC_BASE64_SIMD) && !defined(LTC_NO_BASE64_SIMD) && \
+    !defined(LTC_NO_ASM) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_BASE64_SIMD
+#endif
+
+/* SSSE3/AVX2 Adler-32 on x86_64, the plain code is used at run-time if the
+ * CPU lacks SSSE3. Define LTC_NO_ADLER32_SIMD to disable. */
+#if defined(LTC_ADLER32) && !defined(LTC_ADLER32_SIMD) && !defined(LTC_NO_ADLER32_SIMD) && \
+    !defined(LTC_NO_ASM) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_ADLER32_SIMD
+#endif
+
+/* AVX2 BLAKE2b and SSSE3 BLAKE2s compression and the AVX2 leaf kernels of BLAKE2bp and BLAKE2sp
+ * on x86_64, the plain code is used at run-time if the CPU lacks them. Define LTC_NO_BLAKE2_SIMD to disable. */
+#if (defined(LTC_BLAKE2S) || defined(LTC_BLAKE2B)) && !defined(LTC_BLAKE2_SIMD) && !defined(LTC_NO_BLAKE2_SIMD) && \
+    !defined(LTC_NO_ASM) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_BLAKE2_SIMD
+#endif
+
+/* PCLMULQDQ folding for CRC-32 and the SSE4.2 crc32 instruction for CRC-32C on x86_64,
+ * the table driven code is used at run-time if the CPU lacks them. Define LTC_NO_CRC32_ACCEL to disable. */
+#if (defined(LTC_CRC32) || defined(LTC_CRC32C)) && !defined(LTC_CRC32_ACCEL) && !defined(LTC_NO_CRC32_ACCEL) && \
+    !defined(LTC_NO_ASM) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_CRC32_ACCEL
+#endif
+
+/* AVX2 Keccak-f[1600] on four states for sha3_memory_x4() and sha3_shake_memory_x4() on x86_64,
+ * the four states are permuted one after the other if the CPU lacks AVX2. Define LTC_NO_SHA3_SIMD to disable. */
+#if defined(LTC_SHA3) && !defined(LTC_SHA3_SIMD) && !defined(LTC_NO_SHA3_SIMD) && \
+    !defined(LTC_NO_ASM) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+   #define LTC_SHA3_SIMD
+#endif
+
 /* cleanup */
 
 #ifdef LTC_MECC
@@ -575,6 +664,15 @@
    #ifndef LTC_FILE_READ_BUFSIZE
    #define LTC_FILE_READ_BUFSIZE 8192
    #endif
+   /* Map regular files into memory instead of reading them, on Unix-like
+    * systems. Only enable it if the library never processes a file that may
+    * be truncated meanwhile, e.g. a live database or WAL file: touching a
+    * mapped page beyond the new end of the file raises SIGBUS */
+   /* #define LTC_FILE_MMAP */
+   /* how much of a regular file is mapped into memory at a time */
+   #ifndef LTC_FILE_MMAP_WINDOW
+   #define LTC_FILE_MMAP_WINDOW (64uL * 1024uL * 1024uL)
+   #endif
 #endif
 
 #if defined(LTC_PEM)
@@ -597,6 +695,36 @@
    #endif
 #endif
 
+#if defined(LTC_SECMEM)
+   #ifndef LTC_SECMEM_REGION_SIZE
+      /* Size of one locked region, a multiple of the page size */
+      #define LTC_SECMEM_REGION_SIZE 262144
+   #endif
+   #ifndef LTC_SECMEM_REGIONS
+      /* Max. number of regions, allocations that don't fit go to XMALLOC */
+      #define LTC_SECMEM_REGIONS 4
+   #endif
+   #ifndef LTC_SECMEM_INITIAL_ENABLED
+      /* Whether the pool is used before crypt_secmem_enable() is called */
+      #define LTC_SECMEM_INITIAL_ENABLED 1
+   #endif
+#endif
+
+#if defined(LTC_PKCS_5_CACHE)
+   #ifndef LTC_PKCS_5_CACHE_ENTRIES
+      /* Max. number of cached derived keys */
+      #define LTC_PKCS_5_CACHE_ENTRIES 16
+   #endif
+   #ifndef LTC_PKCS_5_CACHE_TTL
+      /* Default lifetime of a cached derived key in seconds */
+      #define LTC_PKCS_5_CACHE_TTL 300
+   #endif
+   #ifndef LTC_PKCS_5_CACHE_INITIAL_ENTRIES
+      /* Entries in use until pkcs_5_alg2_cache_config() is called, 0 to start disabled */
+      #define LTC_PKCS_5_CACHE_INITIAL_ENTRIES LTC_PKCS_5_CACHE_ENTRIES
+   #endif
+#endif
+
 #if defined(LTC_DER)
    #ifndef LTC_DER_MAX_RECURSION
       /* Maximum recursion limit when processing nested ASN.1 types. */
@@ -650,6 +778,22 @@
    #error LTC_PKCS_5 requires LTC_HASH_HELPERS
 #endif
 
+#if defined(LTC_PKCS_5_CACHE) && !defined(LTC_PKCS_5)
+   #error LTC_PKCS_5_CACHE requires LTC_PKCS_5
+#endif
+
+#if defined(LTC_PKCS_5_CACHE) && !defined(LTC_PTHREAD)
+   #error LTC_PKCS_5_CACHE requires LTC_PTHREAD
+#endif
+
+#if defined(LTC_PKCS_5_CACHE) && LTC_PKCS_5_CACHE_INITIAL_ENTRIES > LTC_PKCS_5_CACHE_ENTRIES
+   #error LTC_PKCS_5_CACHE_INITIAL_ENTRIES must not exceed LTC_PKCS_5_CACHE_ENTRIES
+#endif
+
+#if defined(LTC_SECMEM) && !defined(LTC_PTHREAD)
+   #error LTC_SECMEM requires LTC_PTHREAD
+#endif
+
 #if defined(LTC_PELICAN) && !defined(LTC_RIJNDAEL)
    #error Pelican-MAC requires LTC_RIJNDAEL
 #endif
@@ -702,6 +846,14 @@
    #error LTC_BLAKE2BMAC requires LTC_BLAKE2B
 #endif
 
+#if defined(LTC_BLAKE2SP) && !defined(LTC_BLAKE2S)
+   #error LTC_BLAKE2SP requires LTC_BLAKE2S
+#endif
+
+#if defined(LTC_BLAKE2BP) && !defined(LTC_BLAKE2B)
+   #error LTC_BLAKE2BP requires LTC_BLAKE2B
+#endif
+
 #if defined(LTC_SPRNG) && !defined(LTC_RNG_GET_BYTES)
    #error LTC_SPRNG requires LTC_RNG_GET_BYTES
 #endif
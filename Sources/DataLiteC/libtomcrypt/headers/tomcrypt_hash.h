@@ -141,6 +141,26 @@ struct blake2b_state {
 };
 #endif
 
+#ifdef LTC_BLAKE2SP
+struct blake2sp_state {
+    ulong32 h[8][8];                /* word i of the chaining value of leaf j is h[i][j] */
+    ulong64 t[8];
+    unsigned char buf[512];
+    unsigned long curlen;
+    int pending;                    /* the blocks from curlen on are the last stripe */
+};
+#endif
+
+#ifdef LTC_BLAKE2BP
+struct blake2bp_state {
+    ulong64 h[8][4];                /* word i of the chaining value of leaf j is h[i][j] */
+    ulong64 t[4];
+    unsigned char buf[512];
+    unsigned long curlen;
+    int pending;                    /* the blocks from curlen on are the last stripe */
+};
+#endif
+
 typedef union Hash_state {
     char dummy[1];
 #ifdef LTC_CHC_HASH
@@ -191,10 +211,22 @@ typedef union Hash_state {
 #ifdef LTC_BLAKE2B
     struct blake2b_state blake2b;
 #endif
+#ifdef LTC_BLAKE2SP
+    struct blake2sp_state blake2sp;
+#endif
+#ifdef LTC_BLAKE2BP
+    struct blake2bp_state blake2bp;
+#endif
 
     void *data;
 } hash_state;
 
+/** One segment of a scatter-gather input, see hash_memory_iov() */
+typedef struct {
+    const unsigned char *in;
+    unsigned long        inlen;
+} ltc_iovec;
+
 /** hash descriptor */
 extern  struct ltc_hash_descriptor {
     /** name of hash */
@@ -238,6 +270,14 @@ extern  struct ltc_hash_descriptor {
                        const unsigned char *in,  unsigned long  inlen,
                              unsigned char *out, unsigned long *outlen);
 
+    /** Process several segments of data as if they were one contiguous buffer, may be NULL
+      @param hash    The hash state
+      @param iov     The segments
+      @param iovcnt  The number of segments
+      @return CRYPT_OK if successful
+    */
+    int (*process_iov)(hash_state *hash, const ltc_iovec *iov, unsigned long iovcnt);
+
 } hash_descriptor[];
 
 #ifdef LTC_CHC_HASH
@@ -252,6 +292,7 @@ extern const struct ltc_hash_descriptor chc_desc;
 #ifdef LTC_WHIRLPOOL
 int whirlpool_init(hash_state * md);
 int whirlpool_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int whirlpool_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int whirlpool_done(hash_state * md, unsigned char *out);
 int whirlpool_test(void);
 extern const struct ltc_hash_descriptor whirlpool_desc;
@@ -283,6 +324,9 @@ int sha3_shake_init(hash_state *md, int num);
 int sha3_shake_done(hash_state *md, unsigned char *out, unsigned long outlen);
 int sha3_shake_test(void);
 int sha3_shake_memory(int num, const unsigned char *in, unsigned long inlen, unsigned char *out, const unsigned long *outlen);
+/* four independent messages at once */
+int sha3_memory_x4(int num, const unsigned char *const in[4], const unsigned long inlen[4], unsigned char *const out[4]);
+int sha3_shake_memory_x4(int num, const unsigned char *const in[4], const unsigned long inlen[4], unsigned char *const out[4], unsigned long outlen);
 #endif
 
 #ifdef LTC_KECCAK
@@ -305,6 +349,7 @@ int keccak_done(hash_state *md, unsigned char *out);
 #ifdef LTC_SHA512
 int sha512_init(hash_state * md);
 int sha512_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int sha512_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int sha512_done(hash_state * md, unsigned char *out);
 int sha512_test(void);
 extern const struct ltc_hash_descriptor sha512_desc;
@@ -316,6 +361,7 @@ extern const struct ltc_hash_descriptor sha512_desc;
 #endif
 int sha384_init(hash_state * md);
 #define sha384_process sha512_process
+#define sha384_process_iov sha512_process_iov
 int sha384_done(hash_state * md, unsigned char *out);
 int sha384_test(void);
 extern const struct ltc_hash_descriptor sha384_desc;
@@ -327,6 +373,7 @@ extern const struct ltc_hash_descriptor sha384_desc;
 #endif
 int sha512_256_init(hash_state * md);
 #define sha512_256_process sha512_process
+#define sha512_256_process_iov sha512_process_iov
 int sha512_256_done(hash_state * md, unsigned char *out);
 int sha512_256_test(void);
 extern const struct ltc_hash_descriptor sha512_256_desc;
@@ -338,6 +385,7 @@ extern const struct ltc_hash_descriptor sha512_256_desc;
 #endif
 int sha512_224_init(hash_state * md);
 #define sha512_224_process sha512_process
+#define sha512_224_process_iov sha512_process_iov
 int sha512_224_done(hash_state * md, unsigned char *out);
 int sha512_224_test(void);
 extern const struct ltc_hash_descriptor sha512_224_desc;
@@ -346,6 +394,7 @@ extern const struct ltc_hash_descriptor sha512_224_desc;
 #ifdef LTC_SHA256
 int sha256_init(hash_state * md);
 int sha256_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int sha256_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int sha256_done(hash_state * md, unsigned char *out);
 int sha256_test(void);
 extern const struct ltc_hash_descriptor sha256_desc;
@@ -356,6 +405,7 @@ extern const struct ltc_hash_descriptor sha256_desc;
 #endif
 int sha224_init(hash_state * md);
 #define sha224_process sha256_process
+#define sha224_process_iov sha256_process_iov
 int sha224_done(hash_state * md, unsigned char *out);
 int sha224_test(void);
 extern const struct ltc_hash_descriptor sha224_desc;
@@ -365,6 +415,7 @@ extern const struct ltc_hash_descriptor sha224_desc;
 #ifdef LTC_SHA1
 int sha1_init(hash_state * md);
 int sha1_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int sha1_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int sha1_done(hash_state * md, unsigned char *out);
 int sha1_test(void);
 extern const struct ltc_hash_descriptor sha1_desc;
@@ -414,9 +465,26 @@ int blake2b_process(hash_state * md, const unsigned char *in, unsigned long inle
 int blake2b_done(hash_state * md, unsigned char *out);
 #endif
 
+#ifdef LTC_BLAKE2SP
+extern const struct ltc_hash_descriptor blake2sp_256_desc;
+int blake2sp_256_init(hash_state * md);
+int blake2sp_256_test(void);
+int blake2sp_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int blake2sp_done(hash_state * md, unsigned char *out);
+#endif
+
+#ifdef LTC_BLAKE2BP
+extern const struct ltc_hash_descriptor blake2bp_512_desc;
+int blake2bp_512_init(hash_state * md);
+int blake2bp_512_test(void);
+int blake2bp_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int blake2bp_done(hash_state * md, unsigned char *out);
+#endif
+
 #ifdef LTC_MD5
 int md5_init(hash_state * md);
 int md5_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int md5_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int md5_done(hash_state * md, unsigned char *out);
 int md5_test(void);
 extern const struct ltc_hash_descriptor md5_desc;
@@ -425,6 +493,7 @@ extern const struct ltc_hash_descriptor md5_desc;
 #ifdef LTC_MD4
 int md4_init(hash_state * md);
 int md4_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int md4_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int md4_done(hash_state * md, unsigned char *out);
 int md4_test(void);
 extern const struct ltc_hash_descriptor md4_desc;
@@ -442,11 +511,13 @@ extern const struct ltc_hash_descriptor md2_desc;
 int tiger_init(hash_state * md);
 int tiger_init_ex(hash_state *md, unsigned long passes);
 int tiger_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int tiger_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int tiger_done(hash_state * md, unsigned char *out);
 int tiger_test(void);
 int tiger2_init(hash_state *md);
 int tiger2_init_ex(hash_state *md, unsigned long passes);
 #define tiger2_process(m, i, l) tiger_process(m, i, l)
+#define tiger2_process_iov(m, v, c) tiger_process_iov(m, v, c)
 #define tiger2_done(m, o)       tiger_done(m, o)
 int tiger2_test(void);
 extern const struct ltc_hash_descriptor tiger_desc, tiger2_desc;
@@ -455,6 +526,7 @@ extern const struct ltc_hash_descriptor tiger_desc, tiger2_desc;
 #ifdef LTC_RIPEMD128
 int rmd128_init(hash_state * md);
 int rmd128_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int rmd128_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int rmd128_done(hash_state * md, unsigned char *out);
 int rmd128_test(void);
 extern const struct ltc_hash_descriptor rmd128_desc;
@@ -463,6 +535,7 @@ extern const struct ltc_hash_descriptor rmd128_desc;
 #ifdef LTC_RIPEMD160
 int rmd160_init(hash_state * md);
 int rmd160_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int rmd160_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int rmd160_done(hash_state * md, unsigned char *out);
 int rmd160_test(void);
 extern const struct ltc_hash_descriptor rmd160_desc;
@@ -471,6 +544,7 @@ extern const struct ltc_hash_descriptor rmd160_desc;
 #ifdef LTC_RIPEMD256
 int rmd256_init(hash_state * md);
 int rmd256_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int rmd256_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int rmd256_done(hash_state * md, unsigned char *out);
 int rmd256_test(void);
 extern const struct ltc_hash_descriptor rmd256_desc;
@@ -479,6 +553,7 @@ extern const struct ltc_hash_descriptor rmd256_desc;
 #ifdef LTC_RIPEMD320
 int rmd320_init(hash_state * md);
 int rmd320_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int rmd320_process_iov(hash_state * md, const ltc_iovec *iov, unsigned long iovcnt);
 int rmd320_done(hash_state * md, unsigned char *out);
 int rmd320_test(void);
 extern const struct ltc_hash_descriptor rmd320_desc;
@@ -502,6 +577,9 @@ int hash_memory(int hash,
 int hash_memory_multi(int hash, unsigned char *out, unsigned long *outlen,
                       const unsigned char *in, unsigned long inlen, ...)
                       LTC_NULL_TERMINATED;
+int hash_memory_iov(int hash,
+                    const ltc_iovec *iov, unsigned long iovcnt,
+                          unsigned char *out, unsigned long *outlen);
 
 #ifndef LTC_NO_FILE
 int hash_filehandle(int hash, FILE *in, unsigned char *out, unsigned long *outlen);
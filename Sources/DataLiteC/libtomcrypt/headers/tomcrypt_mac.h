@@ -10,6 +10,7 @@ typedef struct Hmac_state {
 
 int hmac_init(hmac_state *hmac, int hash, const unsigned char *key, unsigned long keylen);
 int hmac_process(hmac_state *hmac, const unsigned char *in, unsigned long inlen);
+int hmac_process_iov(hmac_state *hmac, const ltc_iovec *iov, unsigned long iovcnt);
 int hmac_done(hmac_state *hmac, unsigned char *out, unsigned long *outlen);
 int hmac_test(void);
 int hmac_memory(int hash,
@@ -21,6 +22,10 @@ int hmac_memory_multi(int hash,
                       unsigned char *out,  unsigned long *outlen,
                 const unsigned char *in,   unsigned long inlen, ...)
                 LTC_NULL_TERMINATED;
+int hmac_memory_iov(int hash,
+                const unsigned char *key,  unsigned long keylen,
+                const ltc_iovec     *iov,  unsigned long iovcnt,
+                      unsigned char *out,  unsigned long *outlen);
 int hmac_file(int hash, const char *fname, const unsigned char *key,
               unsigned long keylen,
               unsigned char *out, unsigned long *outlen);
@@ -137,6 +137,62 @@ void crc32_finish(const crc32_state *ctx, void *hash, unsigned long size);
 int crc32_test(void);
 #endif
 
+#ifdef LTC_CRC32C
+typedef struct crc32c_state_s
+{
+   ulong32 crc;
+} crc32c_state;
+
+void crc32c_init(crc32c_state *ctx);
+void crc32c_update(crc32c_state *ctx, const unsigned char *input, unsigned long length);
+void crc32c_finish(const crc32c_state *ctx, void *hash, unsigned long size);
+int crc32c_test(void);
+#endif
+
+#ifdef LTC_STATS
+/* Number of latency histogram buckets */
+#define LTC_STATS_BUCKETS 32
+
+typedef struct {
+   /** Number of calls */
+   ulong64 calls;
+   /** Number of octets processed by the calls */
+   ulong64 bytes;
+   /** Total time spent in the calls (nanoseconds) */
+   ulong64 nsec;
+   /** Bucket 0 counts calls that took no measurable time, bucket n those of [2^(n-1), 2^n) ns */
+   ulong64 histogram[LTC_STATS_BUCKETS];
+   /** Allocations made through XMALLOC, XCALLOC and XREALLOC during the calls,
+    *  or by HMAC, PBKDF2 and the like on behalf of the hash */
+   ulong64 allocations;
+   ulong64 allocated_bytes;
+} ltc_stats_counter;
+
+typedef struct {
+   /** Indexed like cipher_descriptor[], hash_descriptor[] and prng_descriptor[] */
+   ltc_stats_counter cipher[TAB_SIZE];
+   ltc_stats_counter hash[TAB_SIZE];
+   ltc_stats_counter prng[TAB_SIZE];
+   /** All allocations made by the library through XMALLOC, XCALLOC and XREALLOC */
+   ulong64 allocations;
+   ulong64 allocated_bytes;
+} ltc_stats;
+
+int crypt_stats_snapshot(ltc_stats *stats);
+#endif
+/* also present without LTC_STATS, so callers don't depend on the build option */
+int crypt_stats_value(const char *kind, const char *name, const char *counter, ulong64 *value);
+void crypt_stats_reset(void);
+
+#ifdef LTC_SECMEM
+void *crypt_secmem_malloc(size_t n);
+void *crypt_secmem_calloc(size_t n, size_t s);
+void *crypt_secmem_realloc(void *p, size_t n);
+void crypt_secmem_free(void *p);
+void crypt_secmem_enable(int enable);
+int crypt_secmem_usage(unsigned long *locked, unsigned long *in_use, unsigned long *fallback);
+#endif
+
 
 #ifdef LTC_PADDING
 
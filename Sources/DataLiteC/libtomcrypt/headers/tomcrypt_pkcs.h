@@ -96,6 +96,13 @@ int pkcs_5_alg2(const unsigned char *password, unsigned long password_len,
                 int iteration_count,           int hash_idx,
                 unsigned char *out,            unsigned long *outlen);
 
+#ifdef LTC_PKCS_5_CACHE
+/* Process-wide cache of PBKDF2 results */
+int pkcs_5_alg2_cache_config(unsigned long entries, unsigned long ttl);
+void pkcs_5_alg2_cache_purge(void);
+int pkcs_5_alg2_cache_status(unsigned long *hits, unsigned long *misses, int reset);
+#endif
+
 int pkcs_5_test (void);
 #endif  /* LTC_PKCS_5 */
 
@@ -132,21 +132,9 @@ int blowfish_setup_with_data(const unsigned char *key, int keylen,
 
 /* tomcrypt_hash.h */
 
-/* a simple macro for making hash "process" functions */
-#define HASH_PROCESS(func_name, compress_name, state_var, block_size)                       \
-int func_name (hash_state * md, const unsigned char *in, unsigned long inlen)               \
-{                                                                                           \
-    unsigned long n;                                                                        \
-    int           err;                                                                      \
-    LTC_ARGCHK(md != NULL);                                                                 \
-    LTC_ARGCHK(in != NULL);                                                                 \
-    if (md-> state_var .curlen > sizeof(md-> state_var .buf)) {                             \
-       return CRYPT_INVALID_ARG;                                                            \
-    }                                                                                       \
-    if (((md-> state_var .length + inlen * 8) < md-> state_var .length)                     \
-          || ((inlen * 8) < inlen)) {                                                       \
-      return CRYPT_HASH_OVERFLOW;                                                           \
-    }                                                                                       \
+/* the block loop of the "process" functions, feeds whole blocks of `in` to the compression
+ * function directly and collects everything else in the state's buffer */
+#define HASH_PROCESS_BLOCKS(compress_name, state_var, block_size)                          \
     while (inlen > 0) {                                                                     \
         if (md-> state_var .curlen == 0 && inlen >= block_size) {                           \
            if ((err = compress_name (md, in)) != CRYPT_OK) {                                \
@@ -169,10 +157,81 @@ int func_name (hash_state * md, const unsigned char *in, unsigned long inlen)
               md-> state_var .curlen = 0;                                                   \
            }                                                                                \
        }                                                                                    \
+    }
+
+/* a simple macro for making hash "process" functions */
+#define HASH_PROCESS(func_name, compress_name, state_var, block_size)                       \
+int func_name (hash_state * md, const unsigned char *in, unsigned long inlen)               \
+{                                                                                           \
+    unsigned long n;                                                                        \
+    int           err;                                                                      \
+    LTC_ARGCHK(md != NULL);                                                                 \
+    LTC_ARGCHK(in != NULL);                                                                 \
+    if (md-> state_var .curlen > sizeof(md-> state_var .buf)) {                             \
+       return CRYPT_INVALID_ARG;                                                            \
+    }                                                                                       \
+    if (((md-> state_var .length + inlen * 8) < md-> state_var .length)                     \
+          || ((inlen * 8) < inlen)) {                                                       \
+      return CRYPT_HASH_OVERFLOW;                                                           \
+    }                                                                                       \
+    HASH_PROCESS_BLOCKS(compress_name, state_var, block_size)                               \
+    return CRYPT_OK;                                                                        \
+}
+
+/* the same for the "process_iov" functions, a segment only goes through the buffer
+ * as far as it doesn't start or end on a block boundary */
+#define HASH_PROCESS_IOV(func_name, compress_name, state_var, block_size)                   \
+int func_name (hash_state * md, const ltc_iovec *iov, unsigned long iovcnt)                 \
+{                                                                                           \
+    const unsigned char *in;                                                                \
+    unsigned long n, i, inlen, total;                                                       \
+    int           err;                                                                      \
+    LTC_ARGCHK(md != NULL);                                                                 \
+    LTC_ARGCHK(iov != NULL || iovcnt == 0);                                                 \
+    if (md-> state_var .curlen > sizeof(md-> state_var .buf)) {                             \
+       return CRYPT_INVALID_ARG;                                                            \
+    }                                                                                       \
+    for (i = 0, total = 0; i < iovcnt; i++) {                                               \
+       LTC_ARGCHK(iov[i].in != NULL);                                                       \
+       if (total + iov[i].inlen < total) {                                                  \
+          return CRYPT_HASH_OVERFLOW;                                                       \
+       }                                                                                    \
+       total += iov[i].inlen;                                                               \
+    }                                                                                       \
+    if (((md-> state_var .length + total * 8) < md-> state_var .length)                     \
+          || ((total * 8) < total)) {                                                       \
+      return CRYPT_HASH_OVERFLOW;                                                           \
+    }                                                                                       \
+    for (i = 0; i < iovcnt; i++) {                                                          \
+       in    = iov[i].in;                                                                   \
+       inlen = iov[i].inlen;                                                                \
+       HASH_PROCESS_BLOCKS(compress_name, state_var, block_size)                            \
     }                                                                                       \
     return CRYPT_OK;                                                                        \
 }
 
+#ifdef LTC_TEST
+int hash_iov_test(const struct ltc_hash_descriptor *desc);
+#endif
+
+#ifdef LTC_BLAKE2S
+int blake2s_init_param(hash_state *md, const unsigned char *P);
+int blake2s_compress_block(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f);
+#endif
+#ifdef LTC_BLAKE2B
+int blake2b_init_param(hash_state *md, const unsigned char *P);
+int blake2b_compress_block(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f);
+#endif
+#if defined(LTC_BLAKE2_SIMD)
+int blake2s_simd_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f);
+int blake2b_simd_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f);
+int blake2sp_simd_compress8(ulong32 h[8][8], const unsigned char *in, const ulong64 *t);
+int blake2bp_simd_compress4(ulong64 h[8][4], const unsigned char *in, const ulong64 *t);
+#endif
+#if defined(LTC_SHA3_SIMD)
+int sha3_simd_keccakf_x4(ulong64 s[25][4]);
+#endif
+
 
 /* tomcrypt_mac.h */
 
@@ -266,6 +325,11 @@ int base64_encode_pem(const unsigned char *in,  unsigned long inlen,
                                      char *out, unsigned long *outlen,
                             unsigned int  flags);
 
+#if defined(LTC_BASE64_SIMD)
+unsigned long base64_simd_encode(const unsigned char *in, unsigned long inlen, char *out, int url);
+unsigned long base64_simd_decode(const char *in, unsigned long inlen, unsigned char *out, unsigned long outlen, int url);
+#endif
+
 /* PEM related */
 
 #ifdef LTC_PEM
@@ -365,6 +429,13 @@ struct get_char {
 void copy_or_zeromem(const unsigned char* src, unsigned char* dest, unsigned long len, int coz);
 void password_free(struct password *pw, const struct password_ctx *ctx);
 
+#ifndef LTC_NO_FILE
+typedef int (*file_process_fn)(void *ctx, const unsigned char *in, unsigned long inlen);
+int file_process(FILE *in, file_process_fn process, void *ctx);
+int file_process_name(const char *fname, file_process_fn process, void *ctx);
+int file_process_test(void);
+#endif /* LTC_NO_FILE */
+
 #if defined(LTC_PBES)
 int pbes_decrypt(const pbes_arg  *arg, unsigned char *dec_data, unsigned long *dec_size);
 
@@ -386,6 +457,46 @@ int pem_get_char_from_buf(struct get_char *g);
 int pem_read(void *pem, unsigned long *w, struct pem_headers *hdr, struct get_char *g);
 #endif
 
+#ifdef LTC_STATS
+ltc_stats *crypt_stats_thread(void);
+ulong64 crypt_stats_clock(void);
+void crypt_stats_record(ltc_stats_counter *counter, ulong64 bytes, ulong64 start);
+void crypt_stats_enter(ltc_stats_counter *counter);
+void crypt_stats_leave(void);
+
+void crypt_stats_wrap_cipher(int idx);
+void crypt_stats_wrap_hash(int idx);
+void crypt_stats_wrap_prng(int idx);
+const struct ltc_cipher_descriptor *crypt_stats_registered_cipher(int idx);
+const struct ltc_hash_descriptor *crypt_stats_registered_hash(int idx);
+const struct ltc_prng_descriptor *crypt_stats_registered_prng(int idx);
+
+void *crypt_stats_malloc(size_t n);
+void *crypt_stats_calloc(size_t n, size_t s);
+void *crypt_stats_realloc(void *p, size_t n);
+
+/* account the allocations in between to a descriptor, for those made on its behalf outside of its own calls */
+#define LTC_STATS_ENTER(table, idx) \
+   crypt_stats_enter((idx) >= 0 && (idx) < TAB_SIZE ? &crypt_stats_thread()->table[idx] : NULL)
+#define LTC_STATS_LEAVE()           crypt_stats_leave()
+#else
+#define LTC_STATS_ENTER(table, idx) LTC_UNUSED_PARAM(idx)
+#define LTC_STATS_LEAVE()
+#endif
+
+#if defined(LTC_AES_NI) || defined(LTC_BASE64_SIMD) || defined(LTC_ADLER32_SIMD) || \
+    defined(LTC_BLAKE2_SIMD) || defined(LTC_CRC32_ACCEL) || defined(LTC_SHA3_SIMD)
+#define LTC_CPU_FEATURES
+/* bits of ltc_cpu_features(), AVX2 is only reported if the OS saves the YMM state */
+#define LTC_CPU_SSSE3   0x01u
+#define LTC_CPU_SSE41   0x02u
+#define LTC_CPU_SSE42   0x04u
+#define LTC_CPU_PCLMUL  0x08u
+#define LTC_CPU_AESNI   0x10u
+#define LTC_CPU_AVX2    0x20u
+unsigned int ltc_cpu_features(void);
+#endif
+
 /* tomcrypt_pk.h */
 
 int rand_bn_bits(void *N, int bits, prng_state *prng, int wprng);
@@ -679,6 +790,19 @@ int pkcs12_kdf(               int   hash_id,
 
 #endif  /* LTC_PKCS_12 */
 
+#ifdef LTC_PKCS_5_CACHE
+
+int pkcs_5_alg2_cache_get(const unsigned char *password, unsigned long password_len,
+                          const unsigned char *salt,     unsigned long salt_len,
+                          int iteration_count,           int hash_idx,
+                          unsigned char *out,            unsigned long outlen);
+void pkcs_5_alg2_cache_put(const unsigned char *password, unsigned long password_len,
+                           const unsigned char *salt,     unsigned long salt_len,
+                           int iteration_count,           int hash_idx,
+                           const unsigned char *key,      unsigned long keylen);
+
+#endif  /* LTC_PKCS_5_CACHE */
+
 /* tomcrypt_prng.h */
 
 #define LTC_PRNG_EXPORT(which) \
@@ -721,4 +845,26 @@ int which ## _export(unsigned char *out, unsigned long *outlen, prng_state *prng
    #endif
 #endif
 
+/* With LTC_SECMEM the library's own allocations come from the locked pool */
+#if defined(LTC_SECMEM) && !defined(LTC_SECMEM_REAL_ALLOC)
+   #undef XMALLOC
+   #undef XCALLOC
+   #undef XREALLOC
+   #undef XFREE
+   #define XMALLOC  crypt_secmem_malloc
+   #define XCALLOC  crypt_secmem_calloc
+   #define XREALLOC crypt_secmem_realloc
+   #define XFREE    crypt_secmem_free
+#endif
+
+/* With LTC_STATS count the library's own allocations, crypt_stats.c forwards to the allocator set up above */
+#if defined(LTC_STATS) && !defined(LTC_STATS_REAL_ALLOC)
+   #undef XMALLOC
+   #undef XCALLOC
+   #undef XREALLOC
+   #define XMALLOC  crypt_stats_malloc
+   #define XCALLOC  crypt_stats_calloc
+   #define XREALLOC crypt_stats_realloc
+#endif
+
 #endif /* TOMCRYPT_PRIVATE_H_ */
@@ -9,6 +9,13 @@
 
 #ifdef LTC_F9_MODE
 
+#ifndef LTC_NO_FILE
+static int s_f9_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return f9_process(ctx, in, inlen);
+}
+#endif
+
 /**
    f9 a file
    @param cipher   The index of the cipher desired
@@ -33,53 +40,26 @@ int f9_file(int cipher,
    LTC_UNUSED_PARAM(outlen);
    return CRYPT_NOP;
 #else
-   size_t x;
-   int err;
    f9_state f9;
-   FILE *in;
-   unsigned char *buf;
+   int err;
 
    LTC_ARGCHK(key    != NULL);
    LTC_ARGCHK(fname  != NULL);
    LTC_ARGCHK(out    != NULL);
    LTC_ARGCHK(outlen != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = f9_init(&f9, cipher, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   in = fopen(fname, "rb");
-   if (in == NULL) {
-      err = CRYPT_FILE_NOTFOUND;
+   if ((err = file_process_name(fname, s_f9_file_process, &f9)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = f9_process(&f9, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
-
-   if (fclose(in) != 0) {
-      err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
-   }
-
    err = f9_done(&f9, out, outlen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&f9, sizeof(f9_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
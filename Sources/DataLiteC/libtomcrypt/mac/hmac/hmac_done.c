@@ -37,8 +37,10 @@ int hmac_done(hmac_state *hmac, unsigned char *out, unsigned long *outlen)
     hashsize = hash_descriptor[hash].hashsize;
 
     /* allocate buffers */
+    LTC_STATS_ENTER(hash, hash);
     buf  = XMALLOC(LTC_HMAC_BLOCKSIZE);
     isha = XMALLOC(hashsize);
+    LTC_STATS_LEAVE();
     if (buf == NULL || isha == NULL) {
        if (buf != NULL) {
           XFREE(buf);
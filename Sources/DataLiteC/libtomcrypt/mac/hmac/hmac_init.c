@@ -42,7 +42,9 @@ int hmac_init(hmac_state *hmac, int hash, const unsigned char *key, unsigned lon
     }
 
     /* allocate ram for buf */
+    LTC_STATS_ENTER(hash, hash);
     buf = XMALLOC(LTC_HMAC_BLOCKSIZE);
+    LTC_STATS_LEAVE();
     if (buf == NULL) {
        return CRYPT_MEM;
     }
@@ -45,7 +45,9 @@ int hmac_memory(int hash,
 
     /* nope, so call the hmac functions */
     /* allocate ram for hmac state */
+    LTC_STATS_ENTER(hash, hash);
     hmac = XMALLOC(sizeof(hmac_state));
+    LTC_STATS_LEAVE();
     if (hmac == NULL) {
        return CRYPT_MEM;
     }
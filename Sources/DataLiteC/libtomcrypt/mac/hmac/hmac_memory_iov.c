@@ -0,0 +1,62 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file hmac_memory_iov.c
+  HMAC support, process a scatter-gather list of memory
+*/
+
+#ifdef LTC_HMAC
+
+/**
+   HMAC several segments of memory to produce the authentication tag, like hmac_memory_multi()
+   but with a list of segments that can be built at run-time
+   @param hash      The index of the hash to use
+   @param key       The secret key
+   @param keylen    The length of the secret key (octets)
+   @param iov       The segments to HMAC
+   @param iovcnt    The number of segments
+   @param out       [out] Destination of the authentication tag
+   @param outlen    [in/out] Max size and resulting size of authentication tag
+   @return CRYPT_OK if successful
+*/
+int hmac_memory_iov(int hash,
+                const unsigned char *key,  unsigned long keylen,
+                const ltc_iovec     *iov,  unsigned long iovcnt,
+                      unsigned char *out,  unsigned long *outlen)
+{
+    hmac_state *hmac;
+    int         err;
+
+    LTC_ARGCHK(key    != NULL);
+    LTC_ARGCHK(iov    != NULL || iovcnt == 0);
+    LTC_ARGCHK(out    != NULL);
+    LTC_ARGCHK(outlen != NULL);
+
+    /* allocate ram for hmac state */
+    LTC_STATS_ENTER(hash, hash);
+    hmac = XMALLOC(sizeof(hmac_state));
+    LTC_STATS_LEAVE();
+    if (hmac == NULL) {
+       return CRYPT_MEM;
+    }
+
+    if ((err = hmac_init(hmac, hash, key, keylen)) != CRYPT_OK) {
+       goto LBL_ERR;
+    }
+    if ((err = hmac_process_iov(hmac, iov, iovcnt)) != CRYPT_OK) {
+       goto LBL_ERR;
+    }
+    if ((err = hmac_done(hmac, out, outlen)) != CRYPT_OK) {
+       goto LBL_ERR;
+    }
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(hmac, sizeof(hmac_state));
+#endif
+   XFREE(hmac);
+   return err;
+}
+
+#endif
@@ -39,7 +39,9 @@ int hmac_memory_multi(int hash,
     LTC_ARGCHK(outlen != NULL);
 
     /* allocate ram for hmac state */
+    LTC_STATS_ENTER(hash, hash);
     hmac = XMALLOC(sizeof(hmac_state));
+    LTC_STATS_LEAVE();
     if (hmac == NULL) {
        return CRYPT_MEM;
     }
@@ -0,0 +1,39 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file hmac_process_iov.c
+  HMAC support, process several segments of data
+*/
+
+#ifdef LTC_HMAC
+
+/**
+  Process several segments of data through HMAC, as if they were one contiguous buffer
+  @param hmac    The hmac state
+  @param iov     The segments to send through HMAC
+  @param iovcnt  The number of segments
+  @return CRYPT_OK if successful
+*/
+int hmac_process_iov(hmac_state *hmac, const ltc_iovec *iov, unsigned long iovcnt)
+{
+    unsigned long x;
+    int err;
+    LTC_ARGCHK(hmac != NULL);
+    LTC_ARGCHK(iov != NULL || iovcnt == 0);
+    if ((err = hash_is_valid(hmac->hash)) != CRYPT_OK) {
+        return err;
+    }
+    if (hash_descriptor[hmac->hash].process_iov != NULL) {
+        return hash_descriptor[hmac->hash].process_iov(&hmac->md, iov, iovcnt);
+    }
+    for (x = 0; x < iovcnt; x++) {
+        if ((err = hash_descriptor[hmac->hash].process(&hmac->md, iov[x].in, iov[x].inlen)) != CRYPT_OK) {
+            return err;
+        }
+    }
+    return CRYPT_OK;
+}
+
+#endif
@@ -584,7 +584,8 @@ int hmac_test(void)
 
     };
 
-    unsigned long outlen;
+    unsigned long outlen, off, n, len[5];
+    ltc_iovec iov[6];
     int err;
     int tested=0,failed=0;
     for(i=0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
@@ -602,6 +603,31 @@ int hmac_test(void)
         if(compare_testvector(digest, outlen, cases[i].digest, (size_t)hash_descriptor[hash].hashsize, cases[i].num, i)) {
             failed++;
         }
+
+        /* again through hmac_memory_iov(), in segments that are empty or straddle a block boundary */
+        len[0] = 0;
+        len[1] = 1;
+        len[2] = 0;
+        len[3] = hash_descriptor[hash].blocksize - 1;
+        len[4] = hash_descriptor[hash].blocksize + 1;
+        for (n = 0, off = 0; n < 5; n++) {
+            iov[n].in    = cases[i].data + off;
+            iov[n].inlen = MIN(len[n], cases[i].datalen - off);
+            off += iov[n].inlen;
+        }
+        iov[5].in    = cases[i].data + off;
+        iov[5].inlen = cases[i].datalen - off;
+        outlen = sizeof(digest);
+        if((err = hmac_memory_iov(hash, cases[i].key, cases[i].keylen, iov, 6, digest, &outlen)) != CRYPT_OK) {
+#ifdef LTC_TEST_DBG
+            printf("HMAC-%s test %s (iov), %s\n", cases[i].algo, cases[i].num, error_to_string(err));
+#endif
+            return err;
+        }
+
+        if(compare_testvector(digest, outlen, cases[i].digest, (size_t)hash_descriptor[hash].hashsize, cases[i].num, i)) {
+            failed++;
+        }
     }
 
     if (failed != 0) {
@@ -9,6 +9,13 @@
 
 #ifdef LTC_OMAC
 
+#ifndef LTC_NO_FILE
+static int s_omac_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return omac_process(ctx, in, inlen);
+}
+#endif
+
 /**
    OMAC a file
    @param cipher   The index of the cipher desired
@@ -33,53 +40,26 @@ int omac_file(int cipher,
    LTC_UNUSED_PARAM(outlen);
    return CRYPT_NOP;
 #else
-   size_t x;
-   int err;
    omac_state omac;
-   FILE *in;
-   unsigned char *buf;
+   int err;
 
    LTC_ARGCHK(key      != NULL);
    LTC_ARGCHK(filename != NULL);
    LTC_ARGCHK(out      != NULL);
    LTC_ARGCHK(outlen   != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = omac_init(&omac, cipher, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   in = fopen(filename, "rb");
-   if (in == NULL) {
-      err = CRYPT_FILE_NOTFOUND;
+   if ((err = file_process_name(filename, s_omac_file_process, &omac)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = omac_process(&omac, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
-
-   if (fclose(in) != 0) {
-      err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
-   }
-
    err = omac_done(&omac, out, outlen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&omac, sizeof(omac_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
@@ -10,6 +10,13 @@
 
 #ifdef LTC_POLY1305
 
+#ifndef LTC_NO_FILE
+static int s_poly1305_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return poly1305_process(ctx, in, inlen);
+}
+#endif
+
 /**
   POLY1305 a file
   @param fname    The name of the file you wish to POLY1305
@@ -30,9 +37,6 @@ int poly1305_file(const char *fname, const unsigned char *key, unsigned long key
    return CRYPT_NOP;
 #else
    poly1305_state st;
-   FILE *in;
-   unsigned char *buf;
-   size_t x;
    int err;
 
    LTC_ARGCHK(fname  != NULL);
@@ -40,42 +44,18 @@ int poly1305_file(const char *fname, const unsigned char *key, unsigned long key
    LTC_ARGCHK(mac    != NULL);
    LTC_ARGCHK(maclen != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = poly1305_init(&st, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   in = fopen(fname, "rb");
-   if (in == NULL) {
-      err = CRYPT_FILE_NOTFOUND;
+   if ((err = file_process_name(fname, s_poly1305_file_process, &st)) != CRYPT_OK) {
       goto LBL_ERR;
    }
-
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = poly1305_process(&st, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
-
-   if (fclose(in) != 0) {
-      err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
-   }
-
    err = poly1305_done(&st, mac, maclen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&st, sizeof(poly1305_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
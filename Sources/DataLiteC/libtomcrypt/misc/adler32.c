@@ -7,11 +7,133 @@
    Adler-32 checksum algorithm
    Written and placed in the public domain by Wei Dai
    Adapted for libtomcrypt by Steffen Jaeckel
+   SSSE3 and AVX2 kernels on x86_64 (LTC_ADLER32_SIMD)
 */
 #ifdef LTC_ADLER32
 
 static const unsigned long s_adler32_base = 65521;
 
+/* largest n such that 255 n (n + 1) / 2 + (n + 1) (base - 1) <= 2^32 - 1, i.e. the number
+ * of octets that can be summed before s2 has to be reduced */
+#define ADLER32_NMAX 5552
+/* the same, rounded down to the 32 octets the SIMD kernels take per step */
+#define ADLER32_NMAX_SIMD 5536
+
+#if defined(LTC_ADLER32_SIMD)
+
+#include <immintrin.h>
+
+/* 0 = none, 1 = SSSE3, 2 = AVX2 */
+static int s_adler32_simd_level(void)
+{
+   unsigned int f = ltc_cpu_features();
+
+   if ((f & LTC_CPU_SSSE3) == 0) {
+      return 0;
+   }
+   return (f & LTC_CPU_AVX2) ? 2 : 1;
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static unsigned long s_adler32_hsum_ssse3(__m128i x)
+{
+   x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+   x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+   return (ulong32)_mm_cvtsi128_si32(x);
+}
+
+/*
+   Each step takes 32 octets b[0..31]. s1 grows by their sum, s2 by 32 times the s1 before the
+   step plus the weighted sum 32 b[0] + 31 b[1] + ... + 1 b[31]. Within a block of up to
+   ADLER32_NMAX_SIMD octets the sums of the previous steps are collected in `ps` and
+   everything is reduced modulo the base once at the end of the block.
+*/
+
+/**
+  Adler-32 of a multiple of 32 octets with SSSE3
+  @param a     [in/out] s1
+  @param b     [in/out] s2
+  @param in    The data
+  @param len   The length of the data, a multiple of 32
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_adler32_ssse3(unsigned long *a, unsigned long *b, const unsigned char *in, unsigned long len)
+{
+   const __m128i w0   = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+   const __m128i w1   = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+   const __m128i ones = _mm_set1_epi16(1);
+   const __m128i zero = _mm_setzero_si128();
+   unsigned long s1 = *a, s2 = *b, n;
+   __m128i vs1, vs2, vps, d0, d1;
+
+   while (len > 0) {
+      n = MIN(len, ADLER32_NMAX_SIMD);
+      len -= n;
+      s2 += s1 * n;
+      vs1 = vs2 = vps = zero;
+      for (; n > 0; n -= 32, in += 32) {
+         d0 = _mm_loadu_si128((const __m128i *)in);
+         d1 = _mm_loadu_si128((const __m128i *)(in + 16));
+         vps = _mm_add_epi32(vps, vs1);
+         vs1 = _mm_add_epi32(vs1, _mm_add_epi32(_mm_sad_epu8(d0, zero), _mm_sad_epu8(d1, zero)));
+         vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(d0, w0), ones));
+         vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(d1, w1), ones));
+      }
+      s1 += s_adler32_hsum_ssse3(vs1);
+      s2 += 32 * s_adler32_hsum_ssse3(vps) + s_adler32_hsum_ssse3(vs2);
+      s1 %= s_adler32_base;
+      s2 %= s_adler32_base;
+   }
+
+   *a = s1;
+   *b = s2;
+}
+
+/**
+  Adler-32 of a multiple of 32 octets with AVX2
+  @param a     [in/out] s1
+  @param b     [in/out] s2
+  @param in    The data
+  @param len   The length of the data, a multiple of 32
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_adler32_avx2(unsigned long *a, unsigned long *b, const unsigned char *in, unsigned long len)
+{
+   const __m256i w    = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                         16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+   const __m256i ones = _mm256_set1_epi16(1);
+   const __m256i zero = _mm256_setzero_si256();
+   unsigned long s1 = *a, s2 = *b, n;
+   __m256i vs1, vs2, vps, d;
+   __m128i t1, t2;
+
+   while (len > 0) {
+      n = MIN(len, ADLER32_NMAX_SIMD);
+      len -= n;
+      s2 += s1 * n;
+      vs1 = vs2 = vps = zero;
+      for (; n > 0; n -= 32, in += 32) {
+         d = _mm256_loadu_si256((const __m256i *)in);
+         vps = _mm256_add_epi32(vps, vs1);
+         vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(d, zero));
+         vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(d, w), ones));
+      }
+      t1 = _mm_add_epi32(_mm256_castsi256_si128(vs1), _mm256_extracti128_si256(vs1, 1));
+      t2 = _mm_add_epi32(_mm256_castsi256_si128(vps), _mm256_extracti128_si256(vps, 1));
+      s1 += s_adler32_hsum_ssse3(t1);
+      s2 += 32 * s_adler32_hsum_ssse3(t2);
+      t2 = _mm_add_epi32(_mm256_castsi256_si128(vs2), _mm256_extracti128_si256(vs2, 1));
+      s2 += s_adler32_hsum_ssse3(t2);
+      s1 %= s_adler32_base;
+      s2 %= s_adler32_base;
+   }
+
+   *a = s1;
+   *b = s2;
+}
+
+#endif /* LTC_ADLER32_SIMD */
+
 void adler32_init(adler32_state *ctx)
 {
    LTC_ARGCHKVD(ctx != NULL);
@@ -21,50 +143,61 @@ void adler32_init(adler32_state *ctx)
 
 void adler32_update(adler32_state *ctx, const unsigned char *input, unsigned long length)
 {
-   unsigned long s1, s2;
+   unsigned long s1, s2, n;
 
    LTC_ARGCHKVD(ctx != NULL);
    LTC_ARGCHKVD(input != NULL);
    s1 = ctx->s[0];
    s2 = ctx->s[1];
 
-   if (length % 8 != 0) {
-      do {
-         s1 += *input++;
-         s2 += s1;
-         length--;
-      } while (length % 8 != 0);
-
-      if (s1 >= s_adler32_base) {
-         s1 -= s_adler32_base;
+#if defined(LTC_ADLER32_SIMD)
+   if (length >= 64) {
+      int level = s_adler32_simd_level();
+      if (level != 0) {
+         n = length & ~31uL;
+         if (level == 2) {
+            s_adler32_avx2(&s1, &s2, input, n);
+         } else {
+            s_adler32_ssse3(&s1, &s2, input, n);
+         }
+         input  += n;
+         length -= n;
       }
-      s2 %= s_adler32_base;
    }
+#endif
 
    while (length > 0) {
-      s1 += input[0];
-      s2 += s1;
-      s1 += input[1];
-      s2 += s1;
-      s1 += input[2];
-      s2 += s1;
-      s1 += input[3];
-      s2 += s1;
-      s1 += input[4];
-      s2 += s1;
-      s1 += input[5];
-      s2 += s1;
-      s1 += input[6];
-      s2 += s1;
-      s1 += input[7];
-      s2 += s1;
-
-      length -= 8;
-      input += 8;
-
-      if (s1 >= s_adler32_base) {
-         s1 -= s_adler32_base;
+      n = MIN(length, ADLER32_NMAX);
+      length -= n;
+
+      while (n >= 8) {
+         s1 += input[0];
+         s2 += s1;
+         s1 += input[1];
+         s2 += s1;
+         s1 += input[2];
+         s2 += s1;
+         s1 += input[3];
+         s2 += s1;
+         s1 += input[4];
+         s2 += s1;
+         s1 += input[5];
+         s2 += s1;
+         s1 += input[6];
+         s2 += s1;
+         s1 += input[7];
+         s2 += s1;
+
+         n -= 8;
+         input += 8;
+      }
+      while (n > 0) {
+         s1 += *input++;
+         s2 += s1;
+         n--;
       }
+
+      s1 %= s_adler32_base;
       s2 %= s_adler32_base;
    }
 
@@ -109,7 +242,10 @@ int adler32_test(void)
 #else
    const void* in = "libtomcrypt";
    const unsigned char adler32[] = { 0x1b, 0xe8, 0x04, 0xba };
-   unsigned char out[4];
+   /* 6000 octets 0x00, 0x01, ..., 0xff, 0x00, ... cross the reduction boundary */
+   const unsigned char adler32_long[] = { 0x5a, 0xf3, 0x8d, 0x6e };
+   unsigned char buf[6000], out[4];
+   unsigned long n;
    adler32_state ctx;
    adler32_init(&ctx);
    adler32_update(&ctx, in, XSTRLEN(in));
@@ -117,6 +253,16 @@ int adler32_test(void)
    if (compare_testvector(adler32, 4, out, 4, "adler32", 0)) {
       return CRYPT_FAIL_TESTVECTOR;
    }
+   for (n = 0; n < sizeof(buf); n++) {
+      buf[n] = (unsigned char)n;
+   }
+   adler32_init(&ctx);
+   adler32_update(&ctx, buf, 17);
+   adler32_update(&ctx, buf + 17, sizeof(buf) - 17);
+   adler32_finish(&ctx, out, 4);
+   if (compare_testvector(adler32_long, 4, out, 4, "adler32 long", 0)) {
+      return CRYPT_FAIL_TESTVECTOR;
+   }
    return CRYPT_OK;
 #endif
 }
@@ -82,6 +82,9 @@ static int s_base64_decode_internal(const char *in,  unsigned long inlen,
    unsigned long t, x, y, z;
    unsigned char c;
    int           g;
+#if defined(LTC_BASE64_SIMD)
+   unsigned long n;
+#endif
 
    LTC_ARGCHK(in     != NULL);
    LTC_ARGCHK(out    != NULL);
@@ -89,6 +92,17 @@ static int s_base64_decode_internal(const char *in,  unsigned long inlen,
 
    g = 0; /* '=' counter */
    for (x = y = z = t = 0; x < inlen; x++) {
+#if defined(LTC_BASE64_SIMD)
+       /* whole blocks of alphabet characters at a quantum boundary decode the same in every mode */
+       if ((y == 0) && ((g == 0) || (mode == insane))) {
+          n = base64_simd_decode(in + x, inlen - x, out + z, *outlen - z, map['-'] == 62);
+          x += n;
+          z += n / 4 * 3;
+          if (x == inlen) {
+             break;
+          }
+       }
+#endif
        if ((in[x] == 0) && (x == (inlen - 1)) && (mode != strict)) {
           continue; /* allow the last byte to be NUL (relaxed+insane) */
        }
@@ -62,7 +62,15 @@ static int s_base64_encode_internal(const unsigned char *in,    unsigned long in
 
    p = out;
    leven = 3*(inlen / 3);
-   for (i = 0; i < leven; i += 3) {
+   i = 0;
+#if defined(LTC_BASE64_SIMD)
+   if ((mode & crlf) == 0) {
+      i = base64_simd_encode(in, inlen, p, codes[62] == '-');
+      in += i;
+      p += i / 3 * 4;
+   }
+#endif
+   for (; i < leven; i += 3) {
        *p++ = codes[(in[0] >> 2) & 0x3F];
        *p++ = codes[(((in[0] & 3) << 4) + (in[1] >> 4)) & 0x3F];
        *p++ = codes[(((in[1] & 0xf) << 2) + (in[2] >> 6)) & 0x3F];
@@ -0,0 +1,229 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file base64_simd.c
+  SSSE3 and AVX2 base64 kernels for x86_64, selected at run-time.
+  Translation and validation by nibble lookups as described by Wojciech Mula
+  and Daniel Lemire in "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+*/
+
+#if defined(LTC_BASE64_SIMD)
+
+#include <immintrin.h>
+
+typedef struct {
+   /* decoding: invalid (hi, lo) nibble combinations share a bit in lo[lo] and hi[hi] */
+   unsigned char lo[16], hi[16];
+   /* decoding: offset to add, indexed by the high nibble, plus 8 for the 63rd character */
+   unsigned char roll[16];
+   /* encoding: offset to add, indexed by the reduced 6 bit value */
+   unsigned char enc[16];
+   /* the 63rd character, '/' or '_' */
+   char c63;
+} base64_simd_alphabet;
+
+static const base64_simd_alphabet s_base64 = {
+   { 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A },
+   { 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+   {    0,    0,   19,    4, 0xBF, 0xBF, 0xB9, 0xB9,    0,    0,   16,    0,    0,    0,    0,    0 },
+   {   71, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xED, 0xF0,   65,    0,    0 },
+   '/'
+};
+
+static const base64_simd_alphabet s_base64url = {
+   { 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x3B, 0x3B, 0x3A, 0x3B, 0x33 },
+   { 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x20, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+   {    0,    0,   17,    4, 0xBF, 0xBF, 0xB9, 0xB9,    0,    0,    0,    0,    0, 0xE0,    0,    0 },
+   {   71, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xEF,   32,   65,    0,    0 },
+   '_'
+};
+
+/* 0 = none, 1 = SSSE3, 2 = AVX2 */
+static int s_base64_simd_level(void)
+{
+   unsigned int f = ltc_cpu_features();
+
+   if ((f & LTC_CPU_SSSE3) == 0) {
+      return 0;
+   }
+   return (f & LTC_CPU_AVX2) ? 2 : 1;
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static unsigned long s_encode_ssse3(const unsigned char *in, unsigned long inlen, char *out,
+                                    const base64_simd_alphabet *a)
+{
+   const __m128i shuf = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+   const __m128i lut  = _mm_loadu_si128((const __m128i *)a->enc);
+   unsigned long x = 0;
+   __m128i v, i;
+
+   /* 12 octets to 16 characters, the load reads 16 octets */
+   while (inlen - x >= 16) {
+      v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + x)), shuf);
+      i = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040)),
+                       _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010)));
+      v = _mm_subs_epu8(i, _mm_set1_epi8(51));
+      v = _mm_or_si128(v, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), i), _mm_set1_epi8(13)));
+      v = _mm_add_epi8(_mm_shuffle_epi8(lut, v), i);
+      _mm_storeu_si128((__m128i *)out, v);
+      out += 16;
+      x += 12;
+   }
+   return x;
+}
+
+LTC_ATTRIBUTE((__target__("avx2")))
+static unsigned long s_encode_avx2(const unsigned char *in, unsigned long inlen, char *out,
+                                   const base64_simd_alphabet *a)
+{
+   const __m256i shuf = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                         1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+   const __m256i lut  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)a->enc));
+   unsigned long x = 0;
+   __m256i v, i;
+
+   /* 24 octets to 32 characters, the loads read 28 octets */
+   while (inlen - x >= 28) {
+      v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(in + x))),
+                                  _mm_loadu_si128((const __m128i *)(in + x + 12)), 1);
+      v = _mm256_shuffle_epi8(v, shuf);
+      i = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040)),
+                          _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010)));
+      v = _mm256_subs_epu8(i, _mm256_set1_epi8(51));
+      v = _mm256_or_si256(v, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), i), _mm256_set1_epi8(13)));
+      v = _mm256_add_epi8(_mm256_shuffle_epi8(lut, v), i);
+      _mm256_storeu_si256((__m256i *)out, v);
+      out += 32;
+      x += 24;
+   }
+   return x;
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static unsigned long s_decode_ssse3(const char *in, unsigned long inlen, unsigned char *out, unsigned long outlen,
+                                    const base64_simd_alphabet *a)
+{
+   const __m128i lut_lo  = _mm_loadu_si128((const __m128i *)a->lo);
+   const __m128i lut_hi  = _mm_loadu_si128((const __m128i *)a->hi);
+   const __m128i lut_rol = _mm_loadu_si128((const __m128i *)a->roll);
+   const __m128i nibble  = _mm_set1_epi8(0x2F);
+   const __m128i c63     = _mm_set1_epi8(a->c63);
+   const __m128i pack    = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+   unsigned long x = 0;
+   ulong32 w;
+   __m128i v, hi, lo;
+
+   /* 16 characters to 12 octets, stop at the first block that isn't 16 alphabet characters */
+   while (inlen - x >= 16 && outlen >= 12) {
+      v  = _mm_loadu_si128((const __m128i *)(in + x));
+      hi = _mm_and_si128(_mm_srli_epi32(v, 4), nibble);
+      lo = _mm_and_si128(v, nibble);
+      lo = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(lo, _mm_setzero_si128())) != 0xFFFF) {
+         break;
+      }
+      hi = _mm_add_epi8(hi, _mm_and_si128(_mm_cmpeq_epi8(v, c63), _mm_set1_epi8(8)));
+      v  = _mm_add_epi8(v, _mm_shuffle_epi8(lut_rol, hi));
+      v  = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+      v  = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+      v  = _mm_shuffle_epi8(v, pack);
+      _mm_storel_epi64((__m128i *)out, v);
+      w = (ulong32)_mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+      XMEMCPY(out + 8, &w, 4);
+      out += 12;
+      outlen -= 12;
+      x += 16;
+   }
+   return x;
+}
+
+LTC_ATTRIBUTE((__target__("avx2")))
+static unsigned long s_decode_avx2(const char *in, unsigned long inlen, unsigned char *out, unsigned long outlen,
+                                   const base64_simd_alphabet *a)
+{
+   const __m256i lut_lo  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)a->lo));
+   const __m256i lut_hi  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)a->hi));
+   const __m256i lut_rol = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)a->roll));
+   const __m256i nibble  = _mm256_set1_epi8(0x2F);
+   const __m256i c63     = _mm256_set1_epi8(a->c63);
+   const __m256i pack    = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+   const __m256i lanes   = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+   unsigned long x = 0;
+   __m256i v, hi, lo;
+
+   /* 32 characters to 24 octets */
+   while (inlen - x >= 32 && outlen >= 24) {
+      v  = _mm256_loadu_si256((const __m256i *)(in + x));
+      hi = _mm256_and_si256(_mm256_srli_epi32(v, 4), nibble);
+      lo = _mm256_and_si256(v, nibble);
+      lo = _mm256_and_si256(_mm256_shuffle_epi8(lut_lo, lo), _mm256_shuffle_epi8(lut_hi, hi));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, _mm256_setzero_si256())) != -1) {
+         break;
+      }
+      hi = _mm256_add_epi8(hi, _mm256_and_si256(_mm256_cmpeq_epi8(v, c63), _mm256_set1_epi8(8)));
+      v  = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut_rol, hi));
+      v  = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+      v  = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+      v  = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, pack), lanes);
+      _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(v));
+      _mm_storel_epi64((__m128i *)(out + 16), _mm256_extracti128_si256(v, 1));
+      out += 24;
+      outlen -= 24;
+      x += 32;
+   }
+   return x;
+}
+
+/**
+  Encode the leading part of a buffer in blocks of 12 octets
+  @param in      The input buffer
+  @param inlen   The length of the input buffer
+  @param out     [out] The destination, 4/3 of the returned length
+  @param url     Use the URL safe alphabet
+  @return The number of octets encoded, a multiple of 12 and at most inlen - 4
+*/
+unsigned long base64_simd_encode(const unsigned char *in, unsigned long inlen, char *out, int url)
+{
+   const base64_simd_alphabet *a = url ? &s_base64url : &s_base64;
+   int level = s_base64_simd_level();
+   unsigned long x = 0;
+
+   if (level >= 2) {
+      x = s_encode_avx2(in, inlen, out, a);
+   }
+   if (level >= 1) {
+      x += s_encode_ssse3(in + x, inlen - x, out + x / 3 * 4, a);
+   }
+   return x;
+}
+
+/**
+  Decode the leading part of a buffer in blocks of 16 alphabet characters,
+  stopping before the first block containing anything else (padding, white-space, garbage)
+  @param in       The base64 data
+  @param inlen    The length of the base64 data
+  @param out      [out] The destination, 3/4 of the returned length
+  @param outlen   The size of the destination
+  @param url      Use the URL safe alphabet
+  @return The number of characters decoded, a multiple of 16
+*/
+unsigned long base64_simd_decode(const char *in, unsigned long inlen, unsigned char *out, unsigned long outlen, int url)
+{
+   const base64_simd_alphabet *a = url ? &s_base64url : &s_base64;
+   int level = s_base64_simd_level();
+   unsigned long x = 0;
+
+   if (level >= 2) {
+      x = s_decode_avx2(in, inlen, out, outlen, a);
+   }
+   if (level >= 1) {
+      x += s_decode_ssse3(in + x, inlen - x, out + x / 4 * 3, outlen - x / 4 * 3, a);
+   }
+   return x;
+}
+
+#endif /* LTC_BASE64_SIMD */
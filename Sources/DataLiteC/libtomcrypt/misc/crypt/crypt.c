@@ -214,6 +214,12 @@ const char *crypt_build_settings =
 #if defined(LTC_BLAKE2B)
    "   BLAKE2B\n"
 #endif
+#if defined(LTC_BLAKE2SP)
+   "   BLAKE2SP\n"
+#endif
+#if defined(LTC_BLAKE2BP)
+   "   BLAKE2BP\n"
+#endif
 #if defined(LTC_CHC_HASH)
    "   CHC_HASH\n"
 #endif
@@ -452,6 +458,12 @@ const char *crypt_build_settings =
 #if defined(LTC_CRC32)
     " CRC32 "
 #endif
+#if defined(LTC_CRC32C)
+    " CRC32C "
+#endif
+#if defined(LTC_CRC32_ACCEL)
+    " CRC32-ACCEL "
+#endif
 #if defined(LTC_DER)
     " DER "
     " " NAME_VALUE(LTC_DER_MAX_RECURSION) " "
@@ -557,9 +569,15 @@ const char *crypt_build_settings =
 #if defined(LTC_PTHREAD)
     " LTC_PTHREAD "
 #endif
+#if defined(LTC_SECMEM)
+    " LTC_SECMEM "
+#endif
 #if defined(LTC_EASY)
     " LTC_EASY "
 #endif
+#if defined(LTC_AES_ONLY)
+    " LTC_AES_ONLY "
+#endif
 #if defined(LTC_MECC_ACCEL)
     " LTC_MECC_ACCEL "
 #endif
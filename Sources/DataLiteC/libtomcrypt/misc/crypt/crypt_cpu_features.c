@@ -0,0 +1,73 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file crypt_cpu_features.c
+  The x86_64 instruction set extensions the accelerated code paths select on
+*/
+#ifdef LTC_CPU_FEATURES
+
+static unsigned int s_features;
+
+#ifdef LTC_PTHREAD
+static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+#else
+static int s_initialized;
+#endif
+
+static void s_cpu_features_init(void)
+{
+   unsigned int a, b, c, d, max, f = 0;
+
+   __asm__ volatile ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(0), "c"(0));
+   max = a;
+   __asm__ volatile ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(1), "c"(0));
+   /* CPUID.1.0.ECX[9] SSSE3, [19] SSE4.1, [20] SSE4.2, [1] PCLMULQDQ and [25] AES-NI */
+   if ((c >> 9) & 1) {
+      f |= LTC_CPU_SSSE3;
+   }
+   if ((c >> 19) & 1) {
+      f |= LTC_CPU_SSE41;
+   }
+   if ((c >> 20) & 1) {
+      f |= LTC_CPU_SSE42;
+   }
+   if ((c >> 1) & 1) {
+      f |= LTC_CPU_PCLMUL;
+   }
+   if ((c >> 25) & 1) {
+      f |= LTC_CPU_AESNI;
+   }
+   /* CPUID.1.0.ECX[27] OSXSAVE, the OS must save the YMM state (XCR0[2:1]) and CPUID.7.0.EBX[5] AVX2 */
+   if (max >= 7 && ((c >> 27) & 1)) {
+      __asm__ volatile ("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+      if ((a & 6) == 6) {
+         __asm__ volatile ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(7), "c"(0));
+         if ((b >> 5) & 1) {
+            f |= LTC_CPU_AVX2;
+         }
+      }
+   }
+
+   s_features = f;
+}
+
+/**
+  Query the CPU once
+  @return A combination of the LTC_CPU_* bits
+*/
+unsigned int ltc_cpu_features(void)
+{
+#ifdef LTC_PTHREAD
+   (void)pthread_once(&s_once, s_cpu_features_init);
+#else
+   if (s_initialized == 0) {
+      s_cpu_features_init();
+      s_initialized = 1;
+   }
+#endif
+   return s_features;
+}
+
+#endif /* LTC_CPU_FEATURES */
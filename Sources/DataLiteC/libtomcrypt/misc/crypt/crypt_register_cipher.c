@@ -31,6 +31,9 @@ int register_cipher(const struct ltc_cipher_descriptor *cipher)
    for (x = 0; x < TAB_SIZE; x++) {
        if (cipher_descriptor[x].name == NULL) {
           XMEMCPY(&cipher_descriptor[x], cipher, sizeof(struct ltc_cipher_descriptor));
+#ifdef LTC_STATS
+          crypt_stats_wrap_cipher(x);
+#endif
           LTC_MUTEX_UNLOCK(&ltc_cipher_mutex);
           return x;
        }
@@ -21,7 +21,13 @@ int register_hash(const struct ltc_hash_descriptor *hash)
    /* is it already registered? */
    LTC_MUTEX_LOCK(&ltc_hash_mutex);
    for (x = 0; x < TAB_SIZE; x++) {
+#ifdef LTC_STATS
+       /* the table holds the instrumented copy, compare against what was registered */
+       if (hash_descriptor[x].name != NULL &&
+           XMEMCMP(crypt_stats_registered_hash(x), hash, sizeof(struct ltc_hash_descriptor)) == 0) {
+#else
        if (XMEMCMP(&hash_descriptor[x], hash, sizeof(struct ltc_hash_descriptor)) == 0) {
+#endif
           LTC_MUTEX_UNLOCK(&ltc_hash_mutex);
           return x;
        }
@@ -31,6 +37,9 @@ int register_hash(const struct ltc_hash_descriptor *hash)
    for (x = 0; x < TAB_SIZE; x++) {
        if (hash_descriptor[x].name == NULL) {
           XMEMCPY(&hash_descriptor[x], hash, sizeof(struct ltc_hash_descriptor));
+#ifdef LTC_STATS
+          crypt_stats_wrap_hash(x);
+#endif
           LTC_MUTEX_UNLOCK(&ltc_hash_mutex);
           return x;
        }
@@ -0,0 +1,298 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#define LTC_SECMEM_REAL_ALLOC
+#define LTC_STATS_REAL_ALLOC
+#include "tomcrypt_private.h"
+
+/**
+  @file crypt_secmem.c
+  Locked, wiped memory for the library's allocations (LTC_SECMEM)
+*/
+#ifdef LTC_SECMEM
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define LTC_SECMEM_MMAP
+#endif
+
+/* blocks are 2^4 = 16 up to 2^14 = 16384 octets */
+#define SECMEM_MIN_SHIFT  4
+#define SECMEM_MAX_SHIFT  14
+#define SECMEM_CLASSES    (SECMEM_MAX_SHIFT - SECMEM_MIN_SHIFT + 1)
+#define SECMEM_MAX_BLOCK  (1uL << SECMEM_MAX_SHIFT)
+/* regions are carved into slabs of this size, each slab only holds blocks of one class */
+#define SECMEM_SLAB       4096uL
+#define SECMEM_SLABS      (LTC_SECMEM_REGION_SIZE / SECMEM_SLAB)
+
+LTC_STATIC_ASSERT(secmem_region_size, LTC_SECMEM_REGION_SIZE % SECMEM_SLAB == 0 && LTC_SECMEM_REGION_SIZE >= SECMEM_MAX_BLOCK)
+
+typedef struct {
+   unsigned char *base;
+   unsigned long  used;                /* octets carved into slabs so far */
+   int            locked;
+   unsigned char  cls[SECMEM_SLABS];   /* class of the blocks of each slab */
+} secmem_region;
+
+/* allocations that don't fit into the pool carry their size in front, so they can be wiped */
+typedef union {
+   size_t  n;
+   ulong64 align[2];
+} secmem_header;
+
+static secmem_region s_region[LTC_SECMEM_REGIONS];
+static unsigned long s_regions;
+static void         *s_free[SECMEM_CLASSES];
+static unsigned long s_in_use, s_fallback;
+static int           s_enabled = LTC_SECMEM_INITIAL_ENABLED;
+
+LTC_MUTEX_GLOBAL(ltc_secmem_mutex)
+
+static int s_secmem_class(size_t n)
+{
+   int c = 0;
+   while ((CONSTPTR(1) << (c + SECMEM_MIN_SHIFT)) < n) {
+      c++;
+   }
+   return c;
+}
+
+static secmem_region *s_secmem_region_of(const void *p)
+{
+   unsigned long x;
+   for (x = 0; x < s_regions; x++) {
+      if ((const unsigned char *)p >= s_region[x].base &&
+          (const unsigned char *)p <  s_region[x].base + LTC_SECMEM_REGION_SIZE) {
+         return &s_region[x];
+      }
+   }
+   return NULL;
+}
+
+static int s_secmem_map(secmem_region *r)
+{
+#ifdef LTC_SECMEM_MMAP
+   void *p = mmap(NULL, LTC_SECMEM_REGION_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+   if (p == MAP_FAILED) {
+      return CRYPT_MEM;
+   }
+   /* best effort, e.g. RLIMIT_MEMLOCK may not allow it */
+   r->locked = mlock(p, LTC_SECMEM_REGION_SIZE) == 0;
+#if defined(MADV_DONTDUMP)
+   (void)madvise(p, LTC_SECMEM_REGION_SIZE, MADV_DONTDUMP);
+#endif
+#else
+   void *p = XCALLOC(1, LTC_SECMEM_REGION_SIZE);
+   if (p == NULL) {
+      return CRYPT_MEM;
+   }
+   r->locked = 0;
+#endif
+   r->base = p;
+   r->used = 0;
+   return CRYPT_OK;
+}
+
+/* take a fresh slab for class c, return its first block and put the others on the free list */
+static void *s_secmem_carve(int c)
+{
+   unsigned long size = 1uL << (c + SECMEM_MIN_SHIFT);
+   unsigned long slab = size < SECMEM_SLAB ? SECMEM_SLAB : size;
+   unsigned long x, off;
+   secmem_region *r = NULL;
+   unsigned char *base;
+
+   for (x = 0; x < s_regions; x++) {
+      if (LTC_SECMEM_REGION_SIZE - s_region[x].used >= slab) {
+         r = &s_region[x];
+         break;
+      }
+   }
+   if (r == NULL) {
+      if (s_regions == LTC_SECMEM_REGIONS || s_secmem_map(&s_region[s_regions]) != CRYPT_OK) {
+         return NULL;
+      }
+      r = &s_region[s_regions++];
+   }
+
+   base = r->base + r->used;
+   r->cls[r->used / SECMEM_SLAB] = (unsigned char)c;
+   r->used += slab;
+   /* push in reverse so the blocks are handed out in address order */
+   for (off = slab - size; off >= size; off -= size) {
+      *(void **)(base + off) = s_free[c];
+      s_free[c] = base + off;
+   }
+   return base;
+}
+
+/**
+  Allocate memory, from the locked pool if it fits
+  @param n   The number of octets
+  @return The zeroed memory, or NULL
+*/
+void *crypt_secmem_malloc(size_t n)
+{
+   secmem_header *h;
+   void *p = NULL;
+   int c = 0;
+
+   if (n == 0) {
+      n = 1;
+   }
+   if (n > (size_t)-1 - sizeof(*h)) {
+      return NULL;
+   }
+   LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+   if (s_enabled && n <= SECMEM_MAX_BLOCK) {
+      c = s_secmem_class(n);
+      if ((p = s_free[c]) != NULL) {
+         s_free[c] = *(void **)p;
+         *(void **)p = NULL;
+      } else {
+         p = s_secmem_carve(c);
+      }
+   }
+   if (p != NULL) {
+      s_in_use += 1uL << (c + SECMEM_MIN_SHIFT);
+   } else {
+      /* accounted up front so the common case takes the lock once */
+      s_fallback += n;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+   if (p != NULL) {
+      return p;
+   }
+
+   if ((h = XCALLOC(1, sizeof(*h) + n)) == NULL) {
+      LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+      s_fallback -= n;
+      LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+      return NULL;
+   }
+   h->n = n;
+   return h + 1;
+}
+
+/**
+  Allocate zeroed memory, blocks are wiped when they are freed so this is crypt_secmem_malloc()
+  @param n   The number of elements
+  @param s   The size of an element
+  @return The zeroed memory, or NULL
+*/
+void *crypt_secmem_calloc(size_t n, size_t s)
+{
+   if (s != 0 && n > (size_t)-1 / s) {
+      return NULL;
+   }
+   return crypt_secmem_malloc(n * s);
+}
+
+/**
+  Wipe and free memory from crypt_secmem_malloc()
+  @param p   The memory, may be NULL
+*/
+void crypt_secmem_free(void *p)
+{
+   secmem_region *r;
+   secmem_header *h;
+   unsigned long size;
+   int c;
+
+   if (p == NULL) {
+      return;
+   }
+   LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+   if ((r = s_secmem_region_of(p)) != NULL) {
+      c = r->cls[(unsigned long)((unsigned char *)p - r->base) / SECMEM_SLAB];
+      size = 1uL << (c + SECMEM_MIN_SHIFT);
+      zeromem(p, size);
+      *(void **)p = s_free[c];
+      s_free[c] = p;
+      s_in_use -= size;
+      LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+      return;
+   }
+   h = (secmem_header *)p - 1;
+   s_fallback -= h->n;
+   LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+   zeromem(h, sizeof(*h) + h->n);
+   XFREE(h);
+}
+
+/**
+  Resize memory from crypt_secmem_malloc(), the old block is wiped if it moves
+  @param p   The memory, may be NULL
+  @param n   The new size in octets
+  @return The memory, or NULL in which case `p` is left untouched
+*/
+void *crypt_secmem_realloc(void *p, size_t n)
+{
+   secmem_region *r;
+   size_t size;
+   void *q;
+
+   if (p == NULL) {
+      return crypt_secmem_malloc(n);
+   }
+   LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+   if ((r = s_secmem_region_of(p)) != NULL) {
+      size = CONSTPTR(1) << (r->cls[(unsigned long)((unsigned char *)p - r->base) / SECMEM_SLAB] + SECMEM_MIN_SHIFT);
+   } else {
+      size = ((secmem_header *)p - 1)->n;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+
+   if (n <= size) {
+      return p;
+   }
+   if ((q = crypt_secmem_malloc(n)) == NULL) {
+      return NULL;
+   }
+   XMEMCPY(q, p, size);
+   crypt_secmem_free(p);
+   return q;
+}
+
+/**
+  Switch the locked pool on or off. While it is off new allocations come from
+  the system allocator, they are still wiped when they are freed. Blocks
+  handed out before stay valid either way.
+  @param enable   Non-zero to serve allocations from the pool
+*/
+void crypt_secmem_enable(int enable)
+{
+   LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+   s_enabled = enable != 0;
+   LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+}
+
+/**
+  Report the state of the pool
+  @param locked     [out] Octets of the pool that are mlock'ed
+  @param in_use     [out] Octets handed out from the pool
+  @param fallback   [out] Octets handed out from the system allocator because the pool was off, exhausted or too small
+  @return CRYPT_OK if successful
+*/
+int crypt_secmem_usage(unsigned long *locked, unsigned long *in_use, unsigned long *fallback)
+{
+   unsigned long x;
+
+   LTC_ARGCHK(locked   != NULL);
+   LTC_ARGCHK(in_use   != NULL);
+   LTC_ARGCHK(fallback != NULL);
+
+   LTC_MUTEX_LOCK(&ltc_secmem_mutex);
+   *locked = 0;
+   for (x = 0; x < s_regions; x++) {
+      if (s_region[x].locked) {
+         *locked += LTC_SECMEM_REGION_SIZE;
+      }
+   }
+   *in_use   = s_in_use;
+   *fallback = s_fallback;
+   LTC_MUTEX_UNLOCK(&ltc_secmem_mutex);
+
+   return CRYPT_OK;
+}
+
+#endif /* LTC_SECMEM */
@@ -72,6 +72,12 @@ static const crypt_size s_crypt_sizes[] = {
 #ifdef LTC_BLAKE2B
     SZ_STRINGIFY_S(blake2b_state),
 #endif
+#ifdef LTC_BLAKE2SP
+    SZ_STRINGIFY_S(blake2sp_state),
+#endif
+#ifdef LTC_BLAKE2BP
+    SZ_STRINGIFY_S(blake2bp_state),
+#endif
 
     /* block cipher key sizes */
     SZ_STRINGIFY_S(ltc_cipher_descriptor),
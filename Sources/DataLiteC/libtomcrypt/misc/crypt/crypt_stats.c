@@ -0,0 +1,356 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#define LTC_STATS_REAL_ALLOC
+#include "tomcrypt_private.h"
+
+/**
+  @file crypt_stats.c
+  Operation counters and latency histograms (LTC_STATS)
+*/
+#ifdef LTC_STATS
+
+/* counters are only ever summed, so they are treated as a flat array of ulong64 */
+LTC_STATIC_ASSERT(ltc_stats_is_ulong64_array, sizeof(ltc_stats) % sizeof(ulong64) == 0)
+
+/* how deep descriptor calls nest, e.g. hmac_block calling process, deeper ones aren't attributed */
+#define LTC_STATS_DEPTH 8
+
+typedef struct crypt_stats_block {
+   ltc_stats stats;
+   /* the counters allocations are currently accounted to, innermost last */
+   ltc_stats_counter *current[LTC_STATS_DEPTH];
+   unsigned long depth;
+   struct crypt_stats_block *prev, *next;
+} crypt_stats_block;
+
+/* counters of threads that have exited */
+static ltc_stats s_retired;
+/* shared by all threads without LTC_PTHREAD, or by those whose own block could not be allocated */
+static crypt_stats_block s_shared;
+/* per-thread blocks, each one only written by its owner */
+static crypt_stats_block *s_live;
+
+LTC_MUTEX_GLOBAL(ltc_stats_mutex)
+
+#ifdef LTC_PTHREAD
+static pthread_key_t  s_key;
+static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void s_stats_add(ltc_stats *to, const ltc_stats *from)
+{
+   ulong64 *t = (ulong64 *)to;
+   const ulong64 *f = (const ulong64 *)from;
+   unsigned long x;
+
+   for (x = 0; x < sizeof(ltc_stats) / sizeof(ulong64); x++) {
+      t[x] += f[x];
+   }
+}
+
+#ifdef LTC_PTHREAD
+static void s_stats_thread_exit(void *p)
+{
+   crypt_stats_block *b = p;
+
+   LTC_MUTEX_LOCK(&ltc_stats_mutex);
+   s_stats_add(&s_retired, &b->stats);
+   if (b->prev != NULL) {
+      b->prev->next = b->next;
+   } else {
+      s_live = b->next;
+   }
+   if (b->next != NULL) {
+      b->next->prev = b->prev;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_stats_mutex);
+   XFREE(b);
+}
+
+static void s_stats_key_create(void)
+{
+   (void)pthread_key_create(&s_key, s_stats_thread_exit);
+}
+#endif
+
+static crypt_stats_block *s_stats_block(void)
+{
+#ifdef LTC_PTHREAD
+   crypt_stats_block *b;
+
+   (void)pthread_once(&s_once, s_stats_key_create);
+   if ((b = pthread_getspecific(s_key)) != NULL) {
+      return b;
+   }
+   if ((b = XCALLOC(1, sizeof(*b))) == NULL) {
+      return &s_shared;
+   }
+   if (pthread_setspecific(s_key, b) != 0) {
+      XFREE(b);
+      return &s_shared;
+   }
+
+   LTC_MUTEX_LOCK(&ltc_stats_mutex);
+   b->next = s_live;
+   if (s_live != NULL) {
+      s_live->prev = b;
+   }
+   s_live = b;
+   LTC_MUTEX_UNLOCK(&ltc_stats_mutex);
+   return b;
+#else
+   return &s_shared;
+#endif
+}
+
+/**
+  Get the counters of the calling thread
+  @return The counters to update
+*/
+ltc_stats *crypt_stats_thread(void)
+{
+   return &s_stats_block()->stats;
+}
+
+/**
+  Account the allocations of the calling thread to a descriptor until crypt_stats_leave()
+  @param counter   The counter of the descriptor, from crypt_stats_thread(), NULL to not account them
+*/
+void crypt_stats_enter(ltc_stats_counter *counter)
+{
+   crypt_stats_block *b = s_stats_block();
+   if (b->depth < LTC_STATS_DEPTH) {
+      b->current[b->depth] = counter;
+   }
+   b->depth++;
+}
+
+/**
+  Go back to accounting allocations to the descriptor before the matching crypt_stats_enter()
+*/
+void crypt_stats_leave(void)
+{
+   crypt_stats_block *b = s_stats_block();
+   if (b->depth > 0) {
+      b->depth--;
+   }
+}
+
+/**
+  Read the monotonic clock
+  @return The time in nanoseconds, 0 if there is no monotonic clock
+*/
+ulong64 crypt_stats_clock(void)
+{
+#if defined(CLOCK_MONOTONIC)
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+      return (ulong64)ts.tv_sec * CONST64(1000000000) + (ulong64)ts.tv_nsec;
+   }
+#endif
+   return 0;
+}
+
+/**
+  Account one call
+  @param counter   The counter of the descriptor that was called
+  @param bytes     The number of octets the call processed
+  @param start     The crypt_stats_clock() value when the call started
+*/
+void crypt_stats_record(ltc_stats_counter *counter, ulong64 bytes, ulong64 start)
+{
+   ulong64 nsec = crypt_stats_clock() - start, t;
+   int bucket = 0;
+
+   for (t = nsec; t != 0 && bucket < LTC_STATS_BUCKETS - 1; t >>= 1) {
+      bucket++;
+   }
+   counter->calls++;
+   counter->bytes += bytes;
+   counter->nsec  += nsec;
+   counter->histogram[bucket]++;
+}
+
+static void s_stats_alloc(size_t n)
+{
+   crypt_stats_block *b = s_stats_block();
+   ltc_stats_counter *counter;
+
+   b->stats.allocations++;
+   b->stats.allocated_bytes += n;
+   if (b->depth > 0) {
+      counter = b->current[(b->depth < LTC_STATS_DEPTH ? b->depth : LTC_STATS_DEPTH) - 1];
+      if (counter != NULL) {
+         counter->allocations++;
+         counter->allocated_bytes += n;
+      }
+   }
+}
+
+void *crypt_stats_malloc(size_t n)
+{
+   s_stats_alloc(n);
+   return XMALLOC(n);
+}
+
+void *crypt_stats_calloc(size_t n, size_t s)
+{
+   s_stats_alloc(n * s);
+   return XCALLOC(n, s);
+}
+
+void *crypt_stats_realloc(void *p, size_t n)
+{
+   s_stats_alloc(n);
+   return XREALLOC(p, n);
+}
+
+/**
+  Sum up the counters of all threads, live and exited
+  @param stats   [out] The totals
+  @return CRYPT_OK if successful
+  @remark Counters of threads that are running while the snapshot is taken may be slightly behind
+*/
+int crypt_stats_snapshot(ltc_stats *stats)
+{
+   crypt_stats_block *b;
+
+   LTC_ARGCHK(stats != NULL);
+
+   LTC_MUTEX_LOCK(&ltc_stats_mutex);
+   XMEMCPY(stats, &s_retired, sizeof(*stats));
+   s_stats_add(stats, &s_shared.stats);
+   for (b = s_live; b != NULL; b = b->next) {
+      s_stats_add(stats, &b->stats);
+   }
+   LTC_MUTEX_UNLOCK(&ltc_stats_mutex);
+
+   return CRYPT_OK;
+}
+
+/**
+  Zero the counters of all threads
+  @remark Calls that are in flight on other threads may still be accounted after the reset
+*/
+void crypt_stats_reset(void)
+{
+   crypt_stats_block *b;
+
+   LTC_MUTEX_LOCK(&ltc_stats_mutex);
+   XMEMSET(&s_retired, 0, sizeof(s_retired));
+   XMEMSET(&s_shared.stats, 0, sizeof(s_shared.stats));
+   for (b = s_live; b != NULL; b = b->next) {
+      XMEMSET(&b->stats, 0, sizeof(b->stats));
+   }
+   LTC_MUTEX_UNLOCK(&ltc_stats_mutex);
+}
+
+/* offset of `counter` in ltc_stats_counter, or in ltc_stats for the library-wide ones */
+static int s_stats_offset(const char *counter, int library, unsigned long *offset)
+{
+   unsigned long bucket;
+
+   if (XSTRCMP(counter, "allocations") == 0) {
+      *offset = library ? offsetof(ltc_stats, allocations) : offsetof(ltc_stats_counter, allocations);
+      return CRYPT_OK;
+   }
+   if (XSTRCMP(counter, "allocated_bytes") == 0) {
+      *offset = library ? offsetof(ltc_stats, allocated_bytes) : offsetof(ltc_stats_counter, allocated_bytes);
+      return CRYPT_OK;
+   }
+   if (library) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (XSTRCMP(counter, "calls") == 0) {
+      *offset = offsetof(ltc_stats_counter, calls);
+   } else if (XSTRCMP(counter, "bytes") == 0) {
+      *offset = offsetof(ltc_stats_counter, bytes);
+   } else if (XSTRCMP(counter, "nsec") == 0) {
+      *offset = offsetof(ltc_stats_counter, nsec);
+   } else if (XSTRLEN(counter) > 10 && XMEMCMP(counter, "histogram.", 10) == 0) {
+      /* histogram.<n> */
+      for (bucket = 0, counter += 10; *counter >= '0' && *counter <= '9' && bucket < LTC_STATS_BUCKETS; counter++) {
+         bucket = bucket * 10 + (unsigned long)(*counter - '0');
+      }
+      if (*counter != '\0' || bucket >= LTC_STATS_BUCKETS) {
+         return CRYPT_INVALID_ARG;
+      }
+      *offset = offsetof(ltc_stats_counter, histogram) + bucket * sizeof(ulong64);
+   } else {
+      return CRYPT_INVALID_ARG;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  Read one counter summed up over all threads, without depending on the layout of ltc_stats
+  @param kind      "cipher", "hash" or "prng", or NULL for the library-wide allocation counters
+  @param name      The name of the registered descriptor, e.g. "sha512", ignored if `kind` is NULL
+  @param counter   "calls", "bytes", "nsec", "histogram.<n>", "allocations" or "allocated_bytes"
+  @param value     [out] The value of the counter
+  @return CRYPT_OK if successful, CRYPT_NOP if the library was built without LTC_STATS
+*/
+int crypt_stats_value(const char *kind, const char *name, const char *counter, ulong64 *value)
+{
+   crypt_stats_block *b;
+   unsigned long offset, base = 0;
+   int idx, err;
+
+   LTC_ARGCHK(counter != NULL);
+   LTC_ARGCHK(value   != NULL);
+
+   if (kind != NULL) {
+      LTC_ARGCHK(name != NULL);
+      if (XSTRCMP(kind, "cipher") == 0) {
+         if ((idx = find_cipher(name)) == -1) {
+            return CRYPT_INVALID_CIPHER;
+         }
+         base = offsetof(ltc_stats, cipher);
+      } else if (XSTRCMP(kind, "hash") == 0) {
+         if ((idx = find_hash(name)) == -1) {
+            return CRYPT_INVALID_HASH;
+         }
+         base = offsetof(ltc_stats, hash);
+      } else if (XSTRCMP(kind, "prng") == 0) {
+         if ((idx = find_prng(name)) == -1) {
+            return CRYPT_INVALID_PRNG;
+         }
+         base = offsetof(ltc_stats, prng);
+      } else {
+         return CRYPT_INVALID_ARG;
+      }
+      base += (unsigned long)idx * sizeof(ltc_stats_counter);
+   }
+   if ((err = s_stats_offset(counter, kind == NULL, &offset)) != CRYPT_OK) {
+      return err;
+   }
+   offset += base;
+
+#define S_VALUE(stats) (*(const ulong64 *)((const unsigned char *)(stats) + offset))
+   LTC_MUTEX_LOCK(&ltc_stats_mutex);
+   *value = S_VALUE(&s_retired) + S_VALUE(&s_shared.stats);
+   for (b = s_live; b != NULL; b = b->next) {
+      *value += S_VALUE(&b->stats);
+   }
+   LTC_MUTEX_UNLOCK(&ltc_stats_mutex);
+#undef S_VALUE
+
+   return CRYPT_OK;
+}
+
+#else
+
+int crypt_stats_value(const char *kind, const char *name, const char *counter, ulong64 *value)
+{
+   LTC_UNUSED_PARAM(kind);
+   LTC_UNUSED_PARAM(name);
+   LTC_UNUSED_PARAM(counter);
+   LTC_UNUSED_PARAM(value);
+   return CRYPT_NOP;
+}
+
+void crypt_stats_reset(void)
+{
+}
+
+#endif /* LTC_STATS */
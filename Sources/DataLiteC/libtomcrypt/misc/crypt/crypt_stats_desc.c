@@ -0,0 +1,245 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file crypt_stats_desc.c
+  Instrumented descriptor table entries (LTC_STATS)
+
+  The descriptor callbacks don't know which table slot they were called
+  through, so every slot gets its own set of forwarding functions which
+  account the call to that slot and then call what was registered there.
+*/
+#ifdef LTC_STATS
+
+#define LTC_STATS_SLOTS 64
+
+#if TAB_SIZE > LTC_STATS_SLOTS
+   #error LTC_STATS supports a TAB_SIZE of at most 64
+#endif
+
+#define S_SLOTS(X) \
+   X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)  X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15) \
+   X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31) \
+   X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47) \
+   X(48) X(49) X(50) X(51) X(52) X(53) X(54) X(55) X(56) X(57) X(58) X(59) X(60) X(61) X(62) X(63)
+
+/* what was registered, the tables themselves hold the instrumented copies */
+static struct ltc_cipher_descriptor s_cipher[LTC_STATS_SLOTS];
+static struct ltc_hash_descriptor   s_hash[LTC_STATS_SLOTS];
+static struct ltc_prng_descriptor   s_prng[LTC_STATS_SLOTS];
+
+#define S_BLOCKS(n, blocks) ((ulong64)(blocks) * (ulong64)s_cipher[n].block_length)
+
+static ulong64 s_iov_bytes(const ltc_iovec *iov, unsigned long iovcnt)
+{
+   ulong64 bytes = 0;
+   unsigned long x;
+   for (x = 0; iov != NULL && x < iovcnt; x++) {
+      bytes += iov[x].inlen;
+   }
+   return bytes;
+}
+
+/* forward `call`, account it and the allocations it makes to `table[n]` and return its result,
+ * slots past TAB_SIZE are never installed, the modulo only keeps the index in bounds */
+#define S_ACCOUNT(type, table, n, bytes, call)                                            \
+   ltc_stats_counter *counter = &crypt_stats_thread()->table[(n) % TAB_SIZE];             \
+   ulong64 start;                                                                         \
+   type res;                                                                              \
+   crypt_stats_enter(counter);                                                            \
+   start = crypt_stats_clock();                                                           \
+   res = call;                                                                            \
+   crypt_stats_record(counter, (ulong64)(bytes), start);                                  \
+   crypt_stats_leave();                                                                   \
+   return res;
+
+#define S_CIPHER(n)                                                                                         \
+static int s_setup_##n(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey)           \
+{ S_ACCOUNT(int, cipher, n, 0, s_cipher[n].setup(key, keylen, num_rounds, skey)) }                        \
+static int s_ecb_encrypt_##n(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey)         \
+{ S_ACCOUNT(int, cipher, n, s_cipher[n].block_length, s_cipher[n].ecb_encrypt(pt, ct, skey)) }            \
+static int s_ecb_decrypt_##n(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey)         \
+{ S_ACCOUNT(int, cipher, n, s_cipher[n].block_length, s_cipher[n].ecb_decrypt(ct, pt, skey)) }            \
+static int s_accel_ecb_encrypt_##n(const unsigned char *pt, unsigned char *ct, unsigned long blocks,        \
+                                   symmetric_key *skey)                                                     \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks), s_cipher[n].accel_ecb_encrypt(pt, ct, blocks, skey)) }   \
+static int s_accel_ecb_decrypt_##n(const unsigned char *ct, unsigned char *pt, unsigned long blocks,        \
+                                   symmetric_key *skey)                                                     \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks), s_cipher[n].accel_ecb_decrypt(ct, pt, blocks, skey)) }   \
+static int s_accel_cbc_encrypt_##n(const unsigned char *pt, unsigned char *ct, unsigned long blocks,        \
+                                   unsigned char *IV, symmetric_key *skey)                                  \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks), s_cipher[n].accel_cbc_encrypt(pt, ct, blocks, IV, skey)) } \
+static int s_accel_cbc_decrypt_##n(const unsigned char *ct, unsigned char *pt, unsigned long blocks,        \
+                                   unsigned char *IV, symmetric_key *skey)                                  \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks), s_cipher[n].accel_cbc_decrypt(ct, pt, blocks, IV, skey)) } \
+static int s_accel_ctr_encrypt_##n(const unsigned char *pt, unsigned char *ct, unsigned long blocks,        \
+                                   unsigned char *IV, int mode, symmetric_key *skey)                        \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks),                                                            \
+            s_cipher[n].accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey)) }                                \
+static int s_accel_lrw_encrypt_##n(const unsigned char *pt, unsigned char *ct, unsigned long blocks,        \
+                                   unsigned char *IV, const unsigned char *tweak, symmetric_key *skey)      \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks),                                                            \
+            s_cipher[n].accel_lrw_encrypt(pt, ct, blocks, IV, tweak, skey)) }                               \
+static int s_accel_lrw_decrypt_##n(const unsigned char *ct, unsigned char *pt, unsigned long blocks,        \
+                                   unsigned char *IV, const unsigned char *tweak, symmetric_key *skey)      \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks),                                                            \
+            s_cipher[n].accel_lrw_decrypt(ct, pt, blocks, IV, tweak, skey)) }                               \
+static int s_accel_ccm_memory_##n(const unsigned char *key, unsigned long keylen, symmetric_key *uskey,     \
+                                  const unsigned char *nonce, unsigned long noncelen,                       \
+                                  const unsigned char *header, unsigned long headerlen,                     \
+                                  unsigned char *pt, unsigned long ptlen, unsigned char *ct,                \
+                                  unsigned char *tag, unsigned long *taglen, int direction)                 \
+{ S_ACCOUNT(int, cipher, n, ptlen + headerlen,                                                              \
+            s_cipher[n].accel_ccm_memory(key, keylen, uskey, nonce, noncelen, header, headerlen,            \
+                                         pt, ptlen, ct, tag, taglen, direction)) }                          \
+static int s_accel_gcm_memory_##n(const unsigned char *key, unsigned long keylen,                           \
+                                  const unsigned char *IV, unsigned long IVlen,                             \
+                                  const unsigned char *adata, unsigned long adatalen,                       \
+                                  unsigned char *pt, unsigned long ptlen, unsigned char *ct,                \
+                                  unsigned char *tag, unsigned long *taglen, int direction)                 \
+{ S_ACCOUNT(int, cipher, n, ptlen + adatalen,                                                               \
+            s_cipher[n].accel_gcm_memory(key, keylen, IV, IVlen, adata, adatalen,                           \
+                                         pt, ptlen, ct, tag, taglen, direction)) }                          \
+static int s_omac_memory_##n(const unsigned char *key, unsigned long keylen,                                \
+                             const unsigned char *in, unsigned long inlen,                                  \
+                             unsigned char *out, unsigned long *outlen)                                     \
+{ S_ACCOUNT(int, cipher, n, inlen, s_cipher[n].omac_memory(key, keylen, in, inlen, out, outlen)) }        \
+static int s_xcbc_memory_##n(const unsigned char *key, unsigned long keylen,                                \
+                             const unsigned char *in, unsigned long inlen,                                  \
+                             unsigned char *out, unsigned long *outlen)                                     \
+{ S_ACCOUNT(int, cipher, n, inlen, s_cipher[n].xcbc_memory(key, keylen, in, inlen, out, outlen)) }        \
+static int s_f9_memory_##n(const unsigned char *key, unsigned long keylen,                                  \
+                           const unsigned char *in, unsigned long inlen,                                    \
+                           unsigned char *out, unsigned long *outlen)                                       \
+{ S_ACCOUNT(int, cipher, n, inlen, s_cipher[n].f9_memory(key, keylen, in, inlen, out, outlen)) }          \
+static int s_accel_xts_encrypt_##n(const unsigned char *pt, unsigned char *ct, unsigned long blocks,        \
+                                   unsigned char *tweak, const symmetric_key *skey1,                        \
+                                   const symmetric_key *skey2)                                              \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks),                                                            \
+            s_cipher[n].accel_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2)) }                           \
+static int s_accel_xts_decrypt_##n(const unsigned char *ct, unsigned char *pt, unsigned long blocks,        \
+                                   unsigned char *tweak, const symmetric_key *skey1,                        \
+                                   const symmetric_key *skey2)                                              \
+{ S_ACCOUNT(int, cipher, n, S_BLOCKS(n, blocks),                                                            \
+            s_cipher[n].accel_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2)) }                           \
+static void s_wrap_cipher_##n(struct ltc_cipher_descriptor *d)                                              \
+{                                                                                                           \
+   if (d->setup != NULL)             d->setup             = s_setup_##n;                                    \
+   if (d->ecb_encrypt != NULL)       d->ecb_encrypt       = s_ecb_encrypt_##n;                              \
+   if (d->ecb_decrypt != NULL)       d->ecb_decrypt       = s_ecb_decrypt_##n;                              \
+   if (d->accel_ecb_encrypt != NULL) d->accel_ecb_encrypt = s_accel_ecb_encrypt_##n;                        \
+   if (d->accel_ecb_decrypt != NULL) d->accel_ecb_decrypt = s_accel_ecb_decrypt_##n;                        \
+   if (d->accel_cbc_encrypt != NULL) d->accel_cbc_encrypt = s_accel_cbc_encrypt_##n;                        \
+   if (d->accel_cbc_decrypt != NULL) d->accel_cbc_decrypt = s_accel_cbc_decrypt_##n;                        \
+   if (d->accel_ctr_encrypt != NULL) d->accel_ctr_encrypt = s_accel_ctr_encrypt_##n;                        \
+   if (d->accel_lrw_encrypt != NULL) d->accel_lrw_encrypt = s_accel_lrw_encrypt_##n;                        \
+   if (d->accel_lrw_decrypt != NULL) d->accel_lrw_decrypt = s_accel_lrw_decrypt_##n;                        \
+   if (d->accel_ccm_memory != NULL)  d->accel_ccm_memory  = s_accel_ccm_memory_##n;                         \
+   if (d->accel_gcm_memory != NULL)  d->accel_gcm_memory  = s_accel_gcm_memory_##n;                         \
+   if (d->omac_memory != NULL)       d->omac_memory       = s_omac_memory_##n;                              \
+   if (d->xcbc_memory != NULL)       d->xcbc_memory       = s_xcbc_memory_##n;                              \
+   if (d->f9_memory != NULL)         d->f9_memory         = s_f9_memory_##n;                                \
+   if (d->accel_xts_encrypt != NULL) d->accel_xts_encrypt = s_accel_xts_encrypt_##n;                        \
+   if (d->accel_xts_decrypt != NULL) d->accel_xts_decrypt = s_accel_xts_decrypt_##n;                        \
+}
+
+#define S_HASH(n)                                                                                           \
+static int s_init_##n(hash_state *md)                                                                       \
+{ S_ACCOUNT(int, hash, n, 0, s_hash[n].init(md)) }                                                          \
+static int s_process_##n(hash_state *md, const unsigned char *in, unsigned long inlen)                      \
+{ S_ACCOUNT(int, hash, n, inlen, s_hash[n].process(md, in, inlen)) }                                        \
+static int s_done_##n(hash_state *md, unsigned char *out)                                                   \
+{ S_ACCOUNT(int, hash, n, 0, s_hash[n].done(md, out)) }                                                     \
+static int s_hmac_block_##n(const unsigned char *key, unsigned long keylen,                                 \
+                            const unsigned char *in, unsigned long inlen,                                   \
+                            unsigned char *out, unsigned long *outlen)                                      \
+{ S_ACCOUNT(int, hash, n, inlen, s_hash[n].hmac_block(key, keylen, in, inlen, out, outlen)) }               \
+static int s_process_iov_##n(hash_state *md, const ltc_iovec *iov, unsigned long iovcnt)                    \
+{ S_ACCOUNT(int, hash, n, s_iov_bytes(iov, iovcnt), s_hash[n].process_iov(md, iov, iovcnt)) }               \
+static void s_wrap_hash_##n(struct ltc_hash_descriptor *d)                                                  \
+{                                                                                                           \
+   if (d->init != NULL)       d->init       = s_init_##n;                                                   \
+   if (d->process != NULL)    d->process    = s_process_##n;                                                \
+   if (d->done != NULL)       d->done       = s_done_##n;                                                   \
+   if (d->hmac_block != NULL) d->hmac_block = s_hmac_block_##n;                                             \
+   if (d->process_iov != NULL) d->process_iov = s_process_iov_##n;                                          \
+}
+
+#define S_PRNG(n)                                                                                           \
+static int s_add_entropy_##n(const unsigned char *in, unsigned long inlen, prng_state *prng)                \
+{ S_ACCOUNT(int, prng, n, inlen, s_prng[n].add_entropy(in, inlen, prng)) }                                  \
+static int s_ready_##n(prng_state *prng)                                                                    \
+{ S_ACCOUNT(int, prng, n, 0, s_prng[n].ready(prng)) }                                                       \
+static unsigned long s_read_##n(unsigned char *out, unsigned long outlen, prng_state *prng)                 \
+{ S_ACCOUNT(unsigned long, prng, n, res, s_prng[n].read(out, outlen, prng)) }                               \
+static void s_wrap_prng_##n(struct ltc_prng_descriptor *d)                                                  \
+{                                                                                                           \
+   if (d->add_entropy != NULL) d->add_entropy = s_add_entropy_##n;                                          \
+   if (d->ready != NULL)       d->ready       = s_ready_##n;                                                \
+   if (d->read != NULL)        d->read        = s_read_##n;                                                 \
+}
+
+S_SLOTS(S_CIPHER)
+S_SLOTS(S_HASH)
+S_SLOTS(S_PRNG)
+
+#define S_WRAP_CIPHER(n) s_wrap_cipher_##n,
+#define S_WRAP_HASH(n)   s_wrap_hash_##n,
+#define S_WRAP_PRNG(n)   s_wrap_prng_##n,
+
+static void (*const s_wrap_cipher[LTC_STATS_SLOTS])(struct ltc_cipher_descriptor *) = { S_SLOTS(S_WRAP_CIPHER) };
+static void (*const s_wrap_hash[LTC_STATS_SLOTS])(struct ltc_hash_descriptor *)     = { S_SLOTS(S_WRAP_HASH) };
+static void (*const s_wrap_prng[LTC_STATS_SLOTS])(struct ltc_prng_descriptor *)     = { S_SLOTS(S_WRAP_PRNG) };
+
+/**
+  Instrument a freshly registered cipher, called with ltc_cipher_mutex held
+  @param idx   The table slot it was registered in
+*/
+void crypt_stats_wrap_cipher(int idx)
+{
+   XMEMCPY(&s_cipher[idx], &cipher_descriptor[idx], sizeof(struct ltc_cipher_descriptor));
+   s_wrap_cipher[idx](&cipher_descriptor[idx]);
+}
+
+/**
+  Instrument a freshly registered hash, called with ltc_hash_mutex held
+  @param idx   The table slot it was registered in
+*/
+void crypt_stats_wrap_hash(int idx)
+{
+   XMEMCPY(&s_hash[idx], &hash_descriptor[idx], sizeof(struct ltc_hash_descriptor));
+   s_wrap_hash[idx](&hash_descriptor[idx]);
+}
+
+/**
+  Instrument a freshly registered PRNG, called with ltc_prng_mutex held
+  @param idx   The table slot it was registered in
+*/
+void crypt_stats_wrap_prng(int idx)
+{
+   XMEMCPY(&s_prng[idx], &prng_descriptor[idx], sizeof(struct ltc_prng_descriptor));
+   s_wrap_prng[idx](&prng_descriptor[idx]);
+}
+
+/**
+  Get the descriptor as it was registered
+  @param idx   The table slot
+  @return The uninstrumented descriptor, only meaningful while the slot is in use
+*/
+const struct ltc_cipher_descriptor *crypt_stats_registered_cipher(int idx)
+{
+   return &s_cipher[idx];
+}
+
+const struct ltc_hash_descriptor *crypt_stats_registered_hash(int idx)
+{
+   return &s_hash[idx];
+}
+
+const struct ltc_prng_descriptor *crypt_stats_registered_prng(int idx)
+{
+   return &s_prng[idx];
+}
+
+#endif /* LTC_STATS */
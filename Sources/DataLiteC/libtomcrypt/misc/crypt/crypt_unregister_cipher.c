@@ -21,7 +21,13 @@ int unregister_cipher(const struct ltc_cipher_descriptor *cipher)
    /* is it already registered? */
    LTC_MUTEX_LOCK(&ltc_cipher_mutex);
    for (x = 0; x < TAB_SIZE; x++) {
+#ifdef LTC_STATS
+       /* the table holds the instrumented copy, compare against what was registered */
+       if (cipher_descriptor[x].name != NULL &&
+           XMEMCMP(crypt_stats_registered_cipher(x), cipher, sizeof(struct ltc_cipher_descriptor)) == 0) {
+#else
        if (XMEMCMP(&cipher_descriptor[x], cipher, sizeof(struct ltc_cipher_descriptor)) == 0) {
+#endif
           cipher_descriptor[x].name = NULL;
           cipher_descriptor[x].ID   = 255;
           LTC_MUTEX_UNLOCK(&ltc_cipher_mutex);
@@ -21,7 +21,13 @@ int unregister_hash(const struct ltc_hash_descriptor *hash)
    /* is it already registered? */
    LTC_MUTEX_LOCK(&ltc_hash_mutex);
    for (x = 0; x < TAB_SIZE; x++) {
+#ifdef LTC_STATS
+       /* the table holds the instrumented copy, compare against what was registered */
+       if (hash_descriptor[x].name != NULL &&
+           XMEMCMP(crypt_stats_registered_hash(x), hash, sizeof(struct ltc_hash_descriptor)) == 0) {
+#else
        if (XMEMCMP(&hash_descriptor[x], hash, sizeof(struct ltc_hash_descriptor)) == 0) {
+#endif
           hash_descriptor[x].name = NULL;
           LTC_MUTEX_UNLOCK(&ltc_hash_mutex);
           return CRYPT_OK;
@@ -21,7 +21,13 @@ int unregister_prng(const struct ltc_prng_descriptor *prng)
    /* is it already registered? */
    LTC_MUTEX_LOCK(&ltc_prng_mutex);
    for (x = 0; x < TAB_SIZE; x++) {
+#ifdef LTC_STATS
+       /* the table holds the instrumented copy, compare against what was registered */
+       if (prng_descriptor[x].name != NULL &&
+           XMEMCMP(crypt_stats_registered_prng(x), prng, sizeof(struct ltc_prng_descriptor)) == 0) {
+#else
        if (XMEMCMP(&prng_descriptor[x], prng, sizeof(struct ltc_prng_descriptor)) == 0) {
+#endif
           prng_descriptor[x].name = NULL;
           LTC_MUTEX_UNLOCK(&ltc_prng_mutex);
           return CRYPT_OK;
@@ -0,0 +1,397 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file file_process.c
+  Feed a file to a process function, the engine behind hash_filehandle() and the *_file() MAC helpers
+
+  Files are read with fread(). When LTC_PTHREAD is enabled, there is more
+  than one CPU and the input is a pipe or the like, or a regular file that
+  takes more than one read of the reader thread, a separate thread reads into
+  two alternating buffers, so that reading the next buffer overlaps with
+  processing the current one. A file that shrinks meanwhile just ends early.
+
+  With LTC_FILE_MMAP regular files are instead mapped into memory a window at
+  a time and handed to the process function without any copy. No check can
+  make that safe against another process truncating the file after it has
+  been mapped, so it is opt-in, see tomcrypt_custom.h.
+*/
+
+#ifndef LTC_NO_FILE
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(LTC_FILE_MMAP)
+#include <sys/mman.h>
+#endif
+#else
+#undef LTC_FILE_MMAP
+#endif
+
+#ifdef LTC_FILE_MMAP
+/**
+  Process the rest of a regular file through mmap()
+  @param in        The file
+  @param process   The process function
+  @param ctx       The context for the process function
+  @param done      [out] Set if the file has been processed up to its end
+  @return CRYPT_OK if successful, if it can't map the file it returns CRYPT_OK with `done` unset
+          and the file positioned at the first octet that hasn't been processed
+*/
+static int s_file_process_mmap(FILE *in, file_process_fn process, void *ctx, int *done)
+{
+   struct stat st;
+   off_t pos, base, end;
+   size_t len;
+   long page;
+   void *p;
+   int fd, err;
+
+   *done = 0;
+   fd = fileno(in);
+   if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      return CRYPT_OK;
+   }
+   if ((pos = ftello(in)) < 0 || (page = sysconf(_SC_PAGESIZE)) <= 0) {
+      return CRYPT_OK;
+   }
+
+   end = st.st_size;
+   while (pos < end) {
+      /* the offset of a mapping has to be page aligned */
+      base = pos - pos % page;
+      len = (size_t)MIN((ulong64)(end - base), (ulong64)LTC_FILE_MMAP_WINDOW);
+      p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, base);
+      if (p == MAP_FAILED) {
+         /* let the caller read the rest */
+         return fseeko(in, pos, SEEK_SET) == 0 ? CRYPT_OK : CRYPT_ERROR;
+      }
+#if defined(MADV_SEQUENTIAL)
+      (void)madvise(p, len, MADV_SEQUENTIAL);
+#endif
+      err = process(ctx, (const unsigned char *)p + (pos - base), (unsigned long)(len - (size_t)(pos - base)));
+      munmap(p, len);
+      if (err != CRYPT_OK) {
+         return err;
+      }
+      pos = base + (off_t)len;
+   }
+
+   /* leave the file where fread() would have */
+   if (fseeko(in, end, SEEK_SET) != 0) {
+      return CRYPT_ERROR;
+   }
+   *done = 1;
+   return CRYPT_OK;
+}
+#endif /* LTC_FILE_MMAP */
+
+#ifdef LTC_PTHREAD
+/* each hand-over between the threads costs a wake-up, so the reader works in larger pieces */
+#define FILE_READER_BUFSIZE (32uL * LTC_FILE_READ_BUFSIZE)
+
+typedef struct {
+   FILE            *in;
+   unsigned char   *buf[2];
+   size_t           len[2];
+   size_t           used[2];    /* the most buf[i] has held, what has to be wiped */
+   int              full[2];    /* buf[i] holds data that hasn't been processed yet */
+   int              stop;       /* the consumer has given up */
+   pthread_mutex_t  lock;
+   pthread_cond_t   cond;
+} file_reader;
+
+static void *s_file_reader(void *arg)
+{
+   file_reader *r = arg;
+   size_t x;
+   int i = 0;
+
+   for (;;) {
+      pthread_mutex_lock(&r->lock);
+      while (r->full[i] && !r->stop) {
+         pthread_cond_wait(&r->cond, &r->lock);
+      }
+      if (r->stop) {
+         pthread_mutex_unlock(&r->lock);
+         break;
+      }
+      pthread_mutex_unlock(&r->lock);
+
+      x = fread(r->buf[i], 1, FILE_READER_BUFSIZE, r->in);
+
+      pthread_mutex_lock(&r->lock);
+      r->len[i]  = x;
+      r->used[i] = MAX(r->used[i], x);
+      r->full[i] = 1;
+      pthread_cond_signal(&r->cond);
+      pthread_mutex_unlock(&r->lock);
+
+      if (x != FILE_READER_BUFSIZE) {
+         break;
+      }
+      i ^= 1;
+   }
+
+   return NULL;
+}
+
+static long s_file_cpus = 1;
+static pthread_once_t s_file_cpus_once = PTHREAD_ONCE_INIT;
+
+static void s_file_cpus_init(void)
+{
+#if defined(_SC_NPROCESSORS_ONLN)
+   s_file_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+/* is a reader thread worth starting for the rest of the file? */
+static int s_file_overlap(FILE *in)
+{
+   struct stat st;
+   off_t pos;
+   int fd;
+
+   /* nothing to overlap with on a single CPU */
+   (void)pthread_once(&s_file_cpus_once, s_file_cpus_init);
+   if (s_file_cpus < 2) {
+      return 0;
+   }
+   if ((fd = fileno(in)) < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      return 1;
+   }
+   /* a single read of the reader thread would just be done on another thread */
+   if ((pos = ftello(in)) < 0) {
+      pos = 0;
+   }
+   return st.st_size - pos > (off_t)FILE_READER_BUFSIZE;
+}
+
+/**
+  Process the rest of a file with a reader thread and two buffers
+  @param in        The file
+  @param process   The process function
+  @param ctx       The context for the process function
+  @param done      [out] Set if the reader thread has been used
+  @return CRYPT_OK if successful
+*/
+static int s_file_process_threaded(FILE *in, file_process_fn process, void *ctx, int *done)
+{
+   file_reader r;
+   pthread_t thread;
+   unsigned char *buf;
+   size_t x;
+   int i = 0, err = CRYPT_OK;
+
+   *done = 0;
+   if (!s_file_overlap(in)) {
+      return CRYPT_OK;
+   }
+   if ((buf = XMALLOC(2 * FILE_READER_BUFSIZE)) == NULL) {
+      return CRYPT_MEM;
+   }
+   XMEMSET(&r, 0, sizeof(r));
+   r.in     = in;
+   r.buf[0] = buf;
+   r.buf[1] = buf + FILE_READER_BUFSIZE;
+   if (pthread_mutex_init(&r.lock, NULL) != 0) {
+      goto LBL_FREE;
+   }
+   if (pthread_cond_init(&r.cond, NULL) != 0) {
+      pthread_mutex_destroy(&r.lock);
+      goto LBL_FREE;
+   }
+   if (pthread_create(&thread, NULL, s_file_reader, &r) != 0) {
+      pthread_cond_destroy(&r.cond);
+      pthread_mutex_destroy(&r.lock);
+      goto LBL_FREE;
+   }
+   *done = 1;
+
+   for (;;) {
+      pthread_mutex_lock(&r.lock);
+      while (!r.full[i]) {
+         pthread_cond_wait(&r.cond, &r.lock);
+      }
+      x = r.len[i];
+      pthread_mutex_unlock(&r.lock);
+
+      err = process(ctx, r.buf[i], (unsigned long)x);
+
+      pthread_mutex_lock(&r.lock);
+      r.full[i] = 0;
+      if (err != CRYPT_OK) {
+         r.stop = 1;
+      }
+      pthread_cond_signal(&r.cond);
+      pthread_mutex_unlock(&r.lock);
+
+      if (err != CRYPT_OK || x != FILE_READER_BUFSIZE) {
+         break;
+      }
+      i ^= 1;
+   }
+
+   pthread_join(thread, NULL);
+   pthread_cond_destroy(&r.cond);
+   pthread_mutex_destroy(&r.lock);
+LBL_FREE:
+   zeromem(r.buf[0], r.used[0]);
+   zeromem(r.buf[1], r.used[1]);
+   XFREE(buf);
+   return err;
+}
+#endif /* LTC_PTHREAD */
+
+/**
+  Feed everything from the current position to the end of a file to a process function
+  @param in        The file
+  @param process   The process function, called with `ctx` and consecutive pieces of the file
+  @param ctx       The context for the process function
+  @return CRYPT_OK if successful
+*/
+int file_process(FILE *in, file_process_fn process, void *ctx)
+{
+   unsigned char *buf;
+   size_t x;
+   int err;
+#if defined(LTC_FILE_MMAP) || defined(LTC_PTHREAD)
+   int done;
+#endif
+
+   LTC_ARGCHK(in      != NULL);
+   LTC_ARGCHK(process != NULL);
+
+#ifdef LTC_FILE_MMAP
+   if ((err = s_file_process_mmap(in, process, ctx, &done)) != CRYPT_OK || done) {
+      return err;
+   }
+#endif
+#ifdef LTC_PTHREAD
+   if ((err = s_file_process_threaded(in, process, ctx, &done)) != CRYPT_OK || done) {
+      return err == CRYPT_OK && ferror(in) ? CRYPT_ERROR : err;
+   }
+#endif
+
+   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
+      return CRYPT_MEM;
+   }
+
+   do {
+      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
+      if ((err = process(ctx, buf, (unsigned long)x)) != CRYPT_OK) {
+         goto LBL_CLEANBUF;
+      }
+   } while (x == LTC_FILE_READ_BUFSIZE);
+
+LBL_CLEANBUF:
+   if (err == CRYPT_OK && ferror(in)) {
+      err = CRYPT_ERROR;
+   }
+   zeromem(buf, LTC_FILE_READ_BUFSIZE);
+   XFREE(buf);
+   return err;
+}
+
+/**
+  Open a file, feed all of it to a process function and close it again
+  @param fname     The name of the file
+  @param process   The process function, called with `ctx` and consecutive pieces of the file
+  @param ctx       The context for the process function
+  @return CRYPT_OK if successful
+*/
+int file_process_name(const char *fname, file_process_fn process, void *ctx)
+{
+   FILE *in;
+   int err;
+
+   LTC_ARGCHK(fname != NULL);
+
+   in = fopen(fname, "rb");
+   if (in == NULL) {
+      return CRYPT_FILE_NOTFOUND;
+   }
+
+   err = file_process(in, process, ctx);
+   if (fclose(in) != 0 && err == CRYPT_OK) {
+      err = CRYPT_ERROR;
+   }
+
+   return err;
+}
+
+#if defined(LTC_TEST) && (defined(__unix__) || defined(__APPLE__))
+typedef struct {
+   FILE          *in;
+   unsigned long  total;
+   unsigned char  sum;
+} file_process_test_ctx;
+
+/* cut the file down to one octet while the first piece is processed, then read all of it */
+static int s_file_process_truncate(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   file_process_test_ctx *t = ctx;
+   unsigned long x;
+
+   if (t->total == 0 && ftruncate(fileno(t->in), 1) != 0) {
+      return CRYPT_ERROR;
+   }
+   for (x = 0; x < inlen; x++) {
+      t->sum ^= in[x];
+   }
+   t->total += inlen;
+   return CRYPT_OK;
+}
+#endif
+
+/**
+  Check that a file which is truncated while it is processed just ends early
+  @return CRYPT_OK if successful, CRYPT_NOP if self-testing has been disabled
+*/
+int file_process_test(void)
+{
+#if !defined(LTC_TEST) || !(defined(__unix__) || defined(__APPLE__))
+   return CRYPT_NOP;
+#else
+   /* larger than what the threaded reader has in flight */
+   const unsigned long size = 4uL * 32uL * LTC_FILE_READ_BUFSIZE;
+   file_process_test_ctx t;
+   unsigned char buf[256];
+   unsigned long x;
+   int err;
+
+   XMEMSET(&t, 0, sizeof(t));
+   if ((t.in = tmpfile()) == NULL) {
+      return CRYPT_NOP;
+   }
+   for (x = 0; x < sizeof(buf); x++) {
+      buf[x] = (unsigned char)x;
+   }
+   for (x = 0; x < size; x += sizeof(buf)) {
+      if (fwrite(buf, 1, sizeof(buf), t.in) != sizeof(buf)) {
+         err = CRYPT_ERROR;
+         goto LBL_ERR;
+      }
+   }
+   if (fflush(t.in) != 0 || fseek(t.in, 0, SEEK_SET) != 0) {
+      err = CRYPT_ERROR;
+      goto LBL_ERR;
+   }
+
+   if ((err = file_process(t.in, s_file_process_truncate, &t)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   if (t.total == 0 || t.total >= size) {
+      err = CRYPT_FAIL_TESTVECTOR;
+   }
+
+LBL_ERR:
+   fclose(t.in);
+   return err;
+#endif
+}
+
+#endif /* LTC_NO_FILE */
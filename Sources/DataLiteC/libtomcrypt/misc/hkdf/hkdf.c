@@ -57,7 +57,9 @@ int hkdf_expand(int hash_idx, const unsigned char *info, unsigned long infolen,
    LTC_ARGCHK(out != NULL);
 
    Tlen = hashsize + infolen + 1;
+   LTC_STATS_ENTER(hash, hash_idx);
    T = XMALLOC(Tlen); /* Replace with static buffer? */
+   LTC_STATS_LEAVE();
    if (T == NULL) {
       return CRYPT_MEM;
    }
@@ -115,7 +117,9 @@ int hkdf(int hash_idx, const unsigned char *salt, unsigned long saltlen,
 
    hashsize = hash_descriptor[hash_idx].hashsize;
 
+   LTC_STATS_ENTER(hash, hash_idx);
    extracted = XMALLOC(hashsize); /* replace with static buffer? */
+   LTC_STATS_LEAVE();
    if (extracted == NULL) {
       return CRYPT_MEM;
    }
@@ -1,5 +1,7 @@
 /* LibTomCrypt, modular cryptographic library -- Tom St Denis */
 /* SPDX-License-Identifier: Unlicense */
+/* the password was allocated by the caller's callback, so free it with the public XFREE */
+#define LTC_SECMEM_REAL_ALLOC
 #include "tomcrypt_private.h"
 
 /**
@@ -617,10 +617,15 @@ static int s_decrypt_private_keys(unsigned char *in, unsigned long *inlen,
       return CRYPT_OVERFLOW;
    }
 
+#ifdef LTC_BCRYPT
    if ((err = bcrypt_pbkdf_openbsd(opts->pw.pw, opts->pw.l, opts->salt, opts->saltlen,
                                    opts->num_rounds, find_hash("sha512"), symkey, &symkey_len)) != CRYPT_OK) {
       return err;
    }
+#else
+   /* the only KDF of encrypted OpenSSH keys is bcrypt, without it they can't be decrypted */
+   return CRYPT_INVALID_CIPHER;
+#endif
    err = pem_decrypt(in, inlen,
                      symkey, opts->cipher->keylen,
                      iv, iv_len,
@@ -60,8 +60,10 @@ static int s_pkcs_5_alg1_common(const unsigned char *password,
    }
 
    /* allocate memory */
+   LTC_STATS_ENTER(hash, hash_idx);
    md  = XMALLOC(sizeof(hash_state));
    buf = XMALLOC(MAXBLOCKSIZE);
+   LTC_STATS_LEAVE();
    if (md == NULL || buf == NULL) {
       if (md != NULL) {
          XFREE(md);
@@ -27,9 +27,10 @@ int pkcs_5_alg2(const unsigned char *password, unsigned long password_len,
 {
    int err, itts;
    ulong32  blkno;
-   unsigned long stored, left, x, y;
+   unsigned long stored, left, x, y, hashsize;
    unsigned char *buf[2];
    hmac_state    *hmac;
+   hash_state    *md;
 
    LTC_ARGCHK(password != NULL);
    LTC_ARGCHK(salt     != NULL);
@@ -44,21 +45,57 @@ int pkcs_5_alg2(const unsigned char *password, unsigned long password_len,
    if ((err = hash_is_valid(hash_idx)) != CRYPT_OK) {
       return err;
    }
+   hashsize = hash_descriptor[hash_idx].hashsize;
 
+#ifdef LTC_PKCS_5_CACHE
+   if (pkcs_5_alg2_cache_get(password, password_len, salt, salt_len,
+                             iteration_count, hash_idx, out, *outlen) == CRYPT_OK) {
+      return CRYPT_OK;
+   }
+#endif
+
+   LTC_STATS_ENTER(hash, hash_idx);
    buf[0] = XMALLOC(MAXBLOCKSIZE * 2);
    hmac   = XMALLOC(sizeof(hmac_state));
-   if (hmac == NULL || buf[0] == NULL) {
+   md     = XMALLOC(sizeof(hash_state) * 3);
+   LTC_STATS_LEAVE();
+   if (hmac == NULL || buf[0] == NULL || md == NULL) {
       if (hmac != NULL) {
          XFREE(hmac);
       }
       if (buf[0] != NULL) {
          XFREE(buf[0]);
       }
+      if (md != NULL) {
+         XFREE(md);
+      }
       return CRYPT_MEM;
    }
    /* buf[1] points to the second block of MAXBLOCKSIZE bytes */
    buf[1] = buf[0] + MAXBLOCKSIZE;
 
+   /* The password is the HMAC key of every PRF invocation, so the hash states
+    * after absorbing the inner (ipad) and outer (opad) key blocks are computed
+    * once: md[0] is the inner state, md[1] the outer state, md[2] scratch.
+    * Each iteration then costs two finalizations instead of a full HMAC
+    * (key schedule, two extra compressions and two heap allocations).
+    */
+   if (hash_descriptor[hash_idx].hmac_block == NULL) {
+      if ((err = hmac_init(hmac, hash_idx, password, password_len)) != CRYPT_OK) {
+         goto LBL_ERR;
+      }
+      md[0] = hmac->md;
+      for (y = 0; y < hash_descriptor[hash_idx].blocksize; y++) {
+         buf[0][y] = hmac->key[y] ^ 0x5C;
+      }
+      if ((err = hash_descriptor[hash_idx].init(&md[1])) != CRYPT_OK) {
+         goto LBL_ERR;
+      }
+      if ((err = hash_descriptor[hash_idx].process(&md[1], buf[0], hash_descriptor[hash_idx].blocksize)) != CRYPT_OK) {
+         goto LBL_ERR;
+      }
+   }
+
    left   = *outlen;
    blkno  = 1;
    stored = 0;
@@ -88,8 +125,26 @@ int pkcs_5_alg2(const unsigned char *password, unsigned long password_len,
        /* now compute repeated and XOR it in buf[1] */
        XMEMCPY(buf[1], buf[0], x);
        for (itts = 1; itts < iteration_count; ++itts) {
-           if ((err = hmac_memory(hash_idx, password, password_len, buf[0], x, buf[0], &x)) != CRYPT_OK) {
-              goto LBL_ERR;
+           if (hash_descriptor[hash_idx].hmac_block != NULL) {
+              if ((err = hmac_memory(hash_idx, password, password_len, buf[0], x, buf[0], &x)) != CRYPT_OK) {
+                 goto LBL_ERR;
+              }
+           } else {
+              /* U_i = H(K ^ opad || H(K ^ ipad || U_{i-1})) */
+              md[2] = md[0];
+              if ((err = hash_descriptor[hash_idx].process(&md[2], buf[0], x)) != CRYPT_OK) {
+                 goto LBL_ERR;
+              }
+              if ((err = hash_descriptor[hash_idx].done(&md[2], buf[0])) != CRYPT_OK) {
+                 goto LBL_ERR;
+              }
+              md[2] = md[1];
+              if ((err = hash_descriptor[hash_idx].process(&md[2], buf[0], hashsize)) != CRYPT_OK) {
+                 goto LBL_ERR;
+              }
+              if ((err = hash_descriptor[hash_idx].done(&md[2], buf[0])) != CRYPT_OK) {
+                 goto LBL_ERR;
+              }
            }
            for (y = 0; y < x; y++) {
                buf[1][y] ^= buf[0][y];
@@ -104,13 +159,21 @@ int pkcs_5_alg2(const unsigned char *password, unsigned long password_len,
    }
    *outlen = stored;
 
+#ifdef LTC_PKCS_5_CACHE
+   pkcs_5_alg2_cache_put(password, password_len, salt, salt_len,
+                         iteration_count, hash_idx, out, stored);
+#endif
+
    err = CRYPT_OK;
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(buf[0], MAXBLOCKSIZE*2);
    zeromem(hmac, sizeof(hmac_state));
 #endif
+   /* the pre-keyed states are as sensitive as the password itself */
+   zeromem(md, sizeof(hash_state) * 3);
 
+   XFREE(md);
    XFREE(hmac);
    XFREE(buf[0]);
 
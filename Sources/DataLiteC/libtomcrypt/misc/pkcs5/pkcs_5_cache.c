@@ -0,0 +1,275 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+   @file pkcs_5_cache.c
+   Process-wide cache of PKCS #5 v2 derived keys
+*/
+#ifdef LTC_PKCS_5_CACHE
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define LTC_PKCS_5_CACHE_MLOCK
+#endif
+
+/** The cache, an entry is only valid while `hash` is not NULL */
+static struct {
+   unsigned char  id[MAXBLOCKSIZE];   /* H(salt || password) */
+   unsigned char  salt[MAXBLOCKSIZE];
+   unsigned char  key[MAXBLOCKSIZE];
+   unsigned long  idlen, salt_len, key_len;
+   const char    *hash;               /* name of the PRF hash */
+   int            iteration_count;
+   time_t         created, used;
+} pkcs_5_cache[LTC_PKCS_5_CACHE_ENTRIES];
+
+static unsigned long pkcs_5_cache_entries = LTC_PKCS_5_CACHE_INITIAL_ENTRIES;
+static unsigned long pkcs_5_cache_ttl     = LTC_PKCS_5_CACHE_TTL;
+/* lookups while the cache was enabled, see pkcs_5_alg2_cache_status() */
+static unsigned long pkcs_5_cache_hits     = 0;
+static unsigned long pkcs_5_cache_misses   = 0;
+#ifdef LTC_PKCS_5_CACHE_MLOCK
+static int           pkcs_5_cache_locked  = 0;
+#endif
+
+LTC_MUTEX_GLOBAL(ltc_pkcs_5_cache_lock)
+
+static void s_pkcs_5_cache_lock_memory(void)
+{
+#ifdef LTC_PKCS_5_CACHE_MLOCK
+   /* best effort, an unlocked cache still works, it just may be swapped out */
+   if (pkcs_5_cache_locked == 0) {
+      (void)mlock(pkcs_5_cache, sizeof(pkcs_5_cache));
+      pkcs_5_cache_locked = 1;
+   }
+#endif
+}
+
+/* a disabled cache costs a lock, not a hash of the password */
+static int s_pkcs_5_cache_enabled(void)
+{
+   unsigned long entries;
+
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   entries = pkcs_5_cache_entries;
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+   return entries != 0;
+}
+
+static void s_pkcs_5_cache_evict(unsigned long x)
+{
+   zeromem(&pkcs_5_cache[x], sizeof(pkcs_5_cache[x]));
+}
+
+static int s_pkcs_5_cache_id(const unsigned char *password, unsigned long password_len,
+                             const unsigned char *salt,     unsigned long salt_len,
+                             int hash_idx,
+                             unsigned char *id,             unsigned long *idlen)
+{
+   *idlen = MAXBLOCKSIZE;
+   return hash_memory_multi(hash_idx, id, idlen,
+                            salt, salt_len,
+                            password, password_len,
+                            LTC_NULL);
+}
+
+/* find a live entry matching the request, expired entries are wiped on the way */
+static int s_pkcs_5_cache_find(const unsigned char *id,   unsigned long idlen,
+                               const unsigned char *salt, unsigned long salt_len,
+                               int iteration_count,       int hash_idx,
+                               unsigned long key_len,     time_t now)
+{
+   unsigned long x;
+
+   for (x = 0; x < pkcs_5_cache_entries; x++) {
+      if (pkcs_5_cache[x].hash == NULL) {
+         continue;
+      }
+      if (pkcs_5_cache_ttl != 0 && (unsigned long)(now - pkcs_5_cache[x].created) >= pkcs_5_cache_ttl) {
+         s_pkcs_5_cache_evict(x);
+         continue;
+      }
+      if (pkcs_5_cache[x].iteration_count != iteration_count ||
+          pkcs_5_cache[x].key_len != key_len ||
+          pkcs_5_cache[x].salt_len != salt_len ||
+          pkcs_5_cache[x].idlen != idlen ||
+          XSTRCMP(pkcs_5_cache[x].hash, hash_descriptor[hash_idx].name) != 0) {
+         continue;
+      }
+      if (XMEM_NEQ(pkcs_5_cache[x].salt, salt, salt_len) == 0 &&
+          XMEM_NEQ(pkcs_5_cache[x].id, id, idlen) == 0) {
+         return (int)x;
+      }
+   }
+   return -1;
+}
+
+/**
+   Look up a derived key in the cache
+   @param password          The input password (or key)
+   @param password_len      The length of the password (octets)
+   @param salt              The salt (or nonce)
+   @param salt_len          The length of the salt (octets)
+   @param iteration_count   # of iterations of the derivation
+   @param hash_idx          The index of the hash of the derivation
+   @param out               [out] The derived key
+   @param outlen            The length of the derived key (octets)
+   @return CRYPT_OK on a cache hit
+*/
+int pkcs_5_alg2_cache_get(const unsigned char *password, unsigned long password_len,
+                          const unsigned char *salt,     unsigned long salt_len,
+                          int iteration_count,           int hash_idx,
+                          unsigned char *out,            unsigned long outlen)
+{
+   unsigned char id[MAXBLOCKSIZE];
+   unsigned long idlen;
+   time_t now;
+   int err, x;
+
+   if (salt_len > MAXBLOCKSIZE || outlen > MAXBLOCKSIZE || !s_pkcs_5_cache_enabled()) {
+      return CRYPT_NOP;
+   }
+   if ((err = s_pkcs_5_cache_id(password, password_len, salt, salt_len, hash_idx, id, &idlen)) != CRYPT_OK) {
+      return err;
+   }
+
+   now = time(NULL);
+   err = CRYPT_NOP;
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   x = s_pkcs_5_cache_find(id, idlen, salt, salt_len, iteration_count, hash_idx, outlen, now);
+   if (x >= 0) {
+      XMEMCPY(out, pkcs_5_cache[x].key, outlen);
+      pkcs_5_cache[x].used = now;
+      pkcs_5_cache_hits++;
+      err = CRYPT_OK;
+   } else {
+      pkcs_5_cache_misses++;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+
+   zeromem(id, sizeof(id));
+   return err;
+}
+
+/**
+   Store a derived key in the cache, evicting the least recently used entry if full
+   @param password          The input password (or key)
+   @param password_len      The length of the password (octets)
+   @param salt              The salt (or nonce)
+   @param salt_len          The length of the salt (octets)
+   @param iteration_count   # of iterations of the derivation
+   @param hash_idx          The index of the hash of the derivation
+   @param key               The derived key
+   @param keylen            The length of the derived key (octets)
+*/
+void pkcs_5_alg2_cache_put(const unsigned char *password, unsigned long password_len,
+                           const unsigned char *salt,     unsigned long salt_len,
+                           int iteration_count,           int hash_idx,
+                           const unsigned char *key,      unsigned long keylen)
+{
+   unsigned char id[MAXBLOCKSIZE];
+   unsigned long idlen, x, y;
+   time_t now;
+
+   if (salt_len > MAXBLOCKSIZE || keylen > MAXBLOCKSIZE || !s_pkcs_5_cache_enabled()) {
+      return;
+   }
+   if (s_pkcs_5_cache_id(password, password_len, salt, salt_len, hash_idx, id, &idlen) != CRYPT_OK) {
+      return;
+   }
+
+   now = time(NULL);
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   if (pkcs_5_cache_entries != 0 &&
+       s_pkcs_5_cache_find(id, idlen, salt, salt_len, iteration_count, hash_idx, keylen, now) < 0) {
+      s_pkcs_5_cache_lock_memory();
+
+      /* pick a free slot, or else the least recently used one */
+      for (x = y = 0; x < pkcs_5_cache_entries; x++) {
+         if (pkcs_5_cache[x].hash == NULL) {
+            y = x;
+            break;
+         }
+         if (pkcs_5_cache[x].used < pkcs_5_cache[y].used) {
+            y = x;
+         }
+      }
+      s_pkcs_5_cache_evict(y);
+
+      XMEMCPY(pkcs_5_cache[y].id, id, idlen);
+      XMEMCPY(pkcs_5_cache[y].salt, salt, salt_len);
+      XMEMCPY(pkcs_5_cache[y].key, key, keylen);
+      pkcs_5_cache[y].idlen           = idlen;
+      pkcs_5_cache[y].salt_len        = salt_len;
+      pkcs_5_cache[y].key_len         = keylen;
+      pkcs_5_cache[y].iteration_count = iteration_count;
+      pkcs_5_cache[y].created         = now;
+      pkcs_5_cache[y].used            = now;
+      pkcs_5_cache[y].hash            = hash_descriptor[hash_idx].name;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+
+   zeromem(id, sizeof(id));
+}
+
+/**
+   Configure the PKCS #5 v2 derived key cache
+   @param entries   Max. number of cached keys, at most LTC_PKCS_5_CACHE_ENTRIES (0 disables the cache)
+   @param ttl       Lifetime of a cached key in seconds (0 for no expiry)
+   @return CRYPT_OK if successful
+*/
+int pkcs_5_alg2_cache_config(unsigned long entries, unsigned long ttl)
+{
+   unsigned long x;
+
+   if (entries > LTC_PKCS_5_CACHE_ENTRIES) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   for (x = entries; x < LTC_PKCS_5_CACHE_ENTRIES; x++) {
+      s_pkcs_5_cache_evict(x);
+   }
+   pkcs_5_cache_entries = entries;
+   pkcs_5_cache_ttl     = ttl;
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+
+   return CRYPT_OK;
+}
+
+/**
+   Wipe all keys from the PKCS #5 v2 derived key cache
+*/
+void pkcs_5_alg2_cache_purge(void)
+{
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   zeromem(pkcs_5_cache, sizeof(pkcs_5_cache));
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+}
+
+/**
+   Report how many lookups the PKCS #5 v2 derived key cache answered
+   @param hits      [out] Lookups that found the derived key
+   @param misses    [out] Lookups that did not, while the cache was enabled
+   @param reset     Non-zero to reset both counters after reading them
+   @return CRYPT_OK if successful
+*/
+int pkcs_5_alg2_cache_status(unsigned long *hits, unsigned long *misses, int reset)
+{
+   LTC_ARGCHK(hits   != NULL);
+   LTC_ARGCHK(misses != NULL);
+
+   LTC_MUTEX_LOCK(&ltc_pkcs_5_cache_lock);
+   *hits   = pkcs_5_cache_hits;
+   *misses = pkcs_5_cache_misses;
+   if (reset) {
+      pkcs_5_cache_hits   = 0;
+      pkcs_5_cache_misses = 0;
+   }
+   LTC_MUTEX_UNLOCK(&ltc_pkcs_5_cache_lock);
+
+   return CRYPT_OK;
+}
+
+#endif /* LTC_PKCS_5_CACHE */
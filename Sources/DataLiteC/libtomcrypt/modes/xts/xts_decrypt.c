@@ -83,19 +83,21 @@ int xts_decrypt(const unsigned char *ct, unsigned long ptlen, unsigned char *pt,
       lim = m - 1;
    }
 
+   err = CRYPT_NOP;
    if (cipher_descriptor[xts->cipher].accel_xts_decrypt && lim > 0) {
-
-      /* use accelerated decryption for whole blocks */
-      if ((err = cipher_descriptor[xts->cipher].accel_xts_decrypt(ct, pt, lim, tweak, &xts->key1, &xts->key2)) !=
-                 CRYPT_OK) {
+      /* use accelerated decryption for whole blocks, CRYPT_NOP if it can't be used on this CPU */
+      err = cipher_descriptor[xts->cipher].accel_xts_decrypt(ct, pt, lim, tweak, &xts->key1, &xts->key2);
+      if (err == CRYPT_OK) {
+         ct += lim * 16;
+         pt += lim * 16;
+
+         /* tweak is encrypted on output */
+         XMEMCPY(T, tweak, sizeof(T));
+      } else if (err != CRYPT_NOP) {
          return err;
       }
-      ct += lim * 16;
-      pt += lim * 16;
-
-      /* tweak is encrypted on output */
-      XMEMCPY(T, tweak, sizeof(T));
-   } else {
+   }
+   if (err == CRYPT_NOP) {
       /* encrypt the tweak */
       if ((err = cipher_descriptor[xts->cipher].ecb_encrypt(tweak, T, &xts->key2)) != CRYPT_OK) {
          return err;
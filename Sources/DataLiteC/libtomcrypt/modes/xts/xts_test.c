@@ -197,6 +197,12 @@ int xts_test(void)
    symmetric_xts xts;
    int i, j, k, err, idx;
    unsigned long len;
+   int (*orig_enc)(const unsigned char *, unsigned char *,
+                   unsigned long , unsigned char *,
+                   const symmetric_key *, const symmetric_key *);
+   int (*orig_dec)(const unsigned char *, unsigned char *,
+                   unsigned long , unsigned char *,
+                   const symmetric_key *, const symmetric_key *);
 
    /* AES can be under rijndael or aes... try to find it */
    if ((idx = find_cipher("aes")) == -1) {
@@ -204,9 +210,19 @@ int xts_test(void)
          return CRYPT_NOP;
       }
    }
-   for (k = 0; k < 4; ++k) {
+   orig_enc = cipher_descriptor[idx].accel_xts_encrypt;
+   orig_dec = cipher_descriptor[idx].accel_xts_decrypt;
+   /* k == 4 runs the accelerators the cipher provides itself, if any */
+   for (k = 0; k < 5; ++k) {
       cipher_descriptor[idx].accel_xts_encrypt = NULL;
       cipher_descriptor[idx].accel_xts_decrypt = NULL;
+      if (k == 4) {
+         if (orig_enc == NULL && orig_dec == NULL) {
+            break;
+         }
+         cipher_descriptor[idx].accel_xts_encrypt = orig_enc;
+         cipher_descriptor[idx].accel_xts_decrypt = orig_dec;
+      }
       if (k & 0x1) {
          cipher_descriptor[idx].accel_xts_encrypt = s_xts_test_accel_xts_encrypt;
       }
@@ -222,14 +238,14 @@ int xts_test(void)
             if ((j == 1) && ((tests[i].PTLEN < 32) || (tests[i].PTLEN % 32))) {
                continue;
             }
-            if ((k > 0) && (j == 1)) {
+            if ((k > 0) && (k < 4) && (j == 1)) {
                continue;
             }
             len = tests[i].PTLEN / 2;
 
             err = xts_start(idx, tests[i].key1, tests[i].key2, tests[i].keylen / 2, 0, &xts);
             if (err != CRYPT_OK) {
-               return err;
+               goto LBL_ERR;
             }
 
             seq = tests[i].seqnum;
@@ -241,24 +257,25 @@ int xts_test(void)
                err = xts_encrypt(tests[i].PTX, tests[i].PTLEN, OUT, T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             } else {
                err = xts_encrypt(tests[i].PTX, len, OUT, T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
                err = xts_encrypt(&tests[i].PTX[len], len, &OUT[len], T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             }
 
             if (compare_testvector(OUT, tests[i].PTLEN, tests[i].CTX, tests[i].PTLEN, "XTS encrypt", i)) {
+               err = CRYPT_FAIL_TESTVECTOR;
                xts_done(&xts);
-               return CRYPT_FAIL_TESTVECTOR;
+               goto LBL_ERR;
             }
 
             XMEMCPY(T, Torg, sizeof(T));
@@ -266,30 +283,36 @@ int xts_test(void)
                err = xts_decrypt(tests[i].CTX, tests[i].PTLEN, OUT, T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             } else {
                err = xts_decrypt(tests[i].CTX, len, OUT, T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
                err = xts_decrypt(&tests[i].CTX[len], len, &OUT[len], T, &xts);
                if (err != CRYPT_OK) {
                   xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             }
 
             if (compare_testvector(OUT, tests[i].PTLEN, tests[i].PTX, tests[i].PTLEN, "XTS decrypt", i)) {
+               err = CRYPT_FAIL_TESTVECTOR;
                xts_done(&xts);
-               return CRYPT_FAIL_TESTVECTOR;
+               goto LBL_ERR;
             }
             xts_done(&xts);
          }
       }
    }
-   return CRYPT_OK;
+   err = CRYPT_OK;
+
+LBL_ERR:
+   cipher_descriptor[idx].accel_xts_encrypt = orig_enc;
+   cipher_descriptor[idx].accel_xts_decrypt = orig_dec;
+   return err;
 #endif
 }
 
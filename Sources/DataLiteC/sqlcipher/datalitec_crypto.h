@@ -0,0 +1,99 @@
+/*
+** Process-wide settings of the bundled LibTomCrypt.
+**
+** PBKDF2 result cache. SQLCipher derives the key of every connection with
+** PBKDF2, which takes just as long on each open of a database with the same
+** passphrase. The cache keeps derived keys process-wide, keyed by
+** H(salt || passphrase), the salt, the hash and the iteration count, in
+** (best effort) mlock'ed memory, and wipes them when they expire, are
+** evicted or are purged. It is off until configured:
+**
+**   pkcs_5_alg2_cache_config(16, 300);   at most 16 keys, for 5 minutes
+**   ...
+**   pkcs_5_alg2_cache_purge();           e.g. when the app is backgrounded
+**
+** At most 16 entries can be configured, 0 disables the cache again. A ttl
+** of 0 keeps keys until they are evicted. pkcs_5_alg2_cache_config()
+** returns 0 on success and non-zero if entries is out of range.
+** pkcs_5_alg2_cache_status() reports the lookups that found a key (hits)
+** and those that did not while the cache was on (misses), and resets both
+** if resetFlg is non-zero.
+**
+** Locked memory. Every allocation LibTomCrypt makes for itself, e.g. HMAC
+** and PBKDF2 state, is wiped when it is freed. crypt_secmem_enable(1) also
+** serves allocations of up to 16 KiB from a few (best effort) mlock'ed,
+** non-dumpable 256 KiB regions, so key material is not swapped out or
+** written to core dumps. The pool is off until enabled. The same allocator
+** is exported for callers that keep secrets of their own. Memory from
+** crypt_secmem_malloc() must be freed with crypt_secmem_free(), whether or
+** not the pool was on when it was allocated. crypt_secmem_usage() reports
+** the mlock'ed bytes, the bytes handed out from the pool and those handed
+** out from the system allocator. SQLCipher's own allocations (the page
+** buffers and key context of the codec) are made by the amalgamation and
+** do not go through this allocator.
+**
+** Statistics. Per-cipher, per-hash and per-PRNG call counts, bytes,
+** latency histograms and heap allocations (LTC_STATS) are a build option,
+** not a runtime one, because every instrumented call reads the monotonic
+** clock. The package compiles them into debug builds only. Allocations are
+** counted to the descriptor whose call made them, those of HMAC, PBKDF2
+** and HKDF to their hash. crypt_stats_value() reads one counter, summed up
+** over all threads:
+**
+**   unsigned long long n;
+**   crypt_stats_value("hash", "sha512", "allocations", &n);
+**   crypt_stats_value(NULL, NULL, "allocated_bytes", &n);   all allocations
+**
+** The kind is "cipher", "hash" or "prng" and the name that of a registered
+** descriptor. The counters are "calls", "bytes", "nsec", "allocations",
+** "allocated_bytes" and "histogram.<n>", the number of calls that took
+** [2^(n-1), 2^n) ns for 0 < n < 32. Only "allocations" and
+** "allocated_bytes" exist library-wide. It returns 0 on success, 2 (the
+** CRYPT_NOP of LibTomCrypt) in builds without the counters and another
+** non-zero value for an unknown kind, name or counter.
+** crypt_stats_reset() zeroes all counters.
+*/
+#ifndef DATALITEC_CRYPTO_H
+#define DATALITEC_CRYPTO_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int pkcs_5_alg2_cache_config(
+  unsigned long entries,          /* Max. number of cached keys, 0 disables */
+  unsigned long ttl               /* Lifetime of a key in seconds, 0 forever */
+);
+void pkcs_5_alg2_cache_purge(void);
+int pkcs_5_alg2_cache_status(
+  unsigned long *hits,            /* OUT: Lookups that found the key */
+  unsigned long *misses,          /* OUT: Lookups that did not */
+  int resetFlg                    /* Reset both to zero */
+);
+
+void crypt_secmem_enable(int enable);
+void *crypt_secmem_malloc(size_t n);
+void *crypt_secmem_calloc(size_t n, size_t s);
+void *crypt_secmem_realloc(void *p, size_t n);
+void crypt_secmem_free(void *p);
+int crypt_secmem_usage(
+  unsigned long *locked,          /* OUT: Bytes of the pool that are mlock'ed */
+  unsigned long *in_use,          /* OUT: Bytes handed out from the pool */
+  unsigned long *fallback         /* OUT: Bytes from the system allocator */
+);
+
+int crypt_stats_value(
+  const char *kind,               /* "cipher", "hash", "prng" or NULL */
+  const char *name,               /* Name of the descriptor, e.g. "sha512" */
+  const char *counter,            /* E.g. "calls" or "allocations" */
+  unsigned long long *value       /* OUT: Sum over all threads */
+);
+void crypt_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATALITEC_CRYPTO_H */
@@ -0,0 +1,93 @@
+/*
+** Prepared statement cache.
+**
+** A datalitec_stmt_cache keeps the prepared statements of one database
+** connection around, keyed by their SQL text, so that hot queries are
+** parsed and planned once instead of on every execution:
+**
+**   datalitec_stmt_cache *pCache;
+**   sqlite3_stmt *pStmt;
+**
+**   datalitec_stmt_cache_open(db, 1024*1024, &pCache);
+**   if( datalitec_stmt_cache_acquire(pCache, "SELECT v FROM t WHERE k=?",
+**                                    -1, &pStmt)==SQLITE_OK ){
+**     sqlite3_bind_int64(pStmt, 1, iKey);
+**     while( sqlite3_step(pStmt)==SQLITE_ROW ){ ... }
+**     datalitec_stmt_cache_release(pCache, pStmt);
+**   }
+**   ...
+**   datalitec_stmt_cache_close(pCache);
+**   sqlite3_close(db);
+**
+** A statement returned by datalitec_stmt_cache_acquire() is reset and has
+** no bindings. It belongs to the caller until it is handed back with
+** datalitec_stmt_cache_release(), which resets it again, so a released
+** statement never keeps a read transaction open. Acquiring the same SQL
+** text while a statement for it is checked out prepares a second one.
+**
+** Idle statements are kept in least recently used order. Whenever their
+** total memory, as reported by SQLITE_STMTSTATUS_MEMUSED plus the SQL text,
+** exceeds the byte budget, the least recently used ones are finalized. A
+** budget of 0 disables caching.
+**
+** A cache may be used from several threads if the connection is in
+** serialized mode, it is protected by the connection mutex. It must be
+** closed before the connection.
+*/
+#ifndef DATALITEC_STMT_CACHE_H
+#define DATALITEC_STMT_CACHE_H
+
+#include "sqlite3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct datalitec_stmt_cache datalitec_stmt_cache;
+
+int datalitec_stmt_cache_open(
+  sqlite3 *db,                    /* Connection to cache statements of */
+  sqlite3_int64 nBudget,          /* Memory budget of idle statements */
+  datalitec_stmt_cache **ppCache  /* OUT: New cache */
+);
+int datalitec_stmt_cache_close(datalitec_stmt_cache *pCache);
+
+int datalitec_stmt_cache_acquire(
+  datalitec_stmt_cache *pCache,
+  const char *zSql,               /* SQL text of a single statement */
+  int nSql,                       /* Length of zSql in bytes, or -1 */
+  sqlite3_stmt **ppStmt           /* OUT: Statement handle */
+);
+int datalitec_stmt_cache_release(
+  datalitec_stmt_cache *pCache,
+  sqlite3_stmt *pStmt
+);
+
+void datalitec_stmt_cache_set_budget(
+  datalitec_stmt_cache *pCache,
+  sqlite3_int64 nBudget
+);
+void datalitec_stmt_cache_flush(datalitec_stmt_cache *pCache);
+
+/*
+** Counters for datalitec_stmt_cache_status(), in the manner of
+** sqlite3_stmt_status(). HIT, MISS and EVICT are cumulative and can be
+** reset, COUNT and MEMUSED describe the idle statements currently cached.
+*/
+#define DATALITEC_STMTCACHE_HIT      0
+#define DATALITEC_STMTCACHE_MISS     1
+#define DATALITEC_STMTCACHE_EVICT    2
+#define DATALITEC_STMTCACHE_COUNT    3
+#define DATALITEC_STMTCACHE_MEMUSED  4
+
+sqlite3_int64 datalitec_stmt_cache_status(
+  datalitec_stmt_cache *pCache,
+  int op,                         /* One of the DATALITEC_STMTCACHE_* values */
+  int resetFlg                    /* Reset HIT, MISS or EVICT to zero */
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATALITEC_STMT_CACHE_H */
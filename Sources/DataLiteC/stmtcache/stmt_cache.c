@@ -0,0 +1,350 @@
+/*
+** Prepared statement cache, see datalitec_stmt_cache.h for the interface.
+**
+** Idle statements are linked into a hash table keyed by their SQL text and
+** into a list in least recently used order. A checked out statement is in
+** neither; it is on the pOut list so that datalitec_stmt_cache_release()
+** can find its entry again. All state is protected by the connection
+** mutex, so the cache is exactly as thread safe as the connection.
+*/
+#include "sqlite3.h"
+#include "datalitec_stmt_cache.h"
+
+#include <string.h>
+
+#define STMT_CACHE_MINHASH  64          /* Initial number of hash buckets */
+
+typedef struct StmtEntry StmtEntry;
+struct StmtEntry {
+  sqlite3_stmt *pStmt;
+  unsigned int h;                 /* Hash of zSql */
+  int nSql;                       /* Length of zSql in bytes */
+  sqlite3_int64 nByte;            /* Memory accounted for this entry */
+  StmtEntry *pHashNext;           /* Next idle entry in the same bucket */
+  StmtEntry *pPrev, *pNext;       /* LRU list if idle, else the pOut list */
+  char zSql[1];                   /* SQL text, allocated with the entry */
+};
+
+struct datalitec_stmt_cache {
+  sqlite3 *db;
+  sqlite3_int64 nBudget;          /* Memory budget of idle statements */
+  sqlite3_int64 nByte;            /* Memory used by idle statements */
+  int nIdle;                      /* Number of idle statements */
+  int nHash;                      /* Number of buckets in aHash */
+  StmtEntry **aHash;
+  StmtEntry *pFirst, *pLast;      /* Idle entries, most recently used first */
+  StmtEntry *pOut;                /* Checked out entries */
+  sqlite3_int64 nHit, nMiss, nEvict;
+};
+
+/*
+** FNV-1a over the SQL text.
+*/
+static unsigned int stmtCacheHash(const char *z, int n){
+  unsigned int h = 2166136261u;
+  int i;
+  for(i=0; i<n; i++){
+    h = (h ^ (unsigned char)z[i]) * 16777619u;
+  }
+  return h;
+}
+
+static void stmtLink(StmtEntry **ppFirst, StmtEntry *pEntry){
+  pEntry->pPrev = 0;
+  pEntry->pNext = *ppFirst;
+  if( *ppFirst ) (*ppFirst)->pPrev = pEntry;
+  *ppFirst = pEntry;
+}
+
+/*
+** Grow the hash table once there are more idle entries than buckets. The
+** table stays as it is if the allocation fails, chains just get longer.
+*/
+static void stmtCacheRehash(datalitec_stmt_cache *p){
+  int nNew = p->nHash*2;
+  StmtEntry **aNew;
+  StmtEntry *pEntry;
+
+  aNew = sqlite3_malloc64(sizeof(StmtEntry*)*(sqlite3_uint64)nNew);
+  if( aNew==0 ) return;
+  memset(aNew, 0, sizeof(StmtEntry*)*(size_t)nNew);
+  for(pEntry=p->pFirst; pEntry; pEntry=pEntry->pNext){
+    StmtEntry **pp = &aNew[pEntry->h & (unsigned)(nNew-1)];
+    pEntry->pHashNext = *pp;
+    *pp = pEntry;
+  }
+  sqlite3_free(p->aHash);
+  p->aHash = aNew;
+  p->nHash = nNew;
+}
+
+/*
+** Add pEntry to the front of the LRU list and to the hash table.
+*/
+static void stmtCacheInsert(datalitec_stmt_cache *p, StmtEntry *pEntry){
+  StmtEntry **pp;
+
+  stmtLink(&p->pFirst, pEntry);
+  if( p->pLast==0 ) p->pLast = pEntry;
+  pp = &p->aHash[pEntry->h & (unsigned)(p->nHash-1)];
+  pEntry->pHashNext = *pp;
+  *pp = pEntry;
+  p->nByte += pEntry->nByte;
+  p->nIdle++;
+  if( p->nIdle>p->nHash ) stmtCacheRehash(p);
+}
+
+/*
+** Remove an idle entry from the LRU list and the hash table.
+*/
+static void stmtCacheRemove(datalitec_stmt_cache *p, StmtEntry *pEntry){
+  StmtEntry **pp = &p->aHash[pEntry->h & (unsigned)(p->nHash-1)];
+
+  while( *pp!=pEntry ) pp = &(*pp)->pHashNext;
+  *pp = pEntry->pHashNext;
+  if( pEntry->pPrev ){
+    pEntry->pPrev->pNext = pEntry->pNext;
+  }else{
+    p->pFirst = pEntry->pNext;
+  }
+  if( pEntry->pNext ){
+    pEntry->pNext->pPrev = pEntry->pPrev;
+  }else{
+    p->pLast = pEntry->pPrev;
+  }
+  p->nByte -= pEntry->nByte;
+  p->nIdle--;
+}
+
+static void stmtEntryFree(StmtEntry *pEntry){
+  sqlite3_finalize(pEntry->pStmt);
+  sqlite3_free(pEntry);
+}
+
+/*
+** Finalize least recently used statements until the idle ones fit into
+** the budget again.
+*/
+static void stmtCacheEnforce(datalitec_stmt_cache *p){
+  while( p->pLast && p->nByte>p->nBudget ){
+    StmtEntry *pEntry = p->pLast;
+    stmtCacheRemove(p, pEntry);
+    stmtEntryFree(pEntry);
+    p->nEvict++;
+  }
+}
+
+int datalitec_stmt_cache_open(
+  sqlite3 *db,
+  sqlite3_int64 nBudget,
+  datalitec_stmt_cache **ppCache
+){
+  datalitec_stmt_cache *p;
+
+  if( ppCache==0 ) return SQLITE_MISUSE;
+  *ppCache = 0;
+  if( db==0 || nBudget<0 ) return SQLITE_MISUSE;
+  p = sqlite3_malloc64(sizeof(*p));
+  if( p==0 ) return SQLITE_NOMEM;
+  memset(p, 0, sizeof(*p));
+  p->aHash = sqlite3_malloc64(sizeof(StmtEntry*)*STMT_CACHE_MINHASH);
+  if( p->aHash==0 ){
+    sqlite3_free(p);
+    return SQLITE_NOMEM;
+  }
+  memset(p->aHash, 0, sizeof(StmtEntry*)*STMT_CACHE_MINHASH);
+  p->nHash = STMT_CACHE_MINHASH;
+  p->db = db;
+  p->nBudget = nBudget;
+  *ppCache = p;
+  return SQLITE_OK;
+}
+
+/*
+** Finalize all cached statements and free the cache. Like sqlite3_close(),
+** this fails with SQLITE_BUSY and leaves the cache intact while any
+** statement is still checked out.
+*/
+int datalitec_stmt_cache_close(datalitec_stmt_cache *p){
+  sqlite3_mutex *pMutex;
+
+  if( p==0 ) return SQLITE_OK;
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  if( p->pOut ){
+    sqlite3_mutex_leave(pMutex);
+    return SQLITE_BUSY;
+  }
+  while( p->pFirst ){
+    StmtEntry *pEntry = p->pFirst;
+    stmtCacheRemove(p, pEntry);
+    stmtEntryFree(pEntry);
+  }
+  sqlite3_mutex_leave(pMutex);
+  sqlite3_free(p->aHash);
+  sqlite3_free(p);
+  return SQLITE_OK;
+}
+
+int datalitec_stmt_cache_acquire(
+  datalitec_stmt_cache *p,
+  const char *zSql,
+  int nSql,
+  sqlite3_stmt **ppStmt
+){
+  sqlite3_mutex *pMutex;
+  StmtEntry *pEntry;
+  unsigned int h;
+  int rc;
+
+  if( ppStmt==0 ) return SQLITE_MISUSE;
+  *ppStmt = 0;
+  if( p==0 || zSql==0 ) return SQLITE_MISUSE;
+  if( nSql<0 ) nSql = (int)strlen(zSql);
+  h = stmtCacheHash(zSql, nSql);
+
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  for(pEntry=p->aHash[h & (unsigned)(p->nHash-1)]; pEntry;
+      pEntry=pEntry->pHashNext){
+    if( pEntry->h==h && pEntry->nSql==nSql
+     && memcmp(pEntry->zSql, zSql, (size_t)nSql)==0
+    ){
+      break;
+    }
+  }
+  if( pEntry ){
+    stmtCacheRemove(p, pEntry);
+    p->nHit++;
+    /* the statement was reset when it was released */
+    sqlite3_clear_bindings(pEntry->pStmt);
+  }else{
+    sqlite3_stmt *pStmt = 0;
+    p->nMiss++;
+    rc = sqlite3_prepare_v3(p->db, zSql, nSql,
+                            p->nBudget>0 ? SQLITE_PREPARE_PERSISTENT : 0,
+                            &pStmt, 0);
+    if( rc!=SQLITE_OK || pStmt==0 ){
+      /* an error, or zSql was only whitespace or comments */
+      sqlite3_mutex_leave(pMutex);
+      return rc;
+    }
+    pEntry = sqlite3_malloc64(sizeof(*pEntry) + (sqlite3_uint64)nSql);
+    if( pEntry==0 ){
+      sqlite3_finalize(pStmt);
+      sqlite3_mutex_leave(pMutex);
+      return SQLITE_NOMEM;
+    }
+    memset(pEntry, 0, sizeof(*pEntry));
+    memcpy(pEntry->zSql, zSql, (size_t)nSql);
+    pEntry->zSql[nSql] = 0;
+    pEntry->nSql = nSql;
+    pEntry->h = h;
+    pEntry->pStmt = pStmt;
+  }
+  stmtLink(&p->pOut, pEntry);
+  *ppStmt = pEntry->pStmt;
+  sqlite3_mutex_leave(pMutex);
+  return SQLITE_OK;
+}
+
+/*
+** Reset a statement obtained from datalitec_stmt_cache_acquire() and
+** return it to the cache. Errors from the last sqlite3_step() are not
+** reported again. Returns SQLITE_MISUSE if pStmt is not checked out from
+** this cache.
+*/
+int datalitec_stmt_cache_release(datalitec_stmt_cache *p, sqlite3_stmt *pStmt){
+  sqlite3_mutex *pMutex;
+  StmtEntry *pEntry;
+
+  if( pStmt==0 ) return SQLITE_OK;
+  if( p==0 ) return SQLITE_MISUSE;
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  for(pEntry=p->pOut; pEntry && pEntry->pStmt!=pStmt; pEntry=pEntry->pNext){}
+  if( pEntry==0 ){
+    sqlite3_mutex_leave(pMutex);
+    return SQLITE_MISUSE;
+  }
+  if( pEntry->pPrev ){
+    pEntry->pPrev->pNext = pEntry->pNext;
+  }else{
+    p->pOut = pEntry->pNext;
+  }
+  if( pEntry->pNext ) pEntry->pNext->pPrev = pEntry->pPrev;
+
+  sqlite3_reset(pStmt);
+  pEntry->nByte = sizeof(*pEntry) + pEntry->nSql
+                + sqlite3_stmt_status(pStmt, SQLITE_STMTSTATUS_MEMUSED, 0);
+  if( pEntry->nByte>p->nBudget ){
+    stmtEntryFree(pEntry);
+    if( p->nBudget>0 ) p->nEvict++;
+  }else{
+    stmtCacheInsert(p, pEntry);
+    stmtCacheEnforce(p);
+  }
+  sqlite3_mutex_leave(pMutex);
+  return SQLITE_OK;
+}
+
+/*
+** Change the memory budget, finalizing idle statements that no longer fit.
+*/
+void datalitec_stmt_cache_set_budget(
+  datalitec_stmt_cache *p,
+  sqlite3_int64 nBudget
+){
+  sqlite3_mutex *pMutex;
+
+  if( p==0 || nBudget<0 ) return;
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  p->nBudget = nBudget;
+  stmtCacheEnforce(p);
+  sqlite3_mutex_leave(pMutex);
+}
+
+/*
+** Finalize all idle statements. Checked out statements are not affected.
+*/
+void datalitec_stmt_cache_flush(datalitec_stmt_cache *p){
+  sqlite3_mutex *pMutex;
+
+  if( p==0 ) return;
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  while( p->pFirst ){
+    StmtEntry *pEntry = p->pFirst;
+    stmtCacheRemove(p, pEntry);
+    stmtEntryFree(pEntry);
+  }
+  sqlite3_mutex_leave(pMutex);
+}
+
+sqlite3_int64 datalitec_stmt_cache_status(
+  datalitec_stmt_cache *p,
+  int op,
+  int resetFlg
+){
+  sqlite3_mutex *pMutex;
+  sqlite3_int64 *pCounter = 0;
+  sqlite3_int64 v = 0;
+
+  if( p==0 ) return 0;
+  pMutex = sqlite3_db_mutex(p->db);
+  sqlite3_mutex_enter(pMutex);
+  switch( op ){
+    case DATALITEC_STMTCACHE_HIT:     pCounter = &p->nHit;    break;
+    case DATALITEC_STMTCACHE_MISS:    pCounter = &p->nMiss;   break;
+    case DATALITEC_STMTCACHE_EVICT:   pCounter = &p->nEvict;  break;
+    case DATALITEC_STMTCACHE_COUNT:   v = p->nIdle;           break;
+    case DATALITEC_STMTCACHE_MEMUSED: v = p->nByte;           break;
+  }
+  if( pCounter ){
+    v = *pCounter;
+    if( resetFlg ) *pCounter = 0;
+  }
+  sqlite3_mutex_leave(pMutex);
+  return v;
+}
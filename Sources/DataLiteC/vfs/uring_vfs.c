@@ -0,0 +1,1036 @@
+/*
+** io_uring backed VFS for Linux.
+**
+** The "unix-uring" VFS is a shim over the default "unix" VFS. Locking,
+** shared memory, journals and temporary files are all left to the unix
+** VFS. Only the I/O on main database and WAL files goes through a per-file
+** io_uring instance:
+**
+**   * Consecutive xWrite() calls are coalesced into page aligned, registered
+**     buffers of up to URING_SLOT_SIZE bytes. Each full buffer is submitted
+**     right away without waiting for it, so a checkpoint or a large commit
+**     becomes a handful of asynchronous writes instead of one pwrite() per
+**     page. Outstanding writes are waited for before any other operation on
+**     the file (sync, lock, shm, size, truncate, close, and reads that
+**     overlap them), so every other method sees the file exactly as if the
+**     writes had been synchronous. A failed write is reported by the next
+**     method that can return an error, the same way the page cache reports
+**     writeback errors at fsync() time.
+**
+**   * WAL frames are written by the WAL file but published by the wal-index
+**     header, which is reached through the main database file. Each main
+**     database file is linked to the WAL file of the same connection, and
+**     xShmBarrier() and xShmLock() complete the WAL file's writes before
+**     anything is published to, or unlocked for, other connections.
+**
+**   * Sequential reads of the main database start an asynchronous read-ahead
+**     of up to URING_READAHEAD bytes. It stops short of pending writes and
+**     is discarded on any write and whenever a lock is taken or released, so
+**     it never returns bytes older than the file and never outlives the
+**     transaction it was read in.
+**
+** The io_uring descriptor is a second file descriptor for the same inode.
+** Closing any descriptor drops all POSIX locks the process holds on a file,
+** so these descriptors are shared per inode, looked up by stat() before
+** anything is opened, and only closed once the last "unix-uring" file on
+** that inode is closed. Don't open the same database through both
+** "unix-uring" and another VFS in one process.
+**
+** If io_uring is not available (older kernels, seccomp filters, or
+** io_uring_disabled) files fall back to plain unix VFS I/O. The VFS is
+** registered, not as the default, by datalitec_extra_init(). Select it with
+** sqlite3_open_v2(..., "unix-uring") or the "vfs=unix-uring" URI parameter.
+*/
+#include "sqlite3.h"
+
+#if defined(__linux__) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  define URING_VFS_ENABLED 1
+# endif
+#endif
+
+int sqlcipher_extra_init(const char *);
+
+#ifdef URING_VFS_ENABLED
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define URING_VFS_NAME   "unix-uring"
+#define URING_DEPTH      32             /* Submission queue entries */
+#define URING_SLOTS      16             /* Write buffers per file */
+#define URING_SLOT_SIZE  65536          /* Size of one write buffer */
+#define URING_READAHEAD  262144         /* Size of the read-ahead window */
+#define URING_RA_TAG     0xFFFF         /* user_data of the read-ahead */
+
+#define URING_FILE(pFile) ((UringFile*)(pFile))
+#define URING_ACTIVE(p)   ((p)->pInode!=0)
+
+/*
+** Minimal io_uring ring, the file that owns it is the only submitter.
+*/
+typedef struct UringRing UringRing;
+struct UringRing {
+  int fd;                         /* Ring descriptor, -1 if there is none */
+  unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+  unsigned *cqHead, *cqTail, *cqMask;
+  struct io_uring_sqe *aSqe;
+  struct io_uring_cqe *aCqe;
+  void *pSq, *pCq;                /* Mapped rings */
+  size_t szSq, szCq, szSqe;       /* Sizes of the mappings */
+  unsigned nQueued;               /* SQEs filled in but not yet submitted */
+};
+
+/*
+** A write buffer. Bytes [iOfst, iOfst+n) of the file are pending in it.
+*/
+typedef struct UringSlot UringSlot;
+struct UringSlot {
+  unsigned char *aBuf;
+  sqlite3_int64 iOfst;
+  int n;
+  int eState;                     /* One of the URING_SLOT_* values */
+  int res;                        /* Completion result */
+};
+#define URING_SLOT_FREE      0
+#define URING_SLOT_FILLING   1    /* Accepting appends, not yet submitted */
+#define URING_SLOT_INFLIGHT  2
+#define URING_SLOT_DONE      3
+
+/*
+** Per-inode descriptor shared by all "unix-uring" files, see above.
+*/
+typedef struct UringUnusedFd UringUnusedFd;
+struct UringUnusedFd {
+  int fd;
+  UringUnusedFd *pNext;
+};
+
+typedef struct UringInode UringInode;
+struct UringInode {
+  dev_t dev;
+  ino_t ino;
+  int fd;
+  int bReadOnly;                  /* fd was opened O_RDONLY */
+  int nRef;
+  UringUnusedFd *pUnused;         /* Descriptors to close with this one */
+  UringInode *pNext;
+};
+
+typedef struct UringFile UringFile;
+struct UringFile {
+  sqlite3_file base;              /* Base class, must be first */
+  sqlite3_file *pReal;            /* The unix VFS file, follows this struct */
+  UringInode *pInode;             /* Shared descriptor, NULL if pass-through */
+  int fd;                         /* pInode->fd when the file was opened */
+  UringRing ring;
+  int isMainDb;
+  sqlite3_filename zName;         /* Name passed to xOpen */
+  UringFile *pWal;                /* Main db: this connection's WAL file */
+  UringFile *pDb;                 /* WAL: the main db file linked to it */
+  UringFile *pNextDb;             /* Main db: next entry in pDbList */
+  int errCode;                    /* Deferred write error */
+
+  unsigned char *aPool;           /* URING_SLOTS * URING_SLOT_SIZE bytes */
+  int bRegistered;                /* aPool is registered with the ring */
+  UringSlot aSlot[URING_SLOTS];
+  int iFilling;                   /* Slot accepting appends, or -1 */
+  int nBusy;                      /* Slots that are FILLING or INFLIGHT/DONE */
+
+  unsigned char *aRa;             /* Read-ahead buffer */
+  sqlite3_int64 iRaOfst;          /* Offset the read-ahead started at */
+  int nRaWant;                    /* Bytes asked for */
+  int nRa;                        /* Bytes read ahead (valid once ready) */
+  int eRa;                        /* One of the URING_RA_* values */
+  sqlite3_int64 iLastRead;        /* End of the previous xRead() */
+};
+#define URING_RA_IDLE      0
+#define URING_RA_INFLIGHT  1
+#define URING_RA_READY     2
+
+static sqlite3_vfs *pUnixVfs = 0;
+static UringInode *pInodeList = 0;
+static UringFile *pDbList = 0;        /* Open main database files */
+
+/*
+** Ring setup and teardown.
+*/
+static int uringSetup(UringRing *pRing){
+  struct io_uring_params p;
+  unsigned char *pSq, *pCq;
+  int fd;
+
+  memset(&p, 0, sizeof(p));
+  pRing->fd = -1;
+  fd = (int)syscall(__NR_io_uring_setup, URING_DEPTH, &p);
+  if( fd<0 ) return SQLITE_ERROR;
+
+  pRing->szSq = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+  pRing->szCq = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+  if( p.features & IORING_FEAT_SINGLE_MMAP ){
+    if( pRing->szCq>pRing->szSq ) pRing->szSq = pRing->szCq;
+    pRing->szCq = pRing->szSq;
+  }
+  pRing->szSqe = p.sq_entries*sizeof(struct io_uring_sqe);
+
+  pSq = mmap(0, pRing->szSq, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+             fd, IORING_OFF_SQ_RING);
+  if( pSq==MAP_FAILED ){
+    close(fd);
+    return SQLITE_ERROR;
+  }
+  if( p.features & IORING_FEAT_SINGLE_MMAP ){
+    pCq = pSq;
+  }else{
+    pCq = mmap(0, pRing->szCq, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+               fd, IORING_OFF_CQ_RING);
+    if( pCq==MAP_FAILED ){
+      munmap(pSq, pRing->szSq);
+      close(fd);
+      return SQLITE_ERROR;
+    }
+  }
+  pRing->aSqe = mmap(0, pRing->szSqe, PROT_READ|PROT_WRITE,
+                     MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQES);
+  if( pRing->aSqe==MAP_FAILED ){
+    if( pCq!=pSq ) munmap(pCq, pRing->szCq);
+    munmap(pSq, pRing->szSq);
+    close(fd);
+    return SQLITE_ERROR;
+  }
+
+  pRing->pSq = pSq;
+  pRing->pCq = pCq;
+  pRing->sqHead = (unsigned*)(pSq + p.sq_off.head);
+  pRing->sqTail = (unsigned*)(pSq + p.sq_off.tail);
+  pRing->sqMask = (unsigned*)(pSq + p.sq_off.ring_mask);
+  pRing->sqArray = (unsigned*)(pSq + p.sq_off.array);
+  pRing->cqHead = (unsigned*)(pCq + p.cq_off.head);
+  pRing->cqTail = (unsigned*)(pCq + p.cq_off.tail);
+  pRing->cqMask = (unsigned*)(pCq + p.cq_off.ring_mask);
+  pRing->aCqe = (struct io_uring_cqe*)(pCq + p.cq_off.cqes);
+  pRing->nQueued = 0;
+  pRing->fd = fd;
+  return SQLITE_OK;
+}
+
+static void uringTeardown(UringRing *pRing){
+  if( pRing->fd<0 ) return;
+  munmap(pRing->aSqe, pRing->szSqe);
+  if( pRing->pCq!=pRing->pSq ) munmap(pRing->pCq, pRing->szCq);
+  munmap(pRing->pSq, pRing->szSq);
+  close(pRing->fd);
+  pRing->fd = -1;
+}
+
+/*
+** Return a zeroed SQE. The ring is deeper than the number of requests a
+** file can have outstanding, so this cannot run out of entries.
+*/
+static struct io_uring_sqe *uringGetSqe(UringRing *pRing){
+  unsigned tail = *pRing->sqTail + pRing->nQueued;
+  unsigned idx = tail & *pRing->sqMask;
+  struct io_uring_sqe *pSqe = &pRing->aSqe[idx];
+
+  memset(pSqe, 0, sizeof(*pSqe));
+  pRing->sqArray[idx] = idx;
+  pRing->nQueued++;
+  return pSqe;
+}
+
+/*
+** Submit queued SQEs and optionally wait for at least one completion.
+*/
+static int uringEnter(UringRing *pRing, unsigned nWait){
+  unsigned nSubmit = pRing->nQueued;
+  int rc;
+
+  if( nSubmit ){
+    __atomic_store_n(pRing->sqTail, *pRing->sqTail + nSubmit, __ATOMIC_RELEASE);
+    pRing->nQueued = 0;
+  }
+  if( nSubmit==0 && nWait==0 ) return 0;
+  do{
+    rc = (int)syscall(__NR_io_uring_enter, pRing->fd, nSubmit, nWait,
+                      nWait ? IORING_ENTER_GETEVENTS : 0, (void*)0, 0);
+    if( rc>=0 ){
+      /* the kernel may accept fewer SQEs than offered */
+      nSubmit -= (unsigned)rc;
+      if( nSubmit==0 || nWait ) break;
+    }
+  }while( rc>=0 || errno==EINTR );
+  return rc<0 ? -errno : 0;
+}
+
+/*
+** Process all available completions.
+*/
+static void uringReap(UringFile *p){
+  UringRing *pRing = &p->ring;
+  unsigned head = *pRing->cqHead;
+
+  while( head!=__atomic_load_n(pRing->cqTail, __ATOMIC_ACQUIRE) ){
+    struct io_uring_cqe *pCqe = &pRing->aCqe[head & *pRing->cqMask];
+    if( pCqe->user_data==URING_RA_TAG ){
+      p->nRa = pCqe->res>0 ? pCqe->res : 0;
+      p->eRa = URING_RA_READY;
+    }else if( pCqe->user_data<URING_SLOTS ){
+      UringSlot *pSlot = &p->aSlot[pCqe->user_data];
+      pSlot->res = pCqe->res;
+      pSlot->eState = URING_SLOT_DONE;
+    }
+    head++;
+  }
+  __atomic_store_n(pRing->cqHead, head, __ATOMIC_RELEASE);
+}
+
+/*
+** Wait for the read-ahead to complete, if one is in flight.
+*/
+static void uringWaitReadahead(UringFile *p){
+  while( p->eRa==URING_RA_INFLIGHT ){
+    if( uringEnter(&p->ring, 1) ){
+      /* nothing can be waited for, treat the read-ahead as failed */
+      p->eRa = URING_RA_IDLE;
+      break;
+    }
+    uringReap(p);
+  }
+}
+
+static void uringDiscardReadahead(UringFile *p){
+  uringWaitReadahead(p);
+  p->eRa = URING_RA_IDLE;
+}
+
+/*
+** Start reading ahead from offset iOfst. The read stops short of the first
+** pending write in the window, it would race with the write and could
+** return the bytes from before it.
+*/
+static void uringStartReadahead(UringFile *p, sqlite3_int64 iOfst){
+  struct io_uring_sqe *pSqe;
+  int nWant = URING_READAHEAD;
+  int i;
+
+  for(i=0; p->nBusy && i<URING_SLOTS; i++){
+    UringSlot *pSlot = &p->aSlot[i];
+    if( pSlot->eState!=URING_SLOT_FREE
+     && iOfst < pSlot->iOfst + pSlot->n && pSlot->iOfst < iOfst + nWant
+    ){
+      if( pSlot->iOfst<=iOfst ) return;
+      nWant = (int)(pSlot->iOfst - iOfst);
+    }
+  }
+  if( p->aRa==0 ){
+    if( posix_memalign((void**)&p->aRa, 4096, URING_READAHEAD) ){
+      p->aRa = 0;
+      return;
+    }
+  }
+  pSqe = uringGetSqe(&p->ring);
+  pSqe->opcode = IORING_OP_READ;
+  pSqe->fd = p->fd;
+  pSqe->addr = (unsigned long)p->aRa;
+  pSqe->len = (unsigned)nWant;
+  pSqe->off = (sqlite3_uint64)iOfst;
+  pSqe->user_data = URING_RA_TAG;
+  p->iRaOfst = iOfst;
+  p->nRaWant = nWant;
+  p->eRa = URING_RA_INFLIGHT;
+  if( uringEnter(&p->ring, 0) ) p->eRa = URING_RA_IDLE;
+}
+
+/*
+** Submit a FILLING write slot.
+*/
+static void uringSubmitSlot(UringFile *p, int iSlot){
+  UringSlot *pSlot = &p->aSlot[iSlot];
+  struct io_uring_sqe *pSqe = uringGetSqe(&p->ring);
+
+  if( p->bRegistered ){
+    pSqe->opcode = IORING_OP_WRITE_FIXED;
+    pSqe->buf_index = (unsigned short)iSlot;
+  }else{
+    pSqe->opcode = IORING_OP_WRITE;
+  }
+  pSqe->fd = p->fd;
+  pSqe->addr = (unsigned long)pSlot->aBuf;
+  pSqe->len = (unsigned)pSlot->n;
+  pSqe->off = (sqlite3_uint64)pSlot->iOfst;
+  pSqe->user_data = (sqlite3_uint64)iSlot;
+  pSlot->eState = URING_SLOT_INFLIGHT;
+  if( p->iFilling==iSlot ) p->iFilling = -1;
+  if( uringEnter(&p->ring, 0) ){
+    pSlot->res = -EIO;
+    pSlot->eState = URING_SLOT_DONE;
+  }
+}
+
+/*
+** Map an errno from a failed write to an SQLite error code.
+*/
+static int uringWriteError(int err){
+  return (err==ENOSPC || err==EDQUOT) ? SQLITE_FULL : SQLITE_IOERR_WRITE;
+}
+
+/*
+** Complete all pending writes. Short writes are finished with pwrite().
+** Returns the first error seen, including a deferred one.
+*/
+static int uringFlush(UringFile *p){
+  int rc = p->errCode;
+  int i;
+
+  p->errCode = SQLITE_OK;
+  if( p->nBusy==0 ) return rc;
+  if( p->iFilling>=0 ) uringSubmitSlot(p, p->iFilling);
+  for(i=0; i<URING_SLOTS; i++){
+    UringSlot *pSlot = &p->aSlot[i];
+    while( pSlot->eState==URING_SLOT_INFLIGHT ){
+      if( uringEnter(&p->ring, 1) ){
+        pSlot->res = -EIO;
+        pSlot->eState = URING_SLOT_DONE;
+        break;
+      }
+      uringReap(p);
+    }
+    if( pSlot->eState==URING_SLOT_DONE ){
+      int nDone = pSlot->res;
+      if( nDone>=0 ){
+        while( nDone<pSlot->n ){
+          ssize_t got = pwrite(p->fd, pSlot->aBuf + nDone,
+                               (size_t)(pSlot->n - nDone), pSlot->iOfst + nDone);
+          if( got<0 && errno==EINTR ) continue;
+          if( got<=0 ){
+            if( rc==SQLITE_OK ) rc = uringWriteError(got<0 ? errno : ENOSPC);
+            break;
+          }
+          nDone += (int)got;
+        }
+      }else if( rc==SQLITE_OK ){
+        rc = uringWriteError(-nDone);
+      }
+    }
+    pSlot->eState = URING_SLOT_FREE;
+    pSlot->n = 0;
+  }
+  p->nBusy = 0;
+  p->iFilling = -1;
+  return rc;
+}
+
+/*
+** True if [iOfst, iOfst+iAmt) overlaps a pending write.
+*/
+static int uringOverlapsPending(UringFile *p, sqlite3_int64 iOfst, int iAmt){
+  int i;
+  if( p->nBusy==0 ) return 0;
+  for(i=0; i<URING_SLOTS; i++){
+    UringSlot *pSlot = &p->aSlot[i];
+    if( pSlot->eState!=URING_SLOT_FREE
+     && iOfst < pSlot->iOfst + pSlot->n && pSlot->iOfst < iOfst + iAmt
+    ){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+** Allocate and, if the kernel allows it, register the write buffers.
+*/
+static int uringAllocPool(UringFile *p){
+  struct iovec aIov[URING_SLOTS];
+  int i;
+
+  if( posix_memalign((void**)&p->aPool, 4096,
+                     (size_t)URING_SLOTS*URING_SLOT_SIZE) ){
+    p->aPool = 0;
+    return SQLITE_NOMEM;
+  }
+  for(i=0; i<URING_SLOTS; i++){
+    p->aSlot[i].aBuf = p->aPool + (size_t)i*URING_SLOT_SIZE;
+    aIov[i].iov_base = p->aSlot[i].aBuf;
+    aIov[i].iov_len = URING_SLOT_SIZE;
+  }
+  /* fails with ENOMEM under a small RLIMIT_MEMLOCK on older kernels */
+  p->bRegistered = syscall(__NR_io_uring_register, p->ring.fd,
+                           IORING_REGISTER_BUFFERS, aIov, URING_SLOTS)==0;
+  return SQLITE_OK;
+}
+
+/*
+** Shared per-inode descriptors. Must be called with the VFS2 mutex held.
+*/
+static UringInode *uringInodeFind(const struct stat *pSt){
+  UringInode *pInode;
+  for(pInode=pInodeList; pInode; pInode=pInode->pNext){
+    if( pInode->dev==pSt->st_dev && pInode->ino==pSt->st_ino ) break;
+  }
+  return pInode;
+}
+
+/*
+** Return the shared descriptor for file zName and store it in *pFd. A
+** descriptor is only opened if no "unix-uring" file has one on the inode
+** yet, or if only a read-only one exists and flags ask for read-write.
+** Descriptors opened on an inode that turns out to be in use are kept until
+** the inode is released, never closed right away.
+*/
+static UringInode *uringInodeAcquire(const char *zName, int flags, int *pFd){
+  sqlite3_mutex *pMutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_VFS2);
+  int bReadOnly = (flags & SQLITE_OPEN_READONLY)!=0;
+  UringInode *pInode = 0;
+  UringInode *pNew;
+  UringUnusedFd *pUnused;
+  struct stat st;
+  int fd = -1;
+
+  sqlite3_mutex_enter(pMutex);
+  if( stat(zName, &st)==0 ) pInode = uringInodeFind(&st);
+  if( pInode && (bReadOnly || !pInode->bReadOnly) ){
+    pInode->nRef++;
+    *pFd = pInode->fd;
+    sqlite3_mutex_leave(pMutex);
+    return pInode;
+  }
+
+  /* allocate first, nothing may fail once the descriptor is open */
+  pNew = sqlite3_malloc(sizeof(*pNew));
+  pUnused = sqlite3_malloc(sizeof(*pUnused));
+  pInode = 0;
+  if( pNew && pUnused ){
+    fd = open(zName, (bReadOnly ? O_RDONLY : O_RDWR)|O_CLOEXEC);
+  }
+  if( fd>=0 && fstat(fd, &st) ){
+    close(fd);
+    fd = -1;
+  }
+  if( fd>=0 ){
+    /* look up again, the path may name another file than at stat() time */
+    pInode = uringInodeFind(&st);
+    if( pInode==0 ){
+      pInode = pNew;
+      pNew = 0;
+      pInode->dev = st.st_dev;
+      pInode->ino = st.st_ino;
+      pInode->fd = fd;
+      pInode->bReadOnly = bReadOnly;
+      pInode->nRef = 1;
+      pInode->pUnused = 0;
+      pInode->pNext = pInodeList;
+      pInodeList = pInode;
+    }else{
+      /* files already on the inode keep using the descriptor they have */
+      if( pInode->bReadOnly && !bReadOnly ){
+        pUnused->fd = pInode->fd;
+        pInode->fd = fd;
+        pInode->bReadOnly = 0;
+      }else{
+        pUnused->fd = fd;
+      }
+      pUnused->pNext = pInode->pUnused;
+      pInode->pUnused = pUnused;
+      pUnused = 0;
+      pInode->nRef++;
+    }
+    *pFd = pInode->fd;
+  }
+  sqlite3_mutex_leave(pMutex);
+  sqlite3_free(pNew);
+  sqlite3_free(pUnused);
+  return pInode;
+}
+
+static void uringInodeRelease(UringInode *pInode){
+  sqlite3_mutex *pMutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_VFS2);
+  UringInode **pp;
+
+  sqlite3_mutex_enter(pMutex);
+  if( --pInode->nRef==0 ){
+    for(pp=&pInodeList; *pp!=pInode; pp=&(*pp)->pNext){}
+    *pp = pInode->pNext;
+    while( pInode->pUnused ){
+      UringUnusedFd *pUnused = pInode->pUnused;
+      pInode->pUnused = pUnused->pNext;
+      close(pUnused->fd);
+      sqlite3_free(pUnused);
+    }
+    close(pInode->fd);
+    sqlite3_free(pInode);
+  }
+  sqlite3_mutex_leave(pMutex);
+}
+
+/*
+** Link a newly opened file to the other half of its connection's main
+** db/WAL pair. SQLite passes a WAL file the name of its main database, so
+** the pair is found by comparing sqlite3_filename pointers, which also keeps
+** two connections to one database apart.
+*/
+static void uringLinkOpen(UringFile *p, int flags){
+  sqlite3_mutex *pMutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_VFS2);
+
+  sqlite3_mutex_enter(pMutex);
+  if( flags & SQLITE_OPEN_MAIN_DB ){
+    p->pNextDb = pDbList;
+    pDbList = p;
+  }else if( URING_ACTIVE(p) ){
+    const char *zDb = sqlite3_filename_database(p->zName);
+    UringFile *pDb;
+    for(pDb=pDbList; pDb && pDb->zName!=zDb; pDb=pDb->pNextDb){}
+    if( pDb && pDb->pWal==0 ){
+      pDb->pWal = p;
+      p->pDb = pDb;
+    }
+  }
+  sqlite3_mutex_leave(pMutex);
+}
+
+static void uringLinkClose(UringFile *p){
+  sqlite3_mutex *pMutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_VFS2);
+  UringFile **pp;
+
+  sqlite3_mutex_enter(pMutex);
+  if( p->pWal ) p->pWal->pDb = 0;
+  if( p->pDb ) p->pDb->pWal = 0;
+  if( p->isMainDb ){
+    for(pp=&pDbList; *pp && *pp!=p; pp=&(*pp)->pNextDb){}
+    if( *pp ) *pp = p->pNextDb;
+  }
+  sqlite3_mutex_leave(pMutex);
+}
+
+/*
+** sqlite3_io_methods. Methods other than xRead and xWrite first complete
+** all pending writes, and those that involve a lock change drop the
+** read-ahead, see the comment at the top of the file.
+*/
+
+static int uringSettle(UringFile *p, int bDropReadahead){
+  if( !URING_ACTIVE(p) ) return SQLITE_OK;
+  if( bDropReadahead ) uringDiscardReadahead(p);
+  return uringFlush(p);
+}
+
+static int uringClose(sqlite3_file *pFile){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 1);
+  int rc2 = p->pReal->pMethods ? p->pReal->pMethods->xClose(p->pReal) : SQLITE_OK;
+
+  uringLinkClose(p);
+  if( p->pInode ) uringInodeRelease(p->pInode);
+  uringTeardown(&p->ring);
+  free(p->aPool);
+  free(p->aRa);
+  return rc!=SQLITE_OK ? rc : rc2;
+}
+
+static int uringRead(
+  sqlite3_file *pFile,
+  void *zBuf,
+  int iAmt,
+  sqlite3_int64 iOfst
+){
+  UringFile *p = URING_FILE(pFile);
+  int bSequential;
+  int rc;
+
+  if( !URING_ACTIVE(p) ){
+    return p->pReal->pMethods->xRead(p->pReal, zBuf, iAmt, iOfst);
+  }
+  if( uringOverlapsPending(p, iOfst, iAmt) && (rc = uringFlush(p))!=SQLITE_OK ){
+    return rc;
+  }
+
+  if( p->eRa!=URING_RA_IDLE
+   && iOfst>=p->iRaOfst && iOfst+iAmt<=p->iRaOfst+p->nRaWant
+  ){
+    uringWaitReadahead(p);
+    if( p->eRa==URING_RA_READY && iOfst+iAmt<=p->iRaOfst+p->nRa ){
+      memcpy(zBuf, p->aRa + (iOfst - p->iRaOfst), (size_t)iAmt);
+      p->iLastRead = iOfst + iAmt;
+      if( p->iLastRead==p->iRaOfst+p->nRa && p->nRa==p->nRaWant ){
+        uringStartReadahead(p, p->iLastRead);
+      }
+      return SQLITE_OK;
+    }
+  }
+
+  bSequential = p->isMainDb && iOfst==p->iLastRead && iOfst>0;
+  rc = p->pReal->pMethods->xRead(p->pReal, zBuf, iAmt, iOfst);
+  p->iLastRead = iOfst + iAmt;
+  if( rc==SQLITE_OK && bSequential && p->eRa!=URING_RA_INFLIGHT ){
+    uringStartReadahead(p, p->iLastRead);
+  }
+  return rc;
+}
+
+static int uringWrite(
+  sqlite3_file *pFile,
+  const void *zBuf,
+  int iAmt,
+  sqlite3_int64 iOfst
+){
+  UringFile *p = URING_FILE(pFile);
+  UringSlot *pSlot;
+  int i, rc;
+
+  if( !URING_ACTIVE(p) ){
+    return p->pReal->pMethods->xWrite(p->pReal, zBuf, iAmt, iOfst);
+  }
+  uringDiscardReadahead(p);
+  if( p->errCode ) return uringFlush(p);
+  if( iAmt>URING_SLOT_SIZE ){
+    if( (rc = uringFlush(p))!=SQLITE_OK ) return rc;
+    return p->pReal->pMethods->xWrite(p->pReal, zBuf, iAmt, iOfst);
+  }
+  if( p->aPool==0 && (rc = uringAllocPool(p))!=SQLITE_OK ){
+    return rc;
+  }
+
+  /* append to, or overwrite part of, the slot being filled */
+  if( p->iFilling>=0 ){
+    sqlite3_int64 iEnd;
+    pSlot = &p->aSlot[p->iFilling];
+    iEnd = pSlot->iOfst + pSlot->n;
+    if( iOfst>=pSlot->iOfst && iOfst<=iEnd
+     && iOfst+iAmt<=pSlot->iOfst+URING_SLOT_SIZE
+     && (iOfst+iAmt<=iEnd || !uringOverlapsPending(p, iEnd, (int)(iOfst+iAmt-iEnd)))
+    ){
+      memcpy(pSlot->aBuf + (iOfst - pSlot->iOfst), zBuf, (size_t)iAmt);
+      if( iOfst+iAmt > pSlot->iOfst+pSlot->n ){
+        pSlot->n = (int)(iOfst + iAmt - pSlot->iOfst);
+      }
+      if( pSlot->n==URING_SLOT_SIZE ) uringSubmitSlot(p, p->iFilling);
+      return SQLITE_OK;
+    }
+    uringSubmitSlot(p, p->iFilling);
+  }
+
+  /* writes to the same range may complete in any order, so never overlap */
+  if( uringOverlapsPending(p, iOfst, iAmt) || p->nBusy==URING_SLOTS ){
+    if( (rc = uringFlush(p))!=SQLITE_OK ) return rc;
+  }
+  for(i=0; p->aSlot[i].eState!=URING_SLOT_FREE; i++){}
+  pSlot = &p->aSlot[i];
+  memcpy(pSlot->aBuf, zBuf, (size_t)iAmt);
+  pSlot->iOfst = iOfst;
+  pSlot->n = iAmt;
+  pSlot->eState = URING_SLOT_FILLING;
+  p->iFilling = i;
+  p->nBusy++;
+  if( iAmt==URING_SLOT_SIZE ) uringSubmitSlot(p, i);
+  return SQLITE_OK;
+}
+
+static int uringTruncate(sqlite3_file *pFile, sqlite3_int64 size){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 1);
+  if( rc!=SQLITE_OK ) return rc;
+  return p->pReal->pMethods->xTruncate(p->pReal, size);
+}
+
+static int uringSync(sqlite3_file *pFile, int flags){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 0);
+  if( rc!=SQLITE_OK ) return rc;
+  return p->pReal->pMethods->xSync(p->pReal, flags);
+}
+
+static int uringFileSize(sqlite3_file *pFile, sqlite3_int64 *pSize){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 0);
+  if( rc!=SQLITE_OK ) return rc;
+  return p->pReal->pMethods->xFileSize(p->pReal, pSize);
+}
+
+static int uringLock(sqlite3_file *pFile, int eLock){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 1);
+  if( rc!=SQLITE_OK ) return rc;
+  return p->pReal->pMethods->xLock(p->pReal, eLock);
+}
+
+static int uringUnlock(sqlite3_file *pFile, int eLock){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 1);
+  int rc2 = p->pReal->pMethods->xUnlock(p->pReal, eLock);
+  return rc!=SQLITE_OK ? rc : rc2;
+}
+
+static int uringCheckReservedLock(sqlite3_file *pFile, int *pResOut){
+  UringFile *p = URING_FILE(pFile);
+  return p->pReal->pMethods->xCheckReservedLock(p->pReal, pResOut);
+}
+
+static int uringFileControl(sqlite3_file *pFile, int op, void *pArg){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 0);
+  if( rc!=SQLITE_OK ) return rc;
+  if( op==SQLITE_FCNTL_VFSNAME ){
+    int rc2 = p->pReal->pMethods->xFileControl(p->pReal, op, pArg);
+    if( rc2==SQLITE_OK ){
+      char *zOld = *(char**)pArg;
+      *(char**)pArg = sqlite3_mprintf("%s/%z", URING_VFS_NAME, zOld);
+    }
+    return rc2;
+  }
+  return p->pReal->pMethods->xFileControl(p->pReal, op, pArg);
+}
+
+static int uringSectorSize(sqlite3_file *pFile){
+  UringFile *p = URING_FILE(pFile);
+  return p->pReal->pMethods->xSectorSize(p->pReal);
+}
+
+static int uringDeviceCharacteristics(sqlite3_file *pFile){
+  UringFile *p = URING_FILE(pFile);
+  return p->pReal->pMethods->xDeviceCharacteristics(p->pReal);
+}
+
+static int uringShmMap(
+  sqlite3_file *pFile,
+  int iPg,
+  int pgsz,
+  int bExtend,
+  void volatile **pp
+){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 0);
+  if( rc!=SQLITE_OK ) return rc;
+  return p->pReal->pMethods->xShmMap(p->pReal, iPg, pgsz, bExtend, pp);
+}
+
+/*
+** The shm methods are called on the main database file but publish what the
+** WAL file wrote, so the linked WAL file is completed as well.
+*/
+static int uringShmLock(sqlite3_file *pFile, int offset, int n, int flags){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 1);
+  int rc2;
+  if( p->pWal ){
+    rc2 = uringSettle(p->pWal, 0);
+    if( rc==SQLITE_OK ) rc = rc2;
+  }
+  rc2 = p->pReal->pMethods->xShmLock(p->pReal, offset, n, flags);
+  return rc!=SQLITE_OK ? rc : rc2;
+}
+
+/* errors are kept and returned by the next method that can report them */
+static void uringShmBarrier(sqlite3_file *pFile){
+  UringFile *p = URING_FILE(pFile);
+  if( URING_ACTIVE(p) && p->nBusy ){
+    p->errCode = uringFlush(p);
+  }
+  if( p->pWal && p->pWal->nBusy ){
+    p->pWal->errCode = uringFlush(p->pWal);
+  }
+  p->pReal->pMethods->xShmBarrier(p->pReal);
+}
+
+static int uringShmUnmap(sqlite3_file *pFile, int deleteFlag){
+  UringFile *p = URING_FILE(pFile);
+  return p->pReal->pMethods->xShmUnmap(p->pReal, deleteFlag);
+}
+
+/* memory mapped reads bypass the ring, so pending writes must land first */
+static int uringFetch(
+  sqlite3_file *pFile,
+  sqlite3_int64 iOfst,
+  int iAmt,
+  void **pp
+){
+  UringFile *p = URING_FILE(pFile);
+  int rc = uringSettle(p, 0);
+  if( rc!=SQLITE_OK ){
+    *pp = 0;
+    return rc;
+  }
+  return p->pReal->pMethods->xFetch(p->pReal, iOfst, iAmt, pp);
+}
+
+static int uringUnfetch(sqlite3_file *pFile, sqlite3_int64 iOfst, void *pPage){
+  UringFile *p = URING_FILE(pFile);
+  return p->pReal->pMethods->xUnfetch(p->pReal, iOfst, pPage);
+}
+
+static const sqlite3_io_methods uringIoMethods = {
+  3,                              /* iVersion */
+  uringClose,
+  uringRead,
+  uringWrite,
+  uringTruncate,
+  uringSync,
+  uringFileSize,
+  uringLock,
+  uringUnlock,
+  uringCheckReservedLock,
+  uringFileControl,
+  uringSectorSize,
+  uringDeviceCharacteristics,
+  uringShmMap,
+  uringShmLock,
+  uringShmBarrier,
+  uringShmUnmap,
+  uringFetch,
+  uringUnfetch
+};
+
+/*
+** sqlite3_vfs. Everything but xOpen goes straight to the unix VFS.
+*/
+static int uringOpen(
+  sqlite3_vfs *pVfs,
+  sqlite3_filename zName,
+  sqlite3_file *pFile,
+  int flags,
+  int *pOutFlags
+){
+  UringFile *p = URING_FILE(pFile);
+  int rc;
+
+  (void)pVfs;
+  /* journals and temporary files are opened as plain unix files */
+  if( zName==0 || (flags & (SQLITE_OPEN_MAIN_DB|SQLITE_OPEN_WAL))==0
+   || (flags & SQLITE_OPEN_DELETEONCLOSE)!=0
+  ){
+    return pUnixVfs->xOpen(pUnixVfs, zName, pFile, flags, pOutFlags);
+  }
+
+  memset(p, 0, sizeof(*p));
+  p->pReal = (sqlite3_file*)&p[1];
+  p->ring.fd = -1;
+  p->iFilling = -1;
+  rc = pUnixVfs->xOpen(pUnixVfs, zName, p->pReal, flags, pOutFlags);
+  if( rc!=SQLITE_OK ) return rc;
+  p->base.pMethods = &uringIoMethods;
+  p->isMainDb = (flags & SQLITE_OPEN_MAIN_DB)!=0;
+  p->zName = zName;
+
+  /* anything that fails from here on leaves the file in pass-through mode */
+  if( uringSetup(&p->ring)==SQLITE_OK ){
+    int f = pOutFlags ? *pOutFlags : flags;
+    p->pInode = uringInodeAcquire(zName, f, &p->fd);
+    if( p->pInode==0 ) uringTeardown(&p->ring);
+  }
+  uringLinkOpen(p, flags);
+  return SQLITE_OK;
+}
+
+static int uringDelete(sqlite3_vfs *pVfs, const char *zName, int syncDir){
+  (void)pVfs;
+  return pUnixVfs->xDelete(pUnixVfs, zName, syncDir);
+}
+
+static int uringAccess(sqlite3_vfs *pVfs, const char *zName, int flags, int *pResOut){
+  (void)pVfs;
+  return pUnixVfs->xAccess(pUnixVfs, zName, flags, pResOut);
+}
+
+static int uringFullPathname(sqlite3_vfs *pVfs, const char *zName, int nOut, char *zOut){
+  (void)pVfs;
+  return pUnixVfs->xFullPathname(pUnixVfs, zName, nOut, zOut);
+}
+
+static void *uringDlOpen(sqlite3_vfs *pVfs, const char *zPath){
+  (void)pVfs;
+  return pUnixVfs->xDlOpen(pUnixVfs, zPath);
+}
+
+static void uringDlError(sqlite3_vfs *pVfs, int nByte, char *zErrMsg){
+  (void)pVfs;
+  pUnixVfs->xDlError(pUnixVfs, nByte, zErrMsg);
+}
+
+static void (*uringDlSym(sqlite3_vfs *pVfs, void *p, const char *zSym))(void){
+  (void)pVfs;
+  return pUnixVfs->xDlSym(pUnixVfs, p, zSym);
+}
+
+static void uringDlClose(sqlite3_vfs *pVfs, void *pHandle){
+  (void)pVfs;
+  pUnixVfs->xDlClose(pUnixVfs, pHandle);
+}
+
+static int uringRandomness(sqlite3_vfs *pVfs, int nByte, char *zOut){
+  (void)pVfs;
+  return pUnixVfs->xRandomness(pUnixVfs, nByte, zOut);
+}
+
+static int uringSleep(sqlite3_vfs *pVfs, int nMicro){
+  (void)pVfs;
+  return pUnixVfs->xSleep(pUnixVfs, nMicro);
+}
+
+static int uringCurrentTime(sqlite3_vfs *pVfs, double *pTime){
+  (void)pVfs;
+  return pUnixVfs->xCurrentTime(pUnixVfs, pTime);
+}
+
+static int uringGetLastError(sqlite3_vfs *pVfs, int nErr, char *zErr){
+  (void)pVfs;
+  return pUnixVfs->xGetLastError(pUnixVfs, nErr, zErr);
+}
+
+static int uringCurrentTimeInt64(sqlite3_vfs *pVfs, sqlite3_int64 *pTime){
+  (void)pVfs;
+  return pUnixVfs->xCurrentTimeInt64(pUnixVfs, pTime);
+}
+
+static sqlite3_vfs uringVfs = {
+  2,                              /* iVersion */
+  0,                              /* szOsFile, set on registration */
+  0,                              /* mxPathname, set on registration */
+  0,                              /* pNext */
+  URING_VFS_NAME,                 /* zName */
+  0,                              /* pAppData */
+  uringOpen,
+  uringDelete,
+  uringAccess,
+  uringFullPathname,
+  uringDlOpen,
+  uringDlError,
+  uringDlSym,
+  uringDlClose,
+  uringRandomness,
+  uringSleep,
+  uringCurrentTime,
+  uringGetLastError,
+  uringCurrentTimeInt64,
+  0,                              /* xSetSystemCall */
+  0,                              /* xGetSystemCall */
+  0                               /* xNextSystemCall */
+};
+
+static int uringVfsRegister(void){
+  pUnixVfs = sqlite3_vfs_find("unix");
+  if( pUnixVfs==0 || pUnixVfs->iVersion<2 ) return SQLITE_OK;
+  uringVfs.szOsFile = (int)sizeof(UringFile) + pUnixVfs->szOsFile;
+  uringVfs.mxPathname = pUnixVfs->mxPathname;
+  return sqlite3_vfs_register(&uringVfs, 0);
+}
+
+#endif /* URING_VFS_ENABLED */
+
+/*
+** Hooked in as SQLITE_EXTRA_INIT, runs the SQLCipher initialization and
+** then registers the VFSes DataLiteC adds.
+*/
+int datalitec_extra_init(const char *z){
+  int rc = sqlcipher_extra_init(z);
+#ifdef URING_VFS_ENABLED
+  if( rc==SQLITE_OK ) rc = uringVfsRegister();
+#endif
+  return rc;
+}
@@ -0,0 +1,525 @@
+/*
+ * End-to-end workload benchmark for the bundled SQLCipher.
+ *
+ * Runs the same OLTP style workloads (bulk insert, point lookups, range
+ * scans, a mixed read/write load, WAL checkpoints, keyed open and rekey)
+ * against a plaintext database and against keyed databases for every
+ * combination of page size, KDF iteration count and HMAC algorithm.
+ * Latency percentiles and throughput are written to stdout as one JSON
+ * document so two builds can be diffed.
+ *
+ * usage: SQLiteBenchmark [--dir PATH] [--rows N] [--ops N] [--row-size N]
+ *                        [--cache-size KIB] [--page-sizes N[,N...]]
+ *                        [--kdf-iters N[,N...]] [--hmacs NAME[,NAME...]]
+ *                        [--open-samples N] [--rekey-samples N]
+ */
+
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_LIST     16
+#define BENCH_KEY          "benchmark-passphrase"
+#define BENCH_REKEY        "benchmark-passphrase-2"
+
+typedef struct bench_config {
+   char        name[64];
+   int         keyed;
+   long        page_size;
+   long        kdf_iter;
+   const char *hmac;                 /* SHA1, SHA256 or SHA512 */
+} bench_config;
+
+typedef struct bench_samples {
+   double       *v;                  /* latencies in seconds */
+   unsigned long n, cap;
+} bench_samples;
+
+static struct {
+   const char    *dir;
+   long           rows, ops, row_size, cache_size;
+   long           page_sizes[BENCH_MAX_LIST];
+   int            npage_sizes;
+   long           kdf_iters[BENCH_MAX_LIST];
+   int            nkdf_iters;
+   const char    *hmacs[BENCH_MAX_LIST];
+   int            nhmacs;
+   long           open_samples, rekey_samples;
+   char           path[4096];
+   unsigned char *blob;
+   unsigned long  rng;
+   int            first;
+} opts;
+
+/* ---- helpers ---- */
+
+static double s_now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static unsigned long s_random(void)
+{
+   /* xorshift64, deterministic so every configuration sees the same access pattern */
+   opts.rng ^= opts.rng << 13;
+   opts.rng ^= opts.rng >> 7;
+   opts.rng ^= opts.rng << 17;
+   return opts.rng;
+}
+
+static void s_check(int rc, sqlite3 *db, const char *what)
+{
+   if (rc != SQLITE_OK && rc != SQLITE_ROW && rc != SQLITE_DONE) {
+      fprintf(stderr, "%s: %s\n", what, db != NULL ? sqlite3_errmsg(db) : sqlite3_errstr(rc));
+      exit(EXIT_FAILURE);
+   }
+}
+
+static void s_exec(sqlite3 *db, const char *sql)
+{
+   s_check(sqlite3_exec(db, sql, NULL, NULL, NULL), db, sql);
+}
+
+static sqlite3_stmt *s_prepare(sqlite3 *db, const char *sql)
+{
+   sqlite3_stmt *stmt = NULL;
+   s_check(sqlite3_prepare_v2(db, sql, -1, &stmt, NULL), db, sql);
+   return stmt;
+}
+
+static void s_step(sqlite3 *db, sqlite3_stmt *stmt)
+{
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+   }
+   s_check(rc, db, sqlite3_sql(stmt));
+   sqlite3_reset(stmt);
+}
+
+static int s_parse_list(const char *s, long *out, int max)
+{
+   int n = 0;
+   char *end;
+   while (*s != '\0' && n < max) {
+      out[n++] = strtol(s, &end, 10);
+      if (end == s) return -1;
+      s = (*end == ',') ? end + 1 : end;
+   }
+   return n;
+}
+
+static int s_parse_names(char *s, const char **out, int max)
+{
+   int n = 0;
+   char *tok;
+   for (tok = strtok(s, ","); tok != NULL && n < max; tok = strtok(NULL, ",")) {
+      if (strcmp(tok, "SHA1") != 0 && strcmp(tok, "SHA256") != 0 && strcmp(tok, "SHA512") != 0) {
+         return -1;
+      }
+      out[n++] = tok;
+   }
+   return n;
+}
+
+/* ---- samples ---- */
+
+static void s_sample(bench_samples *s, double t)
+{
+   if (s->n == s->cap) {
+      s->cap = s->cap != 0 ? s->cap * 2 : 256;
+      if ((s->v = realloc(s->v, s->cap * sizeof(*s->v))) == NULL) {
+         fprintf(stderr, "out of memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   s->v[s->n++] = t;
+}
+
+static int s_compare(const void *a, const void *b)
+{
+   double x = *(const double *)a, y = *(const double *)b;
+   return (x > y) - (x < y);
+}
+
+static double s_percentile(const bench_samples *s, double p)
+{
+   unsigned long x = (unsigned long)(p * (double)(s->n - 1) + 0.5);
+   return s->v[x];
+}
+
+/* `ops` is the number of rows or statements the samples cover, `seconds` the wall time */
+static void s_report(const bench_config *cfg, const char *workload, bench_samples *s,
+                     unsigned long ops, double seconds)
+{
+   double sum = 0;
+   unsigned long x;
+
+   if (s->n == 0) return;
+   qsort(s->v, s->n, sizeof(*s->v), s_compare);
+   for (x = 0; x < s->n; x++) {
+      sum += s->v[x];
+   }
+   printf("%s\n    {\"config\": \"%s\", \"keyed\": %s, \"page_size\": %ld, \"kdf_iter\": %ld, \"hmac\": \"%s\", "
+          "\"workload\": \"%s\", \"samples\": %lu, \"p50_us\": %.2f, \"p99_us\": %.2f, \"mean_us\": %.2f, "
+          "\"max_us\": %.2f, \"ops_per_sec\": %.2f}",
+          opts.first ? "" : ",", cfg->name, cfg->keyed ? "true" : "false", cfg->page_size,
+          cfg->keyed ? cfg->kdf_iter : 0L, cfg->keyed ? cfg->hmac : "", workload, s->n,
+          s_percentile(s, 0.50) * 1e6, s_percentile(s, 0.99) * 1e6, sum / (double)s->n * 1e6,
+          s->v[s->n - 1] * 1e6, (double)ops / seconds);
+   opts.first = 0;
+   fflush(stdout);
+   s->n = 0;
+}
+
+/* ---- database ---- */
+
+static void s_remove(void)
+{
+   char name[4200];
+   remove(opts.path);
+   snprintf(name, sizeof(name), "%s-wal", opts.path);
+   remove(name);
+   snprintf(name, sizeof(name), "%s-shm", opts.path);
+   remove(name);
+   snprintf(name, sizeof(name), "%s-journal", opts.path);
+   remove(name);
+}
+
+/* the cipher settings must be applied between sqlite3_key() and the first page read */
+static sqlite3 *s_open(const bench_config *cfg, const char *key)
+{
+   sqlite3 *db = NULL;
+   char sql[512];
+
+   s_check(sqlite3_open_v2(opts.path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL), db, "open");
+   if (cfg->keyed) {
+      s_check(sqlite3_key(db, key, (int)strlen(key)), db, "sqlite3_key");
+      snprintf(sql, sizeof(sql),
+               "PRAGMA cipher_page_size = %ld;"
+               "PRAGMA kdf_iter = %ld;"
+               "PRAGMA cipher_hmac_algorithm = HMAC_%s;"
+               "PRAGMA cipher_kdf_algorithm = PBKDF2_HMAC_%s;",
+               cfg->page_size, cfg->kdf_iter, cfg->hmac, cfg->hmac);
+   } else {
+      snprintf(sql, sizeof(sql), "PRAGMA page_size = %ld;", cfg->page_size);
+   }
+   s_exec(db, sql);
+   snprintf(sql, sizeof(sql),
+            "PRAGMA cache_size = -%ld;"
+            "PRAGMA journal_mode = WAL;"
+            "PRAGMA synchronous = NORMAL;"
+            "PRAGMA wal_autocheckpoint = 0;",
+            opts.cache_size);
+   s_exec(db, sql);
+   return db;
+}
+
+static void s_bind_row(sqlite3_stmt *stmt, long id)
+{
+   sqlite3_bind_int64(stmt, 1, id);
+   sqlite3_bind_int64(stmt, 2, (sqlite3_int64)(s_random() % 1000000));
+   sqlite3_bind_blob(stmt, 3, opts.blob + s_random() % (unsigned long)opts.row_size,
+                     (int)opts.row_size, SQLITE_STATIC);
+}
+
+/* ---- workloads ---- */
+
+static void s_bulk_insert(const bench_config *cfg, sqlite3 *db)
+{
+   bench_samples s = { 0 };
+   sqlite3_stmt *ins;
+   double t0, t;
+   long id = 1, x;
+
+   s_exec(db, "CREATE TABLE t(id INTEGER PRIMARY KEY, k INTEGER, v BLOB)");
+   ins = s_prepare(db, "INSERT INTO t(id, k, v) VALUES (?, ?, ?)");
+   t0 = s_now();
+   while (id <= opts.rows) {
+      t = s_now();
+      s_exec(db, "BEGIN");
+      for (x = 0; x < 1000 && id <= opts.rows; x++, id++) {
+         s_bind_row(ins, id);
+         s_step(db, ins);
+      }
+      s_exec(db, "COMMIT");
+      s_sample(&s, s_now() - t);
+   }
+   s_report(cfg, "bulk-insert-1000", &s, (unsigned long)opts.rows, s_now() - t0);
+   sqlite3_finalize(ins);
+   s_exec(db, "PRAGMA wal_checkpoint(TRUNCATE)");
+   free(s.v);
+}
+
+static void s_point_lookup(const bench_config *cfg, sqlite3 *db)
+{
+   bench_samples s = { 0 };
+   sqlite3_stmt *sel = s_prepare(db, "SELECT k, v FROM t WHERE id = ?");
+   double t0, t;
+   long x;
+
+   t0 = s_now();
+   for (x = 0; x < opts.ops; x++) {
+      t = s_now();
+      sqlite3_bind_int64(sel, 1, (sqlite3_int64)(s_random() % (unsigned long)opts.rows) + 1);
+      s_step(db, sel);
+      s_sample(&s, s_now() - t);
+   }
+   s_report(cfg, "point-lookup", &s, s.n, s_now() - t0);
+   sqlite3_finalize(sel);
+   free(s.v);
+}
+
+static void s_range_scan(const bench_config *cfg, sqlite3 *db)
+{
+   bench_samples s = { 0 };
+   sqlite3_stmt *sel = s_prepare(db, "SELECT count(*), sum(length(v)) FROM t WHERE id BETWEEN ?1 AND ?1 + 99");
+   double t0, t;
+   long x;
+
+   t0 = s_now();
+   for (x = 0; x < opts.ops / 10 + 1; x++) {
+      t = s_now();
+      sqlite3_bind_int64(sel, 1, (sqlite3_int64)(s_random() % (unsigned long)opts.rows) + 1);
+      s_step(db, sel);
+      s_sample(&s, s_now() - t);
+   }
+   s_report(cfg, "range-scan-100", &s, s.n, s_now() - t0);
+   sqlite3_finalize(sel);
+   free(s.v);
+}
+
+/* 80% point reads, 15% updates and 5% inserts, each in its own transaction */
+static void s_mixed(const bench_config *cfg, sqlite3 *db)
+{
+   bench_samples s = { 0 };
+   sqlite3_stmt *sel = s_prepare(db, "SELECT k, v FROM t WHERE id = ?");
+   sqlite3_stmt *upd = s_prepare(db, "UPDATE t SET k = ?2, v = ?3 WHERE id = ?1");
+   sqlite3_stmt *ins = s_prepare(db, "INSERT INTO t(id, k, v) VALUES (?, ?, ?)");
+   long next = opts.rows + 1, x;
+   unsigned long r;
+   double t0, t;
+
+   t0 = s_now();
+   for (x = 0; x < opts.ops; x++) {
+      r = s_random() % 100;
+      t = s_now();
+      if (r < 80) {
+         sqlite3_bind_int64(sel, 1, (sqlite3_int64)(s_random() % (unsigned long)opts.rows) + 1);
+         s_step(db, sel);
+      } else if (r < 95) {
+         s_bind_row(upd, (long)(s_random() % (unsigned long)opts.rows) + 1);
+         s_step(db, upd);
+      } else {
+         s_bind_row(ins, next++);
+         s_step(db, ins);
+      }
+      s_sample(&s, s_now() - t);
+   }
+   s_report(cfg, "mixed-oltp", &s, s.n, s_now() - t0);
+   sqlite3_finalize(sel);
+   sqlite3_finalize(upd);
+   sqlite3_finalize(ins);
+   s_exec(db, "PRAGMA wal_checkpoint(TRUNCATE)");
+   free(s.v);
+}
+
+/* each sample dirties a batch of random rows and then times a full checkpoint */
+static void s_checkpoint(const bench_config *cfg, sqlite3 *db)
+{
+   bench_samples s = { 0 };
+   sqlite3_stmt *upd = s_prepare(db, "UPDATE t SET k = ?2, v = ?3 WHERE id = ?1");
+   double total = 0, t;
+   long x, y;
+
+   for (x = 0; x < 10; x++) {
+      s_exec(db, "BEGIN");
+      for (y = 0; y < opts.ops / 10 + 1; y++) {
+         s_bind_row(upd, (long)(s_random() % (unsigned long)opts.rows) + 1);
+         s_step(db, upd);
+      }
+      s_exec(db, "COMMIT");
+      t = s_now();
+      s_exec(db, "PRAGMA wal_checkpoint(TRUNCATE)");
+      t = s_now() - t;
+      total += t;
+      s_sample(&s, t);
+   }
+   s_report(cfg, "wal-checkpoint", &s, s.n, total);
+   sqlite3_finalize(upd);
+   free(s.v);
+}
+
+/* open, key and read the schema, which is when the key derivation runs */
+static void s_open_latency(const bench_config *cfg)
+{
+   bench_samples s = { 0 };
+   double total = 0, t;
+   sqlite3 *db;
+   long x;
+
+   for (x = 0; x < opts.open_samples; x++) {
+      t = s_now();
+      db = s_open(cfg, BENCH_KEY);
+      s_exec(db, "SELECT count(*) FROM sqlite_master");
+      t = s_now() - t;
+      total += t;
+      s_sample(&s, t);
+      sqlite3_close(db);
+   }
+   s_report(cfg, "open", &s, s.n, total);
+   free(s.v);
+}
+
+/* rekey rewrites every page, so it is timed in rollback journal mode and back again */
+static void s_rekey(const bench_config *cfg)
+{
+   bench_samples s = { 0 };
+   double total = 0, t;
+   sqlite3 *db;
+   long x;
+
+   for (x = 0; x < opts.rekey_samples; x++) {
+      db = s_open(cfg, BENCH_KEY);
+      s_exec(db, "PRAGMA journal_mode = DELETE");
+      t = s_now();
+      s_check(sqlite3_rekey(db, BENCH_REKEY, (int)strlen(BENCH_REKEY)), db, "sqlite3_rekey");
+      s_check(sqlite3_rekey(db, BENCH_KEY, (int)strlen(BENCH_KEY)), db, "sqlite3_rekey");
+      t = (s_now() - t) / 2;
+      total += 2 * t;
+      s_sample(&s, t);
+      s_sample(&s, t);
+      sqlite3_close(db);
+   }
+   s_report(cfg, "rekey", &s, s.n, total);
+   free(s.v);
+}
+
+static void s_run(const bench_config *cfg)
+{
+   sqlite3 *db;
+
+   opts.rng = 0x9E3779B97F4A7C15UL;
+   s_remove();
+   db = s_open(cfg, BENCH_KEY);
+   s_bulk_insert(cfg, db);
+   s_point_lookup(cfg, db);
+   s_range_scan(cfg, db);
+   s_mixed(cfg, db);
+   s_checkpoint(cfg, db);
+   sqlite3_close(db);
+   s_open_latency(cfg);
+   if (cfg->keyed) {
+      s_rekey(cfg);
+   }
+   s_remove();
+}
+
+int main(int argc, char **argv)
+{
+   static char default_hmacs[] = "SHA1,SHA256,SHA512";
+   bench_config cfg;
+   char *hmacs = default_hmacs;
+   const char *dir;
+   int x, y, z;
+
+   opts.rows          = 100000;
+   opts.ops           = 20000;
+   opts.row_size      = 200;
+   opts.cache_size    = 2048;
+   opts.open_samples  = 5;
+   opts.rekey_samples = 2;
+   opts.page_sizes[0] = 1024;
+   opts.page_sizes[1] = 4096;
+   opts.page_sizes[2] = 16384;
+   opts.npage_sizes   = 3;
+   opts.kdf_iters[0]  = 4000;
+   opts.kdf_iters[1]  = 256000;
+   opts.nkdf_iters    = 2;
+   if ((dir = getenv("TMPDIR")) == NULL) {
+      dir = "/tmp";
+   }
+   opts.dir = dir;
+
+   for (x = 1; x < argc; x++) {
+      if (strcmp(argv[x], "--dir") == 0 && x + 1 < argc) {
+         opts.dir = argv[++x];
+      } else if (strcmp(argv[x], "--rows") == 0 && x + 1 < argc) {
+         opts.rows = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--ops") == 0 && x + 1 < argc) {
+         opts.ops = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--row-size") == 0 && x + 1 < argc) {
+         opts.row_size = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--cache-size") == 0 && x + 1 < argc) {
+         opts.cache_size = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--open-samples") == 0 && x + 1 < argc) {
+         opts.open_samples = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--rekey-samples") == 0 && x + 1 < argc) {
+         opts.rekey_samples = strtol(argv[++x], NULL, 10);
+      } else if (strcmp(argv[x], "--page-sizes") == 0 && x + 1 < argc) {
+         opts.npage_sizes = s_parse_list(argv[++x], opts.page_sizes, BENCH_MAX_LIST);
+      } else if (strcmp(argv[x], "--kdf-iters") == 0 && x + 1 < argc) {
+         opts.nkdf_iters = s_parse_list(argv[++x], opts.kdf_iters, BENCH_MAX_LIST);
+      } else if (strcmp(argv[x], "--hmacs") == 0 && x + 1 < argc) {
+         hmacs = argv[++x];
+      } else {
+         fprintf(stderr, "usage: %s [--dir PATH] [--rows N] [--ops N] [--row-size N] [--cache-size KIB]\n"
+                         "       [--page-sizes N[,N...]] [--kdf-iters N[,N...]] [--hmacs SHA1,SHA256,SHA512]\n"
+                         "       [--open-samples N] [--rekey-samples N]\n", argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   opts.nhmacs = s_parse_names(hmacs, opts.hmacs, BENCH_MAX_LIST);
+   for (x = 0; x < opts.npage_sizes; x++) {
+      if (opts.page_sizes[x] < 512 || opts.page_sizes[x] > 65536 ||
+          (opts.page_sizes[x] & (opts.page_sizes[x] - 1)) != 0) {
+         opts.npage_sizes = -1;
+      }
+   }
+   for (x = 0; x < opts.nkdf_iters; x++) {
+      if (opts.kdf_iters[x] < 1) opts.nkdf_iters = -1;
+   }
+   if (opts.rows < 1 || opts.ops < 1 || opts.row_size < 1 || opts.cache_size < 1 ||
+       opts.open_samples < 1 || opts.rekey_samples < 0 ||
+       opts.npage_sizes <= 0 || opts.nkdf_iters <= 0 || opts.nhmacs <= 0) {
+      fprintf(stderr, "invalid arguments\n");
+      return EXIT_FAILURE;
+   }
+
+   /* twice the row size so rows can start at a random offset */
+   if ((opts.blob = malloc((size_t)opts.row_size * 2)) == NULL) {
+      return EXIT_FAILURE;
+   }
+   opts.rng = 1;
+   for (x = 0; x < opts.row_size * 2; x++) {
+      opts.blob[x] = (unsigned char)s_random();
+   }
+   snprintf(opts.path, sizeof(opts.path), "%s/sqlite-benchmark-%ld.db", opts.dir, (long)time(NULL));
+
+   printf("{\n  \"sqlite\": \"%s\",\n  \"rows\": %ld,\n  \"ops\": %ld,\n  \"row_size\": %ld,\n"
+          "  \"cache_size_kib\": %ld,\n  \"results\": [",
+          sqlite3_libversion(), opts.rows, opts.ops, opts.row_size, opts.cache_size);
+   opts.first = 1;
+   for (x = 0; x < opts.npage_sizes; x++) {
+      memset(&cfg, 0, sizeof(cfg));
+      cfg.page_size = opts.page_sizes[x];
+      snprintf(cfg.name, sizeof(cfg.name), "plaintext-%ld", cfg.page_size);
+      s_run(&cfg);
+      for (y = 0; y < opts.nkdf_iters; y++) {
+         for (z = 0; z < opts.nhmacs; z++) {
+            cfg.keyed    = 1;
+            cfg.kdf_iter = opts.kdf_iters[y];
+            cfg.hmac     = opts.hmacs[z];
+            snprintf(cfg.name, sizeof(cfg.name), "aes256-%s-%ld-%ld",
+                     cfg.hmac, cfg.page_size, cfg.kdf_iter);
+            s_run(&cfg);
+         }
+      }
+   }
+   printf("\n  ]\n}\n");
+   free(opts.blob);
+   return EXIT_SUCCESS;
+}
@@ -2,6 +2,8 @@ import Foundation
 import Testing
 import DataLiteC
 
+// The key cache, the secure memory pool and the statistics are process-wide.
+@Suite(.serialized)
 class DataLiteCTests {
     let path: String
     
@@ -80,4 +82,194 @@ class DataLiteCTests {
             #expect(text == "Data")
         }
     }
+    
+    @Test func testStatementCache() {
+        var db: OpaquePointer?
+        #expect(sqlite3_open(path, &db) == SQLITE_OK)
+        defer { sqlite3_close(db) }
+        
+        #expect(sqlite3_key(db, "securekey", Int32("securekey".utf8.count)) == SQLITE_OK)
+        #expect(sqlite3_exec(db, "CREATE TABLE t(id INTEGER PRIMARY KEY, value INTEGER);", nil, nil, nil) == SQLITE_OK)
+        
+        var cache: OpaquePointer?
+        #expect(datalitec_stmt_cache_open(db, 1 << 20, &cache) == SQLITE_OK)
+        defer { datalitec_stmt_cache_close(cache) }
+        
+        for i in 0..<10 {
+            var stmt: OpaquePointer?
+            #expect(datalitec_stmt_cache_acquire(cache, "INSERT INTO t(value) VALUES (?);", -1, &stmt) == SQLITE_OK)
+            sqlite3_bind_int(stmt, 1, Int32(i))
+            #expect(sqlite3_step(stmt) == SQLITE_DONE)
+            #expect(datalitec_stmt_cache_release(cache, stmt) == SQLITE_OK)
+        }
+        
+        #expect(datalitec_stmt_cache_status(cache, DATALITEC_STMTCACHE_HIT, 0) == 9)
+        #expect(datalitec_stmt_cache_status(cache, DATALITEC_STMTCACHE_MISS, 0) == 1)
+        #expect(datalitec_stmt_cache_status(cache, DATALITEC_STMTCACHE_COUNT, 0) == 1)
+    }
+
+    @Test func testKeyDerivationCache() {
+        #expect(pkcs_5_alg2_cache_config(17, 0) != 0)
+        #expect(pkcs_5_alg2_cache_config(4, 60) == 0)
+        defer {
+            pkcs_5_alg2_cache_purge()
+            pkcs_5_alg2_cache_config(0, 0)
+        }
+        var hits: UInt = 0, misses: UInt = 0
+        #expect(pkcs_5_alg2_cache_status(&hits, &misses, 1) == 0)
+        
+        // The second open derives the key from the cache and must still decrypt.
+        for i in 0..<2 {
+            var db: OpaquePointer?
+            #expect(sqlite3_open(path, &db) == SQLITE_OK)
+            defer { sqlite3_close(db) }
+            
+            #expect(sqlite3_key(db, "cachedkey", Int32("cachedkey".utf8.count)) == SQLITE_OK)
+            let sql = i == 0 ? "CREATE TABLE t(id INTEGER PRIMARY KEY);" : "SELECT count(*) FROM t;"
+            #expect(sqlite3_exec(db, sql, nil, nil, nil) == SQLITE_OK)
+            
+            #expect(pkcs_5_alg2_cache_status(&hits, &misses, 1) == 0)
+            if i == 0 {
+                #expect(hits == 0)
+                #expect(misses > 0)
+            } else {
+                #expect(hits > 0)
+            }
+        }
+    }
+    
+    @Test func testSecureMemory() {
+        crypt_secmem_enable(1)
+        defer { crypt_secmem_enable(0) }
+        
+        var locked: UInt = 0, inUse: UInt = 0, fallback: UInt = 0
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        let (inUse0, fallback0) = (inUse, fallback)
+        
+        // 100 octets take a 128 octet block of the pool, 20000 don't fit.
+        let pooled = crypt_secmem_malloc(100)
+        #expect(pooled != nil)
+        memset(pooled, 0x5a, 100)
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        #expect(inUse == inUse0 + 128)
+        #expect(fallback == fallback0)
+        
+        let large = crypt_secmem_malloc(20000)
+        #expect(large != nil)
+        memset(large, 0x5a, 20000)
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        #expect(inUse == inUse0 + 128)
+        #expect(fallback == fallback0 + 20000)
+        
+        // With the pool off small blocks come from the system allocator too,
+        // and blocks from before stay valid and are freed where they came from.
+        crypt_secmem_enable(0)
+        let unpooled = crypt_secmem_malloc(100)
+        #expect(unpooled != nil)
+        memset(unpooled, 0x5a, 100)
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        #expect(inUse == inUse0 + 128)
+        #expect(fallback == fallback0 + 20100)
+        
+        crypt_secmem_free(pooled)
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        #expect(inUse == inUse0)
+        #expect(fallback == fallback0 + 20100)
+        
+        crypt_secmem_free(large)
+        crypt_secmem_free(unpooled)
+        #expect(crypt_secmem_usage(&locked, &inUse, &fallback) == 0)
+        #expect(inUse == inUse0)
+        #expect(fallback == fallback0)
+    }
+    
+    @Test func testStatistics() {
+        // Release builds are compiled without the counters.
+        var calls: UInt64 = 0
+        guard crypt_stats_value("hash", "sha512", "calls", &calls) == 0 else { return }
+        var allocations: UInt64 = 0
+        #expect(crypt_stats_value("hash", "sha512", "allocations", &allocations) == 0)
+        var total: UInt64 = 0
+        #expect(crypt_stats_value(nil, nil, "allocations", &total) == 0)
+        
+        var db: OpaquePointer?
+        #expect(sqlite3_open(path, &db) == SQLITE_OK)
+        defer { sqlite3_close(db) }
+        #expect(sqlite3_key(db, "statskey", Int32("statskey".utf8.count)) == SQLITE_OK)
+        #expect(sqlite3_exec(db, "CREATE TABLE t(id INTEGER PRIMARY KEY);", nil, nil, nil) == SQLITE_OK)
+        
+        // Only the growth is checked, the counters also include earlier tests.
+        var value: UInt64 = 0
+        #expect(crypt_stats_value("hash", "sha512", "calls", &value) == 0)
+        #expect(value > calls)
+        #expect(crypt_stats_value("hash", "sha512", "allocations", &value) == 0)
+        #expect(value > allocations)
+        #expect(crypt_stats_value(nil, nil, "allocations", &value) == 0)
+        #expect(value > total)
+        #expect(crypt_stats_value("hash", "sha512", "histogram.32", &value) != 0)
+        #expect(crypt_stats_value(nil, nil, "calls", &value) != 0)
+    }
+    
+    @Test func testUringWALConnections() {
+        guard sqlite3_vfs_find("unix-uring") != nil else { return }
+        let flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE
+        
+        var writer: OpaquePointer?
+        #expect(sqlite3_open_v2(path, &writer, flags, "unix-uring") == SQLITE_OK)
+        defer { sqlite3_close(writer) }
+        var reader: OpaquePointer?
+        #expect(sqlite3_open_v2(path, &reader, flags, "unix-uring") == SQLITE_OK)
+        defer { sqlite3_close(reader) }
+        
+        let setupSQL = "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL; CREATE TABLE t(id INTEGER PRIMARY KEY, value BLOB);"
+        #expect(sqlite3_exec(writer, setupSQL, nil, nil, nil) == SQLITE_OK)
+        #expect(sqlite3_exec(reader, "PRAGMA synchronous=NORMAL;", nil, nil, nil) == SQLITE_OK)
+        
+        // Every commit must be readable by the other connection, also after
+        // the checkpoint restarts the WAL from its first frame.
+        var rows: Int64 = 0
+        for _ in 0..<3 {
+            for _ in 0..<100 {
+                #expect(sqlite3_exec(writer, "INSERT INTO t(value) VALUES (randomblob(3000));", nil, nil, nil) == SQLITE_OK)
+                rows += 1
+                #expect(queryInt(reader, "SELECT count(*) FROM t;") == rows)
+            }
+            #expect(sqlite3_exec(writer, "PRAGMA wal_checkpoint(TRUNCATE);", nil, nil, nil) == SQLITE_OK)
+        }
+        #expect(queryInt(reader, "SELECT count(*) FROM pragma_integrity_check WHERE integrity_check <> 'ok';") == 0)
+    }
+    
+    @Test func testUringCacheSpill() {
+        guard sqlite3_vfs_find("unix-uring") != nil else { return }
+        var db: OpaquePointer?
+        #expect(sqlite3_open_v2(path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, "unix-uring") == SQLITE_OK)
+        defer { sqlite3_close(db) }
+        
+        let setupSQL = """
+            PRAGMA journal_mode=DELETE;
+            PRAGMA cache_size=8;
+            CREATE TABLE t(id INTEGER PRIMARY KEY, n INTEGER, pad BLOB);
+            WITH RECURSIVE c(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM c WHERE i < 20000)
+            INSERT INTO t SELECT i, 0, zeroblob(300) FROM c;
+            """
+        #expect(sqlite3_exec(db, setupSQL, nil, nil, nil) == SQLITE_OK)
+        
+        // The tiny cache spills dirty pages mid-transaction, and the scan
+        // reads them back while their writes may still be pending.
+        for round in 1...3 {
+            #expect(sqlite3_exec(db, "BEGIN;", nil, nil, nil) == SQLITE_OK)
+            #expect(sqlite3_exec(db, "UPDATE t SET n = n + 1 WHERE id % 3 = 0;", nil, nil, nil) == SQLITE_OK)
+            #expect(sqlite3_exec(db, "UPDATE t SET n = n + 1 WHERE id % 3 <> 0;", nil, nil, nil) == SQLITE_OK)
+            #expect(queryInt(db, "SELECT sum(n) FROM t;") == Int64(20000 * round))
+            #expect(sqlite3_exec(db, "COMMIT;", nil, nil, nil) == SQLITE_OK)
+        }
+    }
+    
+    private func queryInt(_ db: OpaquePointer?, _ sql: String) -> Int64? {
+        var stmt: OpaquePointer?
+        guard sqlite3_prepare_v2(db, sql, -1, &stmt, nil) == SQLITE_OK else { return nil }
+        defer { sqlite3_finalize(stmt) }
+        guard sqlite3_step(stmt) == SQLITE_ROW else { return nil }
+        return sqlite3_column_int64(stmt, 0)
+    }
 }